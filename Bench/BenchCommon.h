@@ -0,0 +1,109 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include <cstdio>
+#include <map>
+
+//Command line, JSON reports and baseline comparison shared by the resonance_bench modes
+namespace Bench
+{
+    struct Options
+    {
+        bool quick = false;
+        juce::String filter;
+        juce::File jsonFile, baselineFile;
+        double thresholdPercent = 10.0;
+    };
+
+    inline Options parseOptions(const juce::StringArray& args)
+    {
+        Options options;
+        for (int i = 0; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            const auto next = [&] { return i + 1 < args.size() ? args[++i] : juce::String(); };
+
+            if (arg == "--quick")          options.quick = true;
+            else if (arg == "--filter")    options.filter = next();
+            else if (arg == "--json")      options.jsonFile = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+            else if (arg == "--compare")   options.baselineFile = juce::File::getCurrentWorkingDirectory().getChildFile(next());
+            else if (arg == "--threshold") options.thresholdPercent = next().getDoubleValue();
+        }
+        return options;
+    }
+
+    //Root object of a report: format version, mode, time, build type, machine and results
+    inline juce::var makeReport(const char* mode, const juce::Array<juce::var>& results)
+    {
+        auto* system = new juce::DynamicObject();
+        system->setProperty("cpu", juce::SystemStats::getCpuModel());
+        system->setProperty("cores", juce::SystemStats::getNumCpus());
+        system->setProperty("os", juce::SystemStats::getOperatingSystemName());
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty("version", 1);
+        root->setProperty("mode", mode);
+        root->setProperty("timestamp", juce::Time::getCurrentTime().toISO8601(true));
+       #if JUCE_DEBUG
+        root->setProperty("build", "debug");
+       #else
+        root->setProperty("build", "release");
+       #endif
+        root->setProperty("system", juce::var(system));
+        root->setProperty("results", results);
+        return juce::var(root);
+    }
+
+    inline void writeReport(const juce::var& report, const juce::File& file)
+    {
+        if (file.replaceWithText(juce::JSON::toString(report)))
+            std::printf("\nWrote %s\n", file.getFullPathName().toRawUTF8());
+        else
+            std::printf("\nCould not write %s\n", file.getFullPathName().toRawUTF8());
+    }
+
+    //Every result carries a unique "key". Prints the change in metric per key against the
+    //baseline report and returns how many keys got slower by more than thresholdPercent.
+    inline int compareWithBaseline(const juce::Array<juce::var>& results, const juce::File& baselineFile,
+                                   const char* metric, double thresholdPercent)
+    {
+        const auto baseline = juce::JSON::parse(baselineFile);
+        const auto* list = baseline["results"].getArray();
+        if (list == nullptr)
+        {
+            std::printf("\nCould not read results from %s\n", baselineFile.getFullPathName().toRawUTF8());
+            return 0;
+        }
+
+        std::map<juce::String, double> before;
+        for (const auto& entry : *list)
+            before[entry["key"].toString()] = (double)entry[metric];
+
+        int regressions = 0;
+        std::printf("\n%s change vs %s (threshold %.1f%%)\n", metric, baselineFile.getFileName().toRawUTF8(), thresholdPercent);
+
+        for (const auto& result : results)
+        {
+            const auto key = result["key"].toString();
+            const auto it = before.find(key);
+            if (it == before.end() || it->second <= 0.0) continue;
+
+            const double change = 100.0 * ((double)result[metric] - it->second) / it->second;
+            const bool regressed = change > thresholdPercent;
+            regressions += regressed ? 1 : 0;
+
+            std::printf("  %-56s %+7.1f%%%s\n", key.toRawUTF8(), change, regressed ? "  REGRESSION" : "");
+        }
+
+        return regressions;
+    }
+}
+
+//Paint benchmark mode (PaintBench.cpp)
+int runPaintBench(const Bench::Options& options);
+
+//Loudness / true-peak conformance mode (Conformance.cpp)
+int runConformance(const Bench::Options& options);
+
+//Block-size independence stress test (BlockSizeStress.cpp)
+int runBlockSizeStress(const Bench::Options& options);
@@ -0,0 +1,268 @@
+//Block-size independence of the analyzers (resonance_bench --block-sizes).
+//
+//Drivers may deliver any block size, and not always the one they reported at start.
+//Each case feeds the same programme-like signal to two instances of an analyzer: one
+//in fixed 512-sample blocks, one in random blocks of 1 to 8192 samples. It then checks
+//that both produce bit-identical output. Compared:
+//  - LufsMeter: momentary, short-term, integrated and loudness range, read at
+//    checkpoints every 47 fixed blocks (the random feed is cut at the checkpoints);
+//  - TruePeakDetector: the whole oversampled stream from upsample(), as a running
+//    hash of its bit patterns per channel, compared at the same checkpoints.
+//Stereo and mono input are both covered (mono is duplicated internally).
+//
+//Built with RESONANCE_RT_SANITIZER=1, the random feed also runs inside a real-time
+//context and any allocation or lock in it fails the case. Without the sanitizer that
+//part is reported as not checked.
+//
+//The exit code is 1 when any case fails.
+
+#include <JuceHeader.h>
+#include "LufsMeter.h"
+#include "TruePeakDetector.h"
+#include "RealtimeSanitizer.h"
+#include "BenchCommon.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    constexpr int fixedBlockSize = 512;
+    constexpr int maxRandomBlockSize = 8192;
+    constexpr int checkpointBlocks = 47;          //about 0.5 s at 48 kHz
+    constexpr juce::int64 randomSeed = 0x5eed;
+
+    //Programme-like test signal: tones and noise with level steps every 1.5 s, so the
+    //gating, the loudness range and the inter-sample peaks all have something to do
+    juce::AudioBuffer<float> makeSignal(double sampleRate, double seconds, int numChannels)
+    {
+        const int total = (int)(sampleRate * seconds);
+        juce::AudioBuffer<float> signal(numChannels, total);
+        juce::Random random(1234);
+        const double twoPi = juce::MathConstants<double>::twoPi;
+        const double levels[] = { -6.0, -23.0, -14.0, -40.0, -2.0, -30.0 };
+
+        for (int i = 0; i < total; ++i)
+        {
+            const double t = i / sampleRate;
+            const double gain = juce::Decibels::decibelsToGain(levels[(int)(t / 1.5) % 6]);
+            const double tones = 0.6 * std::sin(twoPi * 997.0 * t) + 0.3 * std::sin(twoPi * 0.23 * sampleRate * t);
+            const float noise = 0.2f * (random.nextFloat() * 2.0f - 1.0f);
+
+            signal.setSample(0, i, (float)(gain * tones) + (float)gain * noise);
+            if (numChannels > 1)
+                signal.setSample(1, i, (float)(gain * 0.8 * tones) - (float)gain * noise);
+        }
+        return signal;
+    }
+
+    //FNV-1a over the bit patterns of floats
+    struct BitHash
+    {
+        juce::uint64 value = 14695981039346656037ull;
+
+        void add(const float* data, int n) noexcept
+        {
+            for (int i = 0; i < n; ++i)
+            {
+                juce::uint32 bits;
+                std::memcpy(&bits, data + i, sizeof bits);
+                value = (value ^ bits) * 1099511628211ull;
+            }
+        }
+    };
+
+    //Everything compared at one checkpoint
+    struct Readings
+    {
+        float momentary = 0.0f, shortTerm = 0.0f, integrated = 0.0f, range = 0.0f;
+        juce::uint64 truePeakHash[2] = {};
+
+        bool identicalTo(const Readings& o) const noexcept
+        {
+            return std::memcmp(&momentary, &o.momentary, sizeof(float)) == 0
+                && std::memcmp(&shortTerm, &o.shortTerm, sizeof(float)) == 0
+                && std::memcmp(&integrated, &o.integrated, sizeof(float)) == 0
+                && std::memcmp(&range, &o.range, sizeof(float)) == 0
+                && truePeakHash[0] == o.truePeakHash[0]
+                && truePeakHash[1] == o.truePeakHash[1];
+        }
+    };
+
+    struct Feed
+    {
+        LufsMeter lufs;
+        TruePeakDetector truePeak;
+        BitHash hash[2];   //per oversampled channel (the detector is stereo; mono is duplicated)
+
+        explicit Feed(double sampleRate)
+        {
+            lufs.prepare(sampleRate);
+            truePeak.prepare(sampleRate);
+        }
+
+        void process(const juce::AudioBuffer<float>& block)
+        {
+            lufs.processBlock(block);
+            truePeak.upsample(block, [this](const juce::dsp::AudioBlock<float>& up)
+                {
+                    for (size_t ch = 0; ch < juce::jmin(up.getNumChannels(), (size_t)2); ++ch)
+                        hash[ch].add(up.getChannelPointer(ch), (int)up.getNumSamples());
+                });
+        }
+
+        Readings read() const
+        {
+            return { lufs.getMomentaryLUFS(), lufs.getShortTermLUFS(), lufs.getIntegratedLUFS(),
+                     lufs.getLoudnessRange(), { hash[0].value, hash[1].value } };
+        }
+    };
+
+    //Feeds signal in blocks chosen by nextSize (cut at the checkpoints) and returns the
+    //readings at every checkpoint; counts sanitizer violations raised while processing
+    template <typename NextSize>
+    std::vector<Readings> feed(const juce::AudioBuffer<float>& signal, double sampleRate, NextSize&& nextSize,
+                               bool realtime, int& violations, int& blocks)
+    {
+        Feed analyzers(sampleRate);
+        const int total = signal.getNumSamples();
+        const int numChannels = signal.getNumChannels();
+        const int checkpointSamples = checkpointBlocks * fixedBlockSize;
+
+        std::vector<Readings> readings;
+        readings.reserve((size_t)(total / checkpointSamples + 2));
+
+        const int violationsBefore = RealtimeSanitizer::getTotalViolations();
+        float* channels[2] = {};
+        blocks = 0;
+
+        for (int start = 0; start < total;)
+        {
+            const int nextCheckpoint = (start / checkpointSamples + 1) * checkpointSamples;
+            const int n = juce::jmin(nextSize(), total - start, nextCheckpoint - start);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                channels[ch] = const_cast<float*>(signal.getReadPointer(ch, start));
+            const juce::AudioBuffer<float> block(channels, numChannels, n);
+
+            if (realtime)
+            {
+                RESONANCE_RT_CONTEXT;
+                analyzers.process(block);
+            }
+            else
+            {
+                analyzers.process(block);
+            }
+
+            start += n;
+            ++blocks;
+            if (start == nextCheckpoint || start == total)
+                readings.push_back(analyzers.read());
+        }
+
+        violations = RealtimeSanitizer::getTotalViolations() - violationsBefore;
+        return readings;
+    }
+
+    struct Result
+    {
+        juce::String name;
+        double sampleRate = 0.0;
+        int checkpoints = 0, firstMismatch = -1, violations = 0, randomBlocks = 0;
+        bool passed() const { return firstMismatch < 0 && violations == 0; }
+    };
+
+    Result runCase(const juce::String& name, int numChannels, double sampleRate, double seconds)
+    {
+        const auto signal = makeSignal(sampleRate, seconds, numChannels);
+
+        int unused = 0, fixedBlocks = 0;
+        const auto reference = feed(signal, sampleRate, [] { return fixedBlockSize; }, false, unused, fixedBlocks);
+
+        juce::Random random(randomSeed);
+        Result result;
+        result.name = name;
+        result.sampleRate = sampleRate;
+        const auto varied = feed(signal, sampleRate, [&random] { return 1 + random.nextInt(maxRandomBlockSize); },
+                                 true, result.violations, result.randomBlocks);
+
+        result.checkpoints = (int)reference.size();
+        for (size_t i = 0; i < reference.size(); ++i)
+        {
+            if (i >= varied.size() || !reference[i].identicalTo(varied[i]))
+            {
+                result.firstMismatch = (int)i;
+                break;
+            }
+        }
+        return result;
+    }
+
+    juce::var toJson(const Result& r)
+    {
+        auto* obj = new juce::DynamicObject();
+        obj->setProperty("key", r.name + "@" + juce::String((int)r.sampleRate));
+        obj->setProperty("name", r.name);
+        obj->setProperty("sampleRate", r.sampleRate);
+        obj->setProperty("checkpoints", r.checkpoints);
+        obj->setProperty("randomBlocks", r.randomBlocks);
+        obj->setProperty("firstMismatch", r.firstMismatch);
+        obj->setProperty("violations", r.violations);
+        obj->setProperty("passed", r.passed());
+        return juce::var(obj);
+    }
+}
+
+int runBlockSizeStress(const Bench::Options& options)
+{
+    const double quickRates[] = { 48000.0 };
+    const double allRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+    const auto rates = options.quick ? juce::Array<double>(quickRates, 1) : juce::Array<double>(allRates, 4);
+    const double seconds = options.quick ? 6.0 : 20.0;
+
+    struct Layout { const char* name; int numChannels; };
+    const Layout layouts[] = { { "stereo", 2 }, { "mono", 1 } };
+
+    juce::Array<juce::var> results;
+    int failures = 0;
+
+    std::printf("Fixed %d-sample blocks vs random 1..%d-sample blocks, %.0f s per case\n\n",
+                fixedBlockSize, maxRandomBlockSize, seconds);
+    std::printf("%-8s %7s %12s %12s %-24s %s\n", "case", "rate", "checkpoints", "rand blocks", "result", "rt violations");
+
+    for (const auto& layout : layouts)
+    {
+        if (options.filter.isNotEmpty() && !juce::String(layout.name).containsIgnoreCase(options.filter))
+            continue;
+
+        for (const auto sampleRate : rates)
+        {
+            const auto r = runCase(layout.name, layout.numChannels, sampleRate, seconds);
+            results.add(toJson(r));
+
+            const auto outcome = r.firstMismatch < 0 ? juce::String("bit-identical")
+                                                     : "FAIL from checkpoint " + juce::String(r.firstMismatch);
+            const auto violations = RealtimeSanitizer::isEnabled() ? juce::String(r.violations) + (r.violations > 0 ? " FAIL" : "")
+                                                                   : juce::String("not checked");
+            std::printf("%-8s %7d %12d %12d %-24s %s\n", layout.name, (int)sampleRate, r.checkpoints, r.randomBlocks,
+                        outcome.toRawUTF8(), violations.toRawUTF8());
+            std::fflush(stdout);
+
+            failures += r.passed() ? 0 : 1;
+        }
+    }
+
+    std::printf("\n%d case(s) failed\n", failures);
+    if (!RealtimeSanitizer::isEnabled())
+        std::printf("Build with RESONANCE_RT_SANITIZER=1 to also check the random feed for allocations and locks\n");
+    else if (failures > 0)
+        std::printf("%s", RealtimeSanitizer::getReport().toRawUTF8());
+
+    if (options.jsonFile != juce::File())
+        Bench::writeReport(Bench::makeReport("block-sizes", results), options.jsonFile);
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,345 @@
+//Loudness and true-peak conformance (resonance_bench --conformance).
+//
+//Generates the synthetic EBU Tech 3341 (loudness), Tech 3342 (loudness range) and
+//true-peak test signals in code (the stereo subset that BS.2217 also lists; the
+//multichannel and programme-material items need files and are not included) and
+//checks LufsMeter's M/S/I/LRA and TruePeakDetector's readings against the published
+//tolerances at 44.1, 48, 96 and 192 kHz. Each case also has to reach a minimum
+//processing throughput, so an accuracy fix cannot quietly make the meters slower.
+//The throughput floors only fail release builds; debug builds report them.
+//
+//The exit code is 1 when any check fails.
+
+#include <JuceHeader.h>
+#include "LufsMeter.h"
+#include "TruePeakDetector.h"
+#include "BenchCommon.h"
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+namespace
+{
+    constexpr int blockSize = 512;
+
+    //Throughput floors in stereo frames per second of processing time
+    constexpr double minLufsFramesPerSecond = 10.0e6;
+    constexpr double minTruePeakFramesPerSecond = 2.0e6;
+
+    //Stereo 1 kHz tone (both channels identical) stepping through levels; phase is continuous
+    struct Segment { double dbfs; double seconds; };
+
+    struct Check
+    {
+        enum class What { momentary, shortTerm, integrated, range, truePeak };
+        What what;
+        double expected, below, above;   //pass if expected - below <= reading <= expected + above
+        double from = -1.0;              //>= 0: every reading from this time on must pass; < 0: the final reading
+    };
+
+    struct Case
+    {
+        const char* id;
+        const char* description;
+        std::vector<Segment> segments;   //level steps of a 1 kHz tone...
+        double sineRatio = 0.0;          //...or, when > 0, a sine at sineRatio * fs
+        double sinePhaseDeg = 0.0, sineDbfs = 0.0, sineSeconds = 0.0;
+        std::vector<Check> checks;
+    };
+
+    const char* whatName(Check::What what)
+    {
+        switch (what)
+        {
+        case Check::What::momentary:  return "M";
+        case Check::What::shortTerm:  return "S";
+        case Check::What::integrated: return "I";
+        case Check::What::range:      return "LRA";
+        case Check::What::truePeak:   return "TP";
+        }
+        return "";
+    }
+
+    std::vector<Case> makeCases()
+    {
+        using W = Check::What;
+        const auto loudness = [](W what, double expected, double from = -1.0) { return Check{ what, expected, 0.1, 0.1, from }; };
+        const auto range = [](double expected) { return Check{ W::range, expected, 1.0, 1.0 }; };
+        const auto truePeak = [](double expected) { return Check{ W::truePeak, expected, 0.4, 0.2 }; };
+
+        //Alternating levels, repeated for the given duration
+        const auto alternate = [](double dbA, double secA, double dbB, double secB, double total)
+        {
+            std::vector<Segment> s;
+            for (double t = 0.0; t < total; t += secA + secB)
+            {
+                s.push_back({ dbA, secA });
+                s.push_back({ dbB, secB });
+            }
+            return s;
+        };
+
+        std::vector<Case> cases;
+
+        cases.push_back({ "3341-1", "-23 dBFS, 20 s", { { -23.0, 20.0 } }, 0, 0, 0, 0,
+            { loudness(W::momentary, -23.0), loudness(W::shortTerm, -23.0), loudness(W::integrated, -23.0) } });
+        cases.push_back({ "3341-2", "-33 dBFS, 20 s", { { -33.0, 20.0 } }, 0, 0, 0, 0,
+            { loudness(W::momentary, -33.0), loudness(W::shortTerm, -33.0), loudness(W::integrated, -33.0) } });
+        cases.push_back({ "3341-3", "-36/-23/-36 dBFS, 10/60/10 s", { { -36.0, 10.0 }, { -23.0, 60.0 }, { -36.0, 10.0 } }, 0, 0, 0, 0,
+            { loudness(W::integrated, -23.0) } });
+        cases.push_back({ "3341-4", "-72/-36/-23/-36/-72 dBFS, 10/10/60/10/10 s",
+            { { -72.0, 10.0 }, { -36.0, 10.0 }, { -23.0, 60.0 }, { -36.0, 10.0 }, { -72.0, 10.0 } }, 0, 0, 0, 0,
+            { loudness(W::integrated, -23.0) } });
+        cases.push_back({ "3341-5", "-26/-20/-26 dBFS, 20/20.1/20 s", { { -26.0, 20.0 }, { -20.0, 20.1 }, { -26.0, 20.0 } }, 0, 0, 0, 0,
+            { loudness(W::integrated, -23.0) } });
+        cases.push_back({ "3341-8", "0.18 s -20 dBFS / 0.22 s -30 dBFS, 20 s", alternate(-20.0, 0.18, -30.0, 0.22, 20.0), 0, 0, 0, 0,
+            { loudness(W::momentary, -23.0, 1.0) } });
+        cases.push_back({ "3341-9", "1.34 s -20 dBFS / 1.66 s -30 dBFS, 20 s", alternate(-20.0, 1.34, -30.0, 1.66, 20.0), 0, 0, 0, 0,
+            { loudness(W::shortTerm, -23.0, 3.0) } });
+
+        cases.push_back({ "3342-1", "-20/-30 dBFS, 20 s each", { { -20.0, 20.0 }, { -30.0, 20.0 } }, 0, 0, 0, 0, { range(10.0) } });
+        cases.push_back({ "3342-2", "-20/-15 dBFS, 20 s each", { { -20.0, 20.0 }, { -15.0, 20.0 } }, 0, 0, 0, 0, { range(5.0) } });
+        cases.push_back({ "3342-3", "-40/-20 dBFS, 20 s each", { { -40.0, 20.0 }, { -20.0, 20.0 } }, 0, 0, 0, 0, { range(20.0) } });
+        cases.push_back({ "3342-4", "-50/-35/-20/-35/-50 dBFS, 20 s each",
+            { { -50.0, 20.0 }, { -35.0, 20.0 }, { -20.0, 20.0 }, { -35.0, 20.0 }, { -50.0, 20.0 } }, 0, 0, 0, 0, { range(15.0) } });
+
+        //Sines whose samples miss the waveform peak: the sample peak reads low, the true peak must not
+        cases.push_back({ "tp-fs/4", "fs/4 sine, 45 deg, -6 dBTP", {}, 1.0 / 4.0, 45.0, -6.0, 1.0, { truePeak(-6.0) } });
+        cases.push_back({ "tp-fs/6", "fs/6 sine, 60 deg, -6 dBTP", {}, 1.0 / 6.0, 60.0, -6.0, 1.0, { truePeak(-6.0) } });
+        cases.push_back({ "tp-fs/8", "fs/8 sine, 67.5 deg, -6 dBTP", {}, 1.0 / 8.0, 67.5, -6.0, 1.0, { truePeak(-6.0) } });
+        cases.push_back({ "tp-over", "fs/4 sine, 45 deg, 0 dBFS sample peak (+3 dBTP)", {}, 1.0 / 4.0, 45.0, 3.01, 1.0, { truePeak(3.01) } });
+
+        return cases;
+    }
+
+    //Fills block with the case's signal from sample `start` on
+    class Generator
+    {
+    public:
+        Generator(const Case& c, double sampleRateIn) : cs(c), sampleRate(sampleRateIn)
+        {
+            if (cs.sineRatio > 0.0)
+            {
+                totalSamples = (juce::int64)std::llround(cs.sineSeconds * sampleRate);
+                return;
+            }
+
+            for (const auto& s : cs.segments)
+            {
+                totalSamples += (juce::int64)std::llround(s.seconds * sampleRate);
+                segmentEnds.push_back(totalSamples);
+            }
+        }
+
+        juce::int64 getTotalSamples() const noexcept { return totalSamples; }
+
+        void render(juce::AudioBuffer<float>& block, juce::int64 start)
+        {
+            const double twoPi = juce::MathConstants<double>::twoPi;
+
+            for (int i = 0; i < block.getNumSamples(); ++i)
+            {
+                const auto n = start + i;
+                double v;
+
+                if (cs.sineRatio > 0.0)
+                {
+                    v = std::pow(10.0, cs.sineDbfs / 20.0)
+                      * std::sin(twoPi * cs.sineRatio * (double)n + juce::degreesToRadians(cs.sinePhaseDeg));
+                }
+                else
+                {
+                    while (segment + 1 < segmentEnds.size() && n >= segmentEnds[segment]) ++segment;
+                    v = std::pow(10.0, cs.segments[segment].dbfs / 20.0) * std::sin(twoPi * 1000.0 * (double)n / sampleRate);
+                }
+
+                block.setSample(0, i, (float)v);
+                block.setSample(1, i, (float)v);
+            }
+        }
+
+    private:
+        const Case& cs;
+        double sampleRate;
+        juce::int64 totalSamples = 0;
+        std::vector<juce::int64> segmentEnds;
+        size_t segment = 0;
+    };
+
+    struct CheckResult
+    {
+        Check check;
+        double low = 1.0e9, high = -1.0e9;   //range of the readings that were checked
+
+        bool passed() const { return low >= check.expected - check.below && high <= check.expected + check.above; }
+    };
+
+    struct Result
+    {
+        juce::String id, description;
+        double sampleRate = 0.0;
+        std::vector<CheckResult> checks;
+        double lufsFramesPerSecond = 0.0, truePeakFramesPerSecond = 0.0;
+        bool accurate = true, fastEnough = true;
+    };
+
+    Result runCase(const Case& c, double sampleRate)
+    {
+        LufsMeter lufs;
+        lufs.prepare(sampleRate);
+        TruePeakDetector truePeak(2, 2);
+        truePeak.prepare(sampleRate);
+
+        Generator generator(c, sampleRate);
+        const auto total = generator.getTotalSamples();
+        const auto settleSamples = (juce::int64)(0.1 * sampleRate); //oversampling filter start-up transient
+
+        Result result;
+        result.id = c.id;
+        result.description = c.description;
+        result.sampleRate = sampleRate;
+        for (const auto& check : c.checks)
+            result.checks.push_back({ check });
+
+        juce::AudioBuffer<float> block(2, blockSize);
+        std::vector<float> peaks;
+        double peak = 0.0;
+        juce::int64 lufsTicks = 0, truePeakTicks = 0;
+
+        for (juce::int64 start = 0; start < total; start += blockSize)
+        {
+            const int n = (int)juce::jmin((juce::int64)blockSize, total - start);
+            block.setSize(2, n, false, false, true);
+            generator.render(block, start);
+
+            const auto t0 = juce::Time::getHighResolutionTicks();
+            lufs.processBlock(block);
+            const auto t1 = juce::Time::getHighResolutionTicks();
+            truePeak.processBlock(block, peaks);
+            const auto t2 = juce::Time::getHighResolutionTicks();
+
+            lufsTicks += t1 - t0;
+            truePeakTicks += t2 - t1;
+
+            if (start >= settleSamples)
+                for (const auto p : peaks) peak = juce::jmax(peak, (double)p);
+
+            const double now = (double)(start + n) / sampleRate;
+            const bool last = start + n >= total;
+
+            for (auto& r : result.checks)
+            {
+                if (!(last || (r.check.from >= 0.0 && now >= r.check.from)))
+                    continue;
+
+                double reading = 0.0;
+                switch (r.check.what)
+                {
+                case Check::What::momentary:  reading = lufs.getMomentaryLUFS(); break;
+                case Check::What::shortTerm:  reading = lufs.getShortTermLUFS(); break;
+                case Check::What::integrated: reading = lufs.getIntegratedLUFS(); break;
+                case Check::What::range:      reading = lufs.getLoudnessRange(); break;
+                case Check::What::truePeak:   reading = TruePeakDetector::linearToDb((float)peak); break;
+                }
+
+                r.low = juce::jmin(r.low, reading);
+                r.high = juce::jmax(r.high, reading);
+            }
+        }
+
+        const double ticksPerSecond = (double)juce::Time::getHighResolutionTicksPerSecond();
+        result.lufsFramesPerSecond = (double)total * ticksPerSecond / (double)juce::jmax((juce::int64)1, lufsTicks);
+        result.truePeakFramesPerSecond = (double)total * ticksPerSecond / (double)juce::jmax((juce::int64)1, truePeakTicks);
+
+        for (const auto& r : result.checks)
+            result.accurate = result.accurate && r.passed();
+        result.fastEnough = result.lufsFramesPerSecond >= minLufsFramesPerSecond
+                         && result.truePeakFramesPerSecond >= minTruePeakFramesPerSecond;
+        return result;
+    }
+
+    juce::var toJson(const Result& r)
+    {
+        juce::Array<juce::var> checks;
+        for (const auto& c : r.checks)
+        {
+            auto* obj = new juce::DynamicObject();
+            obj->setProperty("reading", whatName(c.check.what));
+            obj->setProperty("expected", c.check.expected);
+            obj->setProperty("low", c.low);
+            obj->setProperty("high", c.high);
+            obj->setProperty("passed", c.passed());
+            checks.add(juce::var(obj));
+        }
+
+        auto* obj = new juce::DynamicObject();
+        obj->setProperty("key", r.id + "@" + juce::String((int)r.sampleRate));
+        obj->setProperty("name", r.id);
+        obj->setProperty("description", r.description);
+        obj->setProperty("sampleRate", r.sampleRate);
+        obj->setProperty("checks", checks);
+        obj->setProperty("lufsNsPerFrame", 1.0e9 / r.lufsFramesPerSecond);
+        obj->setProperty("truePeakNsPerFrame", 1.0e9 / r.truePeakFramesPerSecond);
+        obj->setProperty("accurate", r.accurate);
+        obj->setProperty("fastEnough", r.fastEnough);
+        return juce::var(obj);
+    }
+}
+
+int runConformance(const Bench::Options& options)
+{
+    const double quickRates[] = { 48000.0 };
+    const double allRates[] = { 44100.0, 48000.0, 96000.0, 192000.0 };
+    const auto rates = options.quick ? juce::Array<double>(quickRates, 1) : juce::Array<double>(allRates, 4);
+
+    juce::Array<juce::var> results;
+    int failures = 0, slowCases = 0;
+
+    std::printf("%-8s %7s %-4s %9s %-13s %-6s %12s %12s\n",
+                "case", "rate", "", "expected", "reading", "", "LUFS ns/fr", "TP ns/fr");
+
+    for (const auto& c : makeCases())
+    {
+        if (options.filter.isNotEmpty() && !juce::String(c.id).containsIgnoreCase(options.filter))
+            continue;
+
+        for (const auto sampleRate : rates)
+        {
+            const auto r = runCase(c, sampleRate);
+            results.add(toJson(r));
+
+            for (const auto& check : r.checks)
+            {
+                const auto low = juce::String(check.low, 2), high = juce::String(check.high, 2);
+                const auto reading = low == high ? low : low + ".." + high;
+                std::printf("%-8s %7d %-4s %9.2f %-13s %-6s %12.1f %12.1f\n",
+                            c.id, (int)sampleRate, whatName(check.check.what), check.check.expected, reading.toRawUTF8(),
+                            check.passed() ? "ok" : "FAIL", 1.0e9 / r.lufsFramesPerSecond, 1.0e9 / r.truePeakFramesPerSecond);
+            }
+            std::fflush(stdout);
+
+            failures += r.accurate ? 0 : 1;
+            slowCases += r.fastEnough ? 0 : 1;
+        }
+    }
+
+    std::printf("\n%d case(s) out of tolerance, %d below the throughput floor (%.0f ns/frame LUFS, %.0f ns/frame true peak)\n",
+                failures, slowCases, 1.0e9 / minLufsFramesPerSecond, 1.0e9 / minTruePeakFramesPerSecond);
+
+   #if JUCE_DEBUG
+    if (slowCases > 0)
+        std::printf("Debug build: throughput floors are not enforced\n");
+    slowCases = 0;
+   #endif
+
+    if (options.jsonFile != juce::File())
+        Bench::writeReport(Bench::makeReport("conformance", results), options.jsonFile);
+
+    if (options.baselineFile != juce::File()
+        && Bench::compareWithBaseline(results, options.baselineFile, "lufsNsPerFrame", options.thresholdPercent) > 0)
+        return 1;
+
+    return failures + slowCases > 0 ? 1 : 0;
+}
@@ -0,0 +1,250 @@
+//Headless paint benchmark (resonance_bench --paint).
+//
+//Each visualizer and the dB meter is created offscreen, fed with representative
+//data and painted into an Image at several sizes, at 1x and 2x display scale. A
+//visualizer frame costs two steps: renderFrame() into its offscreen image (normally
+//on the render thread, run here synchronously through renderNow()) and paint(),
+//which blits that image. Both are timed per frame; the report gives percentiles of
+//their sum, plus the median of each step. Feeding new data between frames is not
+//timed. Level of detail is pinned at full detail so the numbers stay comparable.
+//
+//Cases larger than a 4K display in physical pixels (e.g. 4K at 2x) are skipped.
+
+#include <JuceHeader.h>
+#include "MainComponent.h"
+#include "BenchCommon.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    constexpr double signalRate = 48000.0;
+    constexpr int feedBlockSize = 1024;
+    constexpr int maxPhysicalPixels = 3840 * 2160;
+
+    struct Target
+    {
+        const char* name;
+        std::function<std::unique_ptr<juce::Component>()> create;
+        std::function<void(juce::Component&, int frame)> feed; //new data before each frame (untimed)
+    };
+
+    struct Result
+    {
+        juce::String name;
+        int width = 0, height = 0;
+        float scale = 1.0f;
+        int frames = 0;
+        double p50Ms = 0.0, p90Ms = 0.0, p99Ms = 0.0, maxMs = 0.0;
+        double renderP50Ms = 0.0, paintP50Ms = 0.0;
+    };
+
+    //Programme-like stereo material: a few partials with slow amplitude movement, noise,
+    //and a partly decorrelated right channel (so the stereo image has some width)
+    juce::AudioBuffer<float> makeSignal(int numSamples)
+    {
+        juce::AudioBuffer<float> signal(2, numSamples);
+        juce::Random random(0xc0ffee);
+        const double twoPi = juce::MathConstants<double>::twoPi;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const double t = i / signalRate;
+            const double envelope = 0.6 + 0.4 * std::sin(twoPi * 0.7 * t);
+            const double partials = 0.30 * std::sin(twoPi * 110.0 * t) + 0.15 * std::sin(twoPi * 440.0 * t)
+                                  + 0.08 * std::sin(twoPi * 1760.0 * t) + 0.04 * std::sin(twoPi * 7040.0 * t);
+            const float noise = 0.05f * (random.nextFloat() * 2.0f - 1.0f);
+
+            signal.setSample(0, i, (float)(envelope * partials) + noise);
+            signal.setSample(1, i, (float)(envelope * (0.8 * partials + 0.1 * std::sin(twoPi * 220.0 * t))) - noise);
+        }
+        return signal;
+    }
+
+    //Pushes block number `frame` (wrapping) of signal into a visualizer's pushSamples
+    template <typename Visualizer>
+    void pushBlock(juce::Component& c, juce::AudioBuffer<float>& signal, int frame)
+    {
+        const int numBlocks = signal.getNumSamples() / feedBlockSize;
+        const int start = (frame % numBlocks) * feedBlockSize;
+        float* channels[2] = { signal.getWritePointer(0, start), signal.getWritePointer(1, start) };
+        const juce::AudioBuffer<float> block(channels, 2, feedBlockSize);
+        static_cast<Visualizer&>(c).pushSamples(block);
+    }
+
+    std::vector<Target> makeTargets(juce::AudioBuffer<float>& signal)
+    {
+        std::vector<Target> targets;
+        auto* s = &signal;
+
+        targets.push_back({ "Oscilloscope",
+            [] { auto o = std::make_unique<Oscilloscope>(); o->setSampleRate(signalRate); return std::unique_ptr<juce::Component>(std::move(o)); },
+            [s](juce::Component& c, int frame) { pushBlock<Oscilloscope>(c, *s, frame); } });
+
+        targets.push_back({ "Waveform",
+            [] { auto w = std::make_unique<Waveform>(); w->setSampleRate(signalRate); return std::unique_ptr<juce::Component>(std::move(w)); },
+            [s](juce::Component& c, int frame) { pushBlock<Waveform>(c, *s, frame); } });
+
+        targets.push_back({ "StereoImage",
+            [] { return std::unique_ptr<juce::Component>(std::make_unique<StereoImage>()); },
+            [s](juce::Component& c, int frame) { pushBlock<StereoImage>(c, *s, frame); } });
+
+        targets.push_back({ "SpectrumAnalyzer",
+            [] {
+                auto spectrum = std::make_unique<SpectrumAnalyzer>();
+                spectrum->setSampleRate(signalRate);
+                spectrum->setDbRange(-90.0f, 0.0f);
+                spectrum->setFreqRange(20.0f, 20000.0f);
+                spectrum->setSmoothing(0.25f, 1);
+                return std::unique_ptr<juce::Component>(std::move(spectrum));
+            },
+            [s](juce::Component& c, int frame) { pushBlock<SpectrumAnalyzer>(c, *s, frame); } });
+
+        targets.push_back({ "dbMeter",
+            [] { return std::unique_ptr<juce::Component>(std::make_unique<dbMeter>()); },
+            [](juce::Component& c, int frame)
+            {
+                //Level swings across the scale so every frame paints a different fill
+                const float level = -30.0f + 25.0f * (float)std::sin(frame * 0.37);
+                static_cast<dbMeter&>(c).setReading({ level, juce::jmin(0.0f, level + 6.0f), frame % 50 == 0 });
+            } });
+
+        return targets;
+    }
+
+    double percentile(const std::vector<double>& sorted, double p)
+    {
+        const auto rank = (size_t)std::ceil(p * (double)sorted.size());
+        return sorted[juce::jlimit((size_t)0, sorted.size() - 1, rank == 0 ? 0 : rank - 1)];
+    }
+
+    Result runCase(const Target& target, int width, int height, float scale, int frames)
+    {
+        auto component = target.create();
+        component->setSize(width, height);
+
+        auto* visualizer = dynamic_cast<VisualizerComponent*>(component.get());
+        if (visualizer != nullptr)
+        {
+            visualizer->detachFromRenderThread();  //frames are rendered only by renderNow() below
+            visualizer->setFrameBudgetMs(1.0e6);   //never coarsen the detail level
+        }
+
+        juce::Image image(juce::Image::ARGB, juce::roundToInt(width * scale), juce::roundToInt(height * scale), true);
+        const double ticksToMs = 1.0e3 / (double)juce::Time::getHighResolutionTicksPerSecond();
+
+        //Fill the history (scope/waveform windows, spectrum averaging) before timing
+        const int warmupFrames = (int)(2.0 * signalRate / feedBlockSize);
+        for (int f = 0; f < warmupFrames; ++f)
+            target.feed(*component, f);
+
+        std::vector<double> total, render, paint;
+        for (int f = -3; f < frames; ++f) //the first three frames are warm-up
+        {
+            target.feed(*component, warmupFrames + f);
+
+            const auto t0 = juce::Time::getHighResolutionTicks();
+            if (visualizer != nullptr)
+                visualizer->renderNow(scale);
+
+            const auto t1 = juce::Time::getHighResolutionTicks();
+            {
+                juce::Graphics g(image);
+                g.addTransform(juce::AffineTransform::scale(scale));
+                component->paintEntireComponent(g, true);
+            }
+            const auto t2 = juce::Time::getHighResolutionTicks();
+
+            if (f < 0) continue;
+            render.push_back((double)(t1 - t0) * ticksToMs);
+            paint.push_back((double)(t2 - t1) * ticksToMs);
+            total.push_back((double)(t2 - t0) * ticksToMs);
+        }
+
+        std::sort(total.begin(), total.end());
+        std::sort(render.begin(), render.end());
+        std::sort(paint.begin(), paint.end());
+
+        Result r;
+        r.name = target.name;
+        r.width = width;
+        r.height = height;
+        r.scale = scale;
+        r.frames = frames;
+        r.p50Ms = percentile(total, 0.50);
+        r.p90Ms = percentile(total, 0.90);
+        r.p99Ms = percentile(total, 0.99);
+        r.maxMs = total.back();
+        r.renderP50Ms = percentile(render, 0.50);
+        r.paintP50Ms = percentile(paint, 0.50);
+        return r;
+    }
+
+    juce::var toJson(const Result& r)
+    {
+        auto* obj = new juce::DynamicObject();
+        obj->setProperty("key", r.name + "@" + juce::String(r.width) + "x" + juce::String(r.height) + "@" + juce::String(r.scale, 0) + "x");
+        obj->setProperty("name", r.name);
+        obj->setProperty("width", r.width);
+        obj->setProperty("height", r.height);
+        obj->setProperty("scale", r.scale);
+        obj->setProperty("frames", r.frames);
+        obj->setProperty("p50Ms", r.p50Ms);
+        obj->setProperty("p90Ms", r.p90Ms);
+        obj->setProperty("p99Ms", r.p99Ms);
+        obj->setProperty("maxMs", r.maxMs);
+        obj->setProperty("renderP50Ms", r.renderP50Ms);
+        obj->setProperty("paintP50Ms", r.paintP50Ms);
+        return juce::var(obj);
+    }
+}
+
+int runPaintBench(const Bench::Options& options)
+{
+    const juce::Point<int> sizes[] = { { 640, 350 }, { 1280, 720 }, { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 } };
+    const float scales[] = { 1.0f, 2.0f };
+    const int frames = options.quick ? 10 : 60;
+
+    auto signal = makeSignal((int)(4.0 * signalRate));
+    juce::Array<juce::var> results;
+
+    std::printf("%-18s %11s %5s %9s %9s %9s %9s %10s %10s\n",
+                "component", "size", "scale", "p50 ms", "p90 ms", "p99 ms", "max ms", "render p50", "paint p50");
+
+    for (const auto& target : makeTargets(signal))
+    {
+        if (options.filter.isNotEmpty() && !juce::String(target.name).containsIgnoreCase(options.filter))
+            continue;
+
+        for (const auto& size : sizes)
+        {
+            for (const auto scale : scales)
+            {
+                if ((double)size.x * size.y * scale * scale > (double)maxPhysicalPixels)
+                    continue;
+
+                const auto r = runCase(target, size.x, size.y, scale, frames);
+                results.add(toJson(r));
+
+                std::printf("%-18s %5dx%-5d %4.0fx %9.3f %9.3f %9.3f %9.3f %10.3f %10.3f\n",
+                            r.name.toRawUTF8(), r.width, r.height, r.scale,
+                            r.p50Ms, r.p90Ms, r.p99Ms, r.maxMs, r.renderP50Ms, r.paintP50Ms);
+                std::fflush(stdout);
+            }
+        }
+    }
+
+    if (options.jsonFile != juce::File())
+        Bench::writeReport(Bench::makeReport("paint", results), options.jsonFile);
+
+    if (options.baselineFile != juce::File()
+        && Bench::compareWithBaseline(results, options.baselineFile, "p50Ms", options.thresholdPercent) > 0)
+        return 1;
+
+    return 0;
+}
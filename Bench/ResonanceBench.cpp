@@ -0,0 +1,279 @@
+//Micro-benchmarks for the analyzer classes and the visualizer feeds, plus the
+//visualizer paint benchmark (--paint, see PaintBench.cpp), the meter conformance
+//checks (--conformance, see Conformance.cpp) and the block-size stress test
+//(--block-sizes, see BlockSizeStress.cpp).
+//
+//Each analyzer case runs one processing entry point over a synthetic stereo signal
+//(tone + noise), split into blocks of the given size, at several sample rates. Timings
+//are reported in ns per input sample (best and median of the repeats; the first,
+//warm-up pass is discarded).
+//
+//  resonance_bench [--paint | --conformance | --block-sizes] [--quick] [--filter <text>] [--json <file>]
+//                  [--compare <baseline.json>] [--threshold <percent>]
+//
+//--json writes the results for later comparison; --compare prints the change against
+//an earlier run of the same mode and exits with 1 if any case got slower than the
+//threshold (10%).
+
+#include <JuceHeader.h>
+#include "MainComponent.h"
+#include "BenchCommon.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace
+{
+    struct Result
+    {
+        juce::String name;
+        double sampleRate = 0.0;
+        int blockSize = 0;
+        juce::int64 samples = 0;    //per run
+        double nsPerSample = 0.0;   //best run
+        double nsPerSampleMedian = 0.0;
+        double nsPerFrame = 0.0;    //analysis frames only (0 = not applicable)
+    };
+
+    //Processes one block; created fresh for every (sample rate, block size) case
+    using Processor = std::function<void(const juce::AudioBuffer<float>&)>;
+
+    struct Case
+    {
+        const char* name;
+        std::function<Processor(double sampleRate, int blockSize)> create;
+        double framesPerSample = 0.0; //for nsPerFrame
+    };
+
+    constexpr int spectrumOrder = 12;
+    volatile float sink = 0.0f; //keeps results of pure functions alive
+
+    //Deterministic stereo signal: a 997 Hz tone with a little noise, R slightly quieter
+    juce::AudioBuffer<float> makeSignal(double sampleRate, int numSamples)
+    {
+        juce::AudioBuffer<float> signal(2, numSamples);
+        juce::Random random(0x5eed);
+        const double delta = juce::MathConstants<double>::twoPi * 997.0 / sampleRate;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float tone = 0.5f * (float)std::sin(delta * i);
+            signal.setSample(0, i, tone + 0.05f * (random.nextFloat() * 2.0f - 1.0f));
+            signal.setSample(1, i, 0.8f * tone + 0.05f * (random.nextFloat() * 2.0f - 1.0f));
+        }
+        return signal;
+    }
+
+    std::vector<Case> makeCases()
+    {
+        std::vector<Case> cases;
+
+        cases.push_back({ "calculateRMS", [](double, int)
+            {
+                return Processor([](const juce::AudioBuffer<float>& block)
+                    {
+                        for (int ch = 0; ch < block.getNumChannels(); ++ch)
+                            sink = sink + MainComponent::calculateRMS(block, 0, block.getNumSamples(), ch);
+                    });
+            } });
+
+        cases.push_back({ "LufsMeter::processBlock", [](double sampleRate, int)
+            {
+                auto meter = std::make_shared<LufsMeter>();
+                meter->prepare(sampleRate);
+                return Processor([meter](const juce::AudioBuffer<float>& block) { meter->processBlock(block); });
+            } });
+
+        cases.push_back({ "TruePeakDetector::processBlock", [](double sampleRate, int blockSize)
+            {
+                auto detector = std::make_shared<TruePeakDetector>(2, 2);
+                detector->prepare(sampleRate, blockSize);
+                auto peaks = std::make_shared<std::vector<float>>(2, 0.0f);
+                return Processor([detector, peaks](const juce::AudioBuffer<float>& block) { detector->processBlock(block, *peaks); });
+            } });
+
+        //Wide inputs: the stereo signal referred to repeatedly (no copies), so ns/sample
+        //per case shows how the bridge's cost grows with the channel count
+        const std::pair<const char*, int> bridgeCases[] = { { "MeterBridge::process x2", 2 }, { "MeterBridge::process x8", 8 },
+                                                            { "MeterBridge::process x32", 32 }, { "MeterBridge::process x64", 64 } };
+        for (const auto& [name, channels] : bridgeCases)
+        {
+            cases.push_back({ name, [channels = channels](double sampleRate, int blockSize)
+                {
+                    auto bridge = std::make_shared<MeterBridge>();
+                    bridge->prepare(sampleRate, blockSize, channels);
+                    auto pointers = std::make_shared<std::vector<const float*>>((size_t)channels);
+                    return Processor([bridge, pointers, channels](const juce::AudioBuffer<float>& block)
+                        {
+                            for (int ch = 0; ch < channels; ++ch)
+                                (*pointers)[(size_t)ch] = block.getReadPointer(ch % 2);
+                            bridge->process(pointers->data(), channels, block.getNumSamples());
+
+                            //Time each block until its snapshot is out, workers included
+                            while (bridge->isBusy()) {}
+                        });
+                } });
+        }
+
+        cases.push_back({ "SpectrumAnalyzer::pushSamples", [](double sampleRate, int)
+            {
+                auto spectrum = std::make_shared<SpectrumAnalyzer>(spectrumOrder);
+                spectrum->setSampleRate(sampleRate);
+                return Processor([spectrum](const juce::AudioBuffer<float>& block) { spectrum->pushSamples(block); });
+            }, 4.0 / (1 << spectrumOrder) }); //4x overlap: one FFT frame per hop of fftSize / 4 samples
+
+        cases.push_back({ "Oscilloscope::pushSamples", [](double sampleRate, int)
+            {
+                auto scope = std::make_shared<Oscilloscope>();
+                scope->setSampleRate(sampleRate);
+                return Processor([scope](const juce::AudioBuffer<float>& block) { scope->pushSamples(block); });
+            } });
+
+        cases.push_back({ "Waveform::pushSamples", [](double sampleRate, int)
+            {
+                auto waveform = std::make_shared<Waveform>();
+                waveform->setSampleRate(sampleRate);
+                return Processor([waveform](const juce::AudioBuffer<float>& block) { waveform->pushSamples(block); });
+            } });
+
+        cases.push_back({ "StereoImage::pushSamples", [](double, int)
+            {
+                auto stereo = std::make_shared<StereoImage>();
+                return Processor([stereo](const juce::AudioBuffer<float>& block) { stereo->pushSamples(block); });
+            } });
+
+        cases.push_back({ "TransferFunctionAnalyzer::pushSamples", [](double sampleRate, int)
+            {
+                auto transfer = std::make_shared<TransferFunctionAnalyzer>();
+                transfer->setSampleRate(sampleRate);
+                return Processor([transfer](const juce::AudioBuffer<float>& block) { transfer->pushSamples(block); });
+            } });
+
+        cases.push_back({ "PitchTracker::pushSamples", [](double sampleRate, int)
+            {
+                auto pitch = std::make_shared<PitchTracker>();
+                pitch->setSampleRate(sampleRate);
+                return Processor([pitch](const juce::AudioBuffer<float>& block) { pitch->pushSamples(block); });
+            } });
+
+        return cases;
+    }
+
+    //Runs process over signal in blocks of blockSize, repeats + 1 times (the first is warm-up)
+    Result runCase(const Case& c, double sampleRate, int blockSize, juce::AudioBuffer<float>& signal, int repeats)
+    {
+        auto process = c.create(sampleRate, blockSize);
+        const int numBlocks = signal.getNumSamples() / blockSize;
+        const auto samples = (juce::int64)numBlocks * blockSize;
+        const double ticksToNs = 1.0e9 / (double)juce::Time::getHighResolutionTicksPerSecond();
+
+        std::vector<double> runs;
+        for (int r = 0; r <= repeats; ++r)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                //Refer into the signal, as the device callback's buffers do (no copy)
+                float* channels[2] = { signal.getWritePointer(0, b * blockSize), signal.getWritePointer(1, b * blockSize) };
+                const juce::AudioBuffer<float> block(channels, 2, blockSize);
+                process(block);
+            }
+
+            if (r > 0)
+                runs.push_back((double)(juce::Time::getHighResolutionTicks() - start) * ticksToNs / (double)samples);
+        }
+
+        std::sort(runs.begin(), runs.end());
+
+        Result result;
+        result.name = c.name;
+        result.sampleRate = sampleRate;
+        result.blockSize = blockSize;
+        result.samples = samples;
+        result.nsPerSample = runs.front();
+        result.nsPerSampleMedian = runs[runs.size() / 2];
+        result.nsPerFrame = c.framesPerSample > 0.0 ? result.nsPerSample / c.framesPerSample : 0.0;
+        return result;
+    }
+
+    juce::Array<juce::var> toJson(const std::vector<Result>& results)
+    {
+        juce::Array<juce::var> list;
+        for (const auto& r : results)
+        {
+            auto* obj = new juce::DynamicObject();
+            obj->setProperty("key", r.name + "@" + juce::String((int)r.sampleRate) + "/" + juce::String(r.blockSize));
+            obj->setProperty("name", r.name);
+            obj->setProperty("sampleRate", r.sampleRate);
+            obj->setProperty("blockSize", r.blockSize);
+            obj->setProperty("samples", r.samples);
+            obj->setProperty("nsPerSample", r.nsPerSample);
+            obj->setProperty("nsPerSampleMedian", r.nsPerSampleMedian);
+            if (r.nsPerFrame > 0.0)
+                obj->setProperty("nsPerFrame", r.nsPerFrame);
+            list.add(juce::var(obj));
+        }
+        return list;
+    }
+
+    int runAnalyzerBench(const Bench::Options& options)
+    {
+        const double sampleRates[] = { 44100.0, 48000.0, 96000.0 };
+        const int blockSizes[] = { 32, 128, 512, 2048 };
+        const double seconds = options.quick ? 0.5 : 4.0;
+        const int repeats = options.quick ? 3 : 7;
+
+        std::vector<Result> results;
+        std::printf("%-40s %9s %6s %12s %12s\n", "case", "rate", "block", "ns/sample", "median");
+
+        for (const auto& c : makeCases())
+        {
+            if (options.filter.isNotEmpty() && !juce::String(c.name).containsIgnoreCase(options.filter))
+                continue;
+
+            for (const auto sampleRate : sampleRates)
+            {
+                auto signal = makeSignal(sampleRate, (int)(seconds * sampleRate));
+
+                for (const auto blockSize : blockSizes)
+                {
+                    results.push_back(runCase(c, sampleRate, blockSize, signal, repeats));
+                    const auto& r = results.back();
+                    std::printf("%-40s %9d %6d %12.2f %12.2f\n", r.name.toRawUTF8(), (int)r.sampleRate, r.blockSize,
+                                r.nsPerSample, r.nsPerSampleMedian);
+                    std::fflush(stdout);
+                }
+            }
+        }
+
+        const auto list = toJson(results);
+
+        if (options.jsonFile != juce::File())
+            Bench::writeReport(Bench::makeReport("analyzers", list), options.jsonFile);
+
+        if (options.baselineFile != juce::File()
+            && Bench::compareWithBaseline(list, options.baselineFile, "nsPerSample", options.thresholdPercent) > 0)
+            return 1;
+
+        return 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const juce::ScopedJuceInitialiser_GUI juceInit; //the visualizers are Components
+
+    juce::StringArray args;
+    for (int i = 1; i < argc; ++i)
+        args.add(argv[i]);
+    const auto options = Bench::parseOptions(args);
+
+    if (args.contains("--paint"))       return runPaintBench(options);
+    if (args.contains("--conformance")) return runConformance(options);
+    if (args.contains("--block-sizes")) return runBlockSizeStress(options);
+    return runAnalyzerBench(options);
+}
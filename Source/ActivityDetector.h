@@ -0,0 +1,64 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+//Block-level signal activity gate for the audio callback. Each block costs one
+//vectorized min/max scan per channel. Activity starts on the first block whose
+//peak crosses the on-threshold, and ends once the peak has stayed under the
+//(lower) off-threshold for the hold time, which gives the spectrum's smoothing
+//time to decay to its floor. Views with a time axis are not held up by it: while
+//the gate is closed the callback advances them with silence instead.
+
+class ActivityDetector
+{
+public:
+    void prepare(double sampleRate, float onThresholdDb = -60.0f, float offThresholdDb = -66.0f, double holdSeconds = 3.0)
+    {
+        onThreshold = juce::Decibels::decibelsToGain(onThresholdDb);
+        offThreshold = juce::Decibels::decibelsToGain(juce::jmin(offThresholdDb, onThresholdDb));
+        holdSamples = juce::jmax((juce::int64)1, (juce::int64)(holdSeconds * sampleRate));
+        quietSamples = 0;
+        active.store(true);
+    }
+
+    //Audio thread: true while the signal is active (or within the hold time)
+    bool process(const juce::AudioBuffer<float>& buffer) noexcept
+    {
+        const int numSamples = buffer.getNumSamples();
+
+        float peak = 0.0f;
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax(buffer.getReadPointer(ch), numSamples);
+            peak = juce::jmax(peak, -range.getStart(), range.getEnd());
+        }
+
+        if (peak >= onThreshold)
+        {
+            quietSamples = 0;
+            active.store(true, std::memory_order_relaxed);
+        }
+        else if (peak < offThreshold)
+        {
+            quietSamples += numSamples;
+            if (quietSamples >= holdSamples)
+                active.store(false, std::memory_order_relaxed);
+        }
+        else
+        {
+            quietSamples = 0; //between thresholds: stay in the current state
+        }
+
+        return active.load(std::memory_order_relaxed);
+    }
+
+    //Any thread
+    bool isActive() const noexcept { return active.load(std::memory_order_relaxed); }
+
+private:
+    float onThreshold = 0.001f;
+    float offThreshold = 0.0005f;
+    juce::int64 holdSamples = 1;
+    juce::int64 quietSamples = 0;
+    std::atomic<bool> active{ true };
+};
\ No newline at end of file
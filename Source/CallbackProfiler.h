@@ -0,0 +1,199 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <cmath>
+
+//Per-stage timing of the audio callback. Each stage has a lock-free histogram
+//(written only by the audio thread with relaxed atomics, read by the UI at any
+//time), from which p50/p99/max are derived. The total callback time is also
+//recorded as a percentage of the buffer duration (the callback's budget).
+//
+//While disabled, a ScopedStage costs one bool test: no clock is read.
+class CallbackProfiler
+{
+public:
+    enum Stage
+    {
+        transportRead, activityGate,
+        oscilloscope, waveform, spectrum, pitch, transfer, stereoImage,
+        levelMeters, truePeak, loudness, meterBridge, meterPublish,
+        total,
+        numStages
+    };
+
+    static const char* getStageName(int stage) noexcept
+    {
+        static const char* const names[numStages] = {
+            "transport read", "activity gate",
+            "oscilloscope", "waveform", "spectrum", "pitch", "transfer", "stereo image",
+            "level meters", "true peak", "loudness", "meter bridge", "meter publish",
+            "total"
+        };
+        return juce::isPositiveAndBelow(stage, (int)numStages) ? names[stage] : "";
+    }
+
+    struct Stats
+    {
+        juce::uint32 count = 0;
+        double p50 = 0.0, p99 = 0.0, max = 0.0; //microseconds (stages) or percent (budget)
+    };
+
+    CallbackProfiler()
+    {
+        ticksToMicroseconds = 1.0e6 / (double)juce::Time::getHighResolutionTicksPerSecond();
+    }
+
+    //Any thread
+    void setEnabled(bool shouldBeEnabled) noexcept { enabled.store(shouldBeEnabled); }
+    bool isEnabled() const noexcept { return enabled.load(); }
+    void reset() noexcept { resetRequested.store(true); } //applied at the next callback
+
+    //Audio thread
+    void prepare(double newSampleRate) noexcept { sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0; }
+
+    void beginCallback(int numSamples) noexcept
+    {
+        running = enabled.load(std::memory_order_relaxed);
+        if (!running) return;
+
+        if (resetRequested.exchange(false))
+        {
+            for (auto& h : stages) h.clear();
+            budget.clear();
+        }
+
+        callbackSamples = numSamples;
+        callbackStart = juce::Time::getHighResolutionTicks();
+    }
+
+    void endCallback() noexcept
+    {
+        if (!running) return;
+
+        const double us = (double)(juce::Time::getHighResolutionTicks() - callbackStart) * ticksToMicroseconds;
+        stages[total].record(us);
+
+        const double bufferUs = 1.0e6 * callbackSamples / sampleRate;
+        if (bufferUs > 0.0)
+            budget.record(100.0 * us / bufferUs);
+    }
+
+    //Times its enclosing scope as one stage (audio thread)
+    class ScopedStage
+    {
+    public:
+        ScopedStage(CallbackProfiler& p, Stage s) noexcept
+            : profiler(p), stage(s), start(p.running ? juce::Time::getHighResolutionTicks() : 0) {}
+
+        ~ScopedStage()
+        {
+            if (profiler.running)
+                profiler.stages[stage].record((double)(juce::Time::getHighResolutionTicks() - start) * profiler.ticksToMicroseconds);
+        }
+
+    private:
+        CallbackProfiler& profiler;
+        Stage stage;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedStage)
+    };
+
+    //Any thread (values may be a callback apart from each other)
+    Stats getStageStats(int stage) const noexcept { return juce::isPositiveAndBelow(stage, (int)numStages) ? stages[stage].getStats() : Stats{}; }
+    Stats getBudgetStats() const noexcept { return budget.getStats(); }
+
+    //One row per stage plus the budget row; the unit column says what p50/p99/max are in
+    //(microseconds for the stages, percent of the buffer period for the budget)
+    juce::String toCsv() const
+    {
+        juce::String csv = "stage,unit,count,p50,p99,max\n";
+
+        auto addRow = [&csv](const juce::String& name, const char* unit, const Stats& s)
+            {
+                csv << name << "," << unit << "," << (int)s.count << "," << juce::String(s.p50, 2) << ","
+                    << juce::String(s.p99, 2) << "," << juce::String(s.max, 2) << "\n";
+            };
+
+        for (int s = 0; s < numStages; ++s)
+            addRow(getStageName(s), "us", getStageStats(s));
+
+        addRow("budget", "percent", getBudgetStats());
+        return csv;
+    }
+
+private:
+    //Log-spaced bins from 0.01 to 100000 (24 per decade)
+    struct Histogram
+    {
+        static constexpr int binsPerDecade = 24;
+        static constexpr double minValue = 0.01;
+        static constexpr int numBins = 7 * binsPerDecade;
+
+        std::atomic<juce::uint32> bins[numBins];
+        std::atomic<juce::uint32> count{ 0 };
+        std::atomic<double> maxValue{ 0.0 };
+
+        Histogram() { clear(); }
+
+        void clear() noexcept
+        {
+            for (auto& b : bins) b.store(0, std::memory_order_relaxed);
+            count.store(0, std::memory_order_relaxed);
+            maxValue.store(0.0, std::memory_order_relaxed);
+        }
+
+        //Single writer (the audio thread), so load + store is enough
+        void record(double v) noexcept
+        {
+            const int bin = v <= minValue ? 0
+                : juce::jmin(numBins - 1, (int)(std::log10(v / minValue) * binsPerDecade));
+
+            bins[bin].store(bins[bin].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            if (v > maxValue.load(std::memory_order_relaxed))
+                maxValue.store(v, std::memory_order_relaxed);
+        }
+
+        static double binCentre(int bin) noexcept { return minValue * std::pow(10.0, (bin + 0.5) / binsPerDecade); }
+
+        Stats getStats() const noexcept
+        {
+            Stats s;
+            juce::uint32 counts[numBins];
+            for (int b = 0; b < numBins; ++b)
+            {
+                counts[b] = bins[b].load(std::memory_order_relaxed);
+                s.count += counts[b];
+            }
+            s.max = maxValue.load(std::memory_order_relaxed);
+            if (s.count == 0) return s;
+
+            const auto p50Rank = (juce::uint64)std::ceil(0.50 * s.count);
+            const auto p99Rank = (juce::uint64)std::ceil(0.99 * s.count);
+
+            juce::uint64 seen = 0;
+            bool have50 = false;
+            for (int b = 0; b < numBins; ++b)
+            {
+                seen += counts[b];
+                if (!have50 && seen >= p50Rank) { s.p50 = juce::jmin(binCentre(b), s.max); have50 = true; }
+                if (seen >= p99Rank)            { s.p99 = juce::jmin(binCentre(b), s.max); break; }
+            }
+            return s;
+        }
+    };
+
+    std::atomic<bool> enabled{ false };
+    std::atomic<bool> resetRequested{ false };
+
+    Histogram stages[numStages];
+    Histogram budget;
+
+    //Audio thread
+    bool running = false;
+    double sampleRate = 44100.0;
+    double ticksToMicroseconds = 1.0;
+    int callbackSamples = 0;
+    juce::int64 callbackStart = 0;
+};
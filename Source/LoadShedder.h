@@ -0,0 +1,133 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <cmath>
+
+//Overrun-aware load shedding for the optional work in the audio callback. The
+//callback reports its own duration after every block; when it runs close to (or
+//over) the buffer period, the shedder steps one tier down the analyzer priority
+//list, and once the load has stayed low for a while it steps back up.
+//
+//Tiers, cheapest loss first: spectrum overlap 4x -> 2x -> 1x, then no visualizer
+//feeds at all. Playback and metering (levels, true peak, loudness) are never shed.
+//
+//Timing is counted in samples, so the behaviour does not depend on the block size.
+//Re-shedding soon after a recovery doubles the recovery hold (up to 16x), which
+//keeps a borderline machine from oscillating between two tiers.
+class LoadShedder
+{
+public:
+    enum Level
+    {
+        full,               //everything runs
+        spectrumOverlap2x,  //spectrum hop doubled
+        spectrumOverlap1x,  //spectrum without overlap
+        visualizersOff,     //visualizers and pitch get no samples; meters only
+        numLevels
+    };
+
+    static const char* getLevelName(int level) noexcept
+    {
+        static const char* const names[numLevels] = { "full", "spectrum 2x", "spectrum 1x", "meters only" };
+        return juce::isPositiveAndBelow(level, (int)numLevels) ? names[level] : "";
+    }
+
+    //Audio thread (or before the device starts)
+    void prepare(double newSampleRate, float shedAboveIn = 0.7f, float recoverBelowIn = 0.35f, double recoverSeconds = 2.0)
+    {
+        sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+        shedAbove = shedAboveIn;
+        recoverBelow = juce::jmin(recoverBelowIn, shedAboveIn);
+        baseRecoverSamples = juce::jmax((juce::int64)1, (juce::int64)(recoverSeconds * sampleRate));
+        stepHoldSamples = (juce::int64)(0.15 * sampleRate);
+        smoothingSamples = 0.1 * sampleRate;
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        level.store(full);
+        smoothedLoad = 0.0f;
+        calmSamples = 0;
+        sinceChangeSamples = 0;
+        sinceRecoverySamples = 0;
+        recoverSamples = baseRecoverSamples;
+        recovered = false;
+    }
+
+    //Audio thread: the last callback took elapsedSeconds for numSamples of audio.
+    //Returns +1 if a tier was shed, -1 if one was restored, 0 otherwise.
+    int endCallback(double elapsedSeconds, int numSamples) noexcept
+    {
+        if (numSamples <= 0) return 0;
+
+        const float load = (float)(elapsedSeconds * sampleRate / numSamples); //1.0 = the whole buffer period
+        const float alpha = (float)(1.0 - std::exp(-numSamples / smoothingSamples));
+        smoothedLoad += alpha * (load - smoothedLoad);
+
+        sinceChangeSamples += numSamples;
+        sinceRecoverySamples += numSamples;
+
+        //Long enough at full quality: forget the backoff
+        const int current = level.load(std::memory_order_relaxed);
+        if (current == full && sinceChangeSamples >= 8 * baseRecoverSamples)
+            recoverSamples = baseRecoverSamples;
+
+        const bool overrun = load >= 1.0f;
+        if ((overrun || smoothedLoad >= shedAbove) && sinceChangeSamples >= stepHoldSamples)
+        {
+            calmSamples = 0;
+            if (current == numLevels - 1) return 0;
+
+            //Re-shed soon after a recovery: wait longer before trying again
+            if (recovered && sinceRecoverySamples < 2 * recoverSamples)
+                recoverSamples = juce::jmin(recoverSamples * 2, 16 * baseRecoverSamples);
+
+            recovered = false;
+            return changeLevel(current + 1);
+        }
+
+        if (smoothedLoad >= recoverBelow)
+        {
+            calmSamples = 0;
+            return 0;
+        }
+
+        calmSamples += numSamples;
+        if (current == full || calmSamples < recoverSamples) return 0;
+
+        calmSamples = 0;
+        recovered = true;
+        sinceRecoverySamples = 0;
+        return changeLevel(current - 1);
+    }
+
+    //Any thread
+    int getLevel() const noexcept { return level.load(std::memory_order_relaxed); }
+    int getSpectrumOverlap() const noexcept
+    {
+        const int l = getLevel();
+        return l == full ? 4 : (l == spectrumOverlap2x ? 2 : 1);
+    }
+    bool shouldFeedVisualizers() const noexcept { return getLevel() < visualizersOff; }
+
+private:
+    int changeLevel(int newLevel) noexcept
+    {
+        const int step = newLevel > level.load(std::memory_order_relaxed) ? 1 : -1;
+        level.store(newLevel, std::memory_order_relaxed);
+        sinceChangeSamples = 0;
+        return step;
+    }
+
+    std::atomic<int> level{ full };
+
+    //Audio thread
+    double sampleRate = 44100.0;
+    float shedAbove = 0.7f, recoverBelow = 0.35f;
+    double smoothingSamples = 4410.0;
+    float smoothedLoad = 0.0f;
+    juce::int64 baseRecoverSamples = 88200, recoverSamples = 88200, stepHoldSamples = 6615;
+    juce::int64 calmSamples = 0, sinceChangeSamples = 0, sinceRecoverySamples = 0;
+    bool recovered = false;
+};
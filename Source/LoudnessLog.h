@@ -0,0 +1,365 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "MeterSnapshot.h"
+#include "TraceRecorder.h"
+#include "resonance_loudness_log.h"
+
+//Continuous loudness record for unattended monitoring: one 100 ms record
+//(momentary, short-term, integrated, range, per-channel true peak) appended to a
+//pre-sized, memory-mapped ring file whose oldest records are overwritten, so disk
+//usage never grows. The file layout and the reader side are in resonance_loudness_log.h;
+//Tools/resonance_loudness_export turns any time window into CSV.
+//
+//The audio thread only fills records into a FIFO. A writer thread creates or reopens
+//the file, and about once a second copies the queued records into the mapping and
+//advances the header's head, so the audio thread never touches the file or makes a syscall.
+class LoudnessLog : private juce::Thread
+{
+public:
+    static constexpr double defaultDays = 7.0;
+    static constexpr int fifoRecords = 2048;        //~3.4 minutes of records between writer passes
+    static constexpr int writeIntervalMs = 1000;     //at the latest; sooner once a second of records is queued
+    static constexpr int pollIntervalMs = 100;
+
+    LoudnessLog() : juce::Thread("Loudness log")
+    {
+        static_assert(sizeof(resonance_llog_record) == 24, "record layout is part of the file format");
+        static_assert(sizeof(resonance_llog_header) <= RESONANCE_LLOG_HEADER_SIZE, "header must fit its page");
+        pending.resize((size_t)fifoRecords);
+    }
+
+    ~LoudnessLog() override { stop(); }
+
+    static juce::File getDefaultFile()
+    {
+        return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+            .getChildFile("Resonance").getChildFile("loudness.rlog");
+    }
+
+    static juce::int64 recordsForDays(double days)
+    {
+        return juce::jmax((juce::int64)1, (juce::int64)std::ceil(days * 24.0 * 3600.0 * 1000.0 / RESONANCE_LLOG_INTERVAL_MS));
+    }
+
+    //Message thread. Records are queued right away; the writer thread creates the file
+    //(capacityRecords * 24 bytes plus a 4 KB header) or reopens an existing log of the
+    //same capacity. A log of another capacity is kept as "<name>.previous.rlog".
+    void start(const juce::File& fileToUse, juce::int64 capacityRecords)
+    {
+        stop();
+        file = fileToUse;
+        capacity = (juce::uint64)juce::jmax((juce::int64)1, capacityRecords);
+        setStatus("Opening " + file.getFullPathName());
+
+        sessionStarting.store(true);
+        enabled.store(true);
+        startThread(juce::Thread::Priority::low);
+    }
+
+    //Message thread: writes out everything queued and closes the file
+    void stop()
+    {
+        enabled.store(false);
+        signalThreadShouldExit();
+        notify();
+        stopThread(10000);
+    }
+
+    bool isRunning() const noexcept { return enabled.load(std::memory_order_relaxed); }
+    juce::File getFile() const { return file; }
+
+    juce::String getStatus() const
+    {
+        const juce::ScopedLock sl(statusLock);
+        return status;
+    }
+
+    //Audio device thread, before the callbacks start: the next record opens a new session
+    void prepare(double newSampleRate) noexcept
+    {
+        sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+        sessionSampleRate.store(sampleRate);
+        samplesPerRecord = sampleRate * RESONANCE_LLOG_INTERVAL_MS / 1000.0;
+        samplesInRecord = 0.0;
+        truePeakMax[0] = truePeakMax[1] = 0.0f;
+        sessionStarting.store(true);
+    }
+
+    //Audio thread, once per metered block. truePeakGain holds the block's highest
+    //oversampled magnitude per channel. Never blocks; records that don't fit the FIFO
+    //are counted and the next written record is flagged as following a gap.
+    void addBlock(int numSamples, const MeterSnapshot& snap, const float* truePeakGain) noexcept
+    {
+        if (!enabled.load(std::memory_order_relaxed) || numSamples <= 0)
+            return;
+
+        for (int ch = 0; ch < 2; ++ch)
+            truePeakMax[ch] = juce::jmax(truePeakMax[ch], truePeakGain[ch]);
+
+        samplesInRecord += numSamples;
+        if (samplesInRecord < samplesPerRecord)
+            return;
+
+        //Wall clock through the vDSO; each record is stamped at the end of its interval
+        const juce::int64 nowMs = juce::Time::currentTimeMillis();
+        while (samplesInRecord >= samplesPerRecord)
+        {
+            samplesInRecord -= samplesPerRecord;
+
+            resonance_llog_record r{};
+            r.time_ms = nowMs - (juce::int64)(samplesInRecord * 1000.0 / sampleRate);
+            r.momentary_cb = toCenti(snap.lufsMomentary);
+            r.short_term_cb = toCenti(snap.lufsShortTerm);
+            r.integrated_cb = toCenti(snap.lufsIntegrated);
+            r.range_cb = toCenti(snap.lufsRange);
+            for (int ch = 0; ch < 2; ++ch)
+                r.true_peak_cb[ch] = toCenti(juce::Decibels::gainToDecibels(truePeakMax[ch], -100.0f));
+            r.flags = sessionStarting.exchange(false) ? (juce::uint16)RESONANCE_LLOG_FLAG_SESSION_START : (juce::uint16)0;
+
+            int start1, size1, start2, size2;
+            fifo.prepareToWrite(1, start1, size1, start2, size2);
+            if (size1 > 0)
+            {
+                pending[(size_t)start1] = r;
+                fifo.finishedWrite(1);
+            }
+            else
+            {
+                droppedRecords.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        //The remainder of this block already belongs to the next record
+        for (int ch = 0; ch < 2; ++ch)
+            truePeakMax[ch] = samplesInRecord > 0.0 ? truePeakGain[ch] : 0.0f;
+    }
+
+private:
+    juce::File file;
+    juce::uint64 capacity = 0;
+    std::atomic<bool> enabled{ false };
+
+    juce::CriticalSection statusLock;
+    juce::String status;
+
+    //Audio thread -> writer
+    std::vector<resonance_llog_record> pending;
+    juce::AbstractFifo fifo{ fifoRecords };
+    std::atomic<bool> sessionStarting{ true };
+    std::atomic<juce::uint32> droppedRecords{ 0 };
+    std::atomic<double> sessionSampleRate{ 44100.0 };
+
+    //Audio thread
+    double sampleRate = 44100.0, samplesPerRecord = 4410.0, samplesInRecord = 0.0;
+    float truePeakMax[2] = { 0.0f, 0.0f };
+
+    //Writer thread
+    std::unique_ptr<juce::MemoryMappedFile> mapping;
+
+    static juce::int16 toCenti(float db) noexcept
+    {
+        return (juce::int16)juce::jlimit(-10000, 32767, juce::roundToInt(juce::jmax(db, -100.0f) * 100.0f));
+    }
+
+    void setStatus(const juce::String& s)
+    {
+        const juce::ScopedLock sl(statusLock);
+        status = s;
+    }
+
+    resonance_llog_header* header() const noexcept
+    {
+        return static_cast<resonance_llog_header*>(mapping->getData());
+    }
+
+    juce::int64 fileSize() const noexcept
+    {
+        return (juce::int64)RESONANCE_LLOG_HEADER_SIZE + (juce::int64)(capacity * sizeof(resonance_llog_record));
+    }
+
+    //Existing log with this layout and capacity?
+    bool isReusable() const
+    {
+        if (file.getSize() != fileSize())
+            return false;
+
+        resonance_llog_header h{};
+        juce::FileInputStream in(file);
+        return in.openedOk()
+            && in.read(&h, (int)sizeof(h)) == (int)sizeof(h)
+            && std::memcmp(h.magic, RESONANCE_LLOG_MAGIC, sizeof(h.magic)) == 0
+            && h.version == RESONANCE_LLOG_VERSION
+            && h.header_size == RESONANCE_LLOG_HEADER_SIZE
+            && h.record_size == sizeof(resonance_llog_record)
+            && h.capacity == capacity;
+    }
+
+    //Writes the header and zero-fills every record up front, so the disk space is
+    //allocated now rather than failing months later
+    bool createFile()
+    {
+        if (file.exists())
+        {
+            const auto previous = file.getSiblingFile(file.getFileNameWithoutExtension() + ".previous" + file.getFileExtension());
+            previous.deleteFile();
+            if (!file.moveFileTo(previous))
+                return false;
+        }
+
+        if (!file.getParentDirectory().createDirectory())
+            return false;
+
+        {
+            juce::FileOutputStream out(file);
+            if (!out.openedOk())
+                return false;
+
+            std::vector<char> page((size_t)RESONANCE_LLOG_HEADER_SIZE, 0);
+            auto* h = reinterpret_cast<resonance_llog_header*>(page.data());
+            std::memcpy(h->magic, RESONANCE_LLOG_MAGIC, sizeof(h->magic));
+            h->version = RESONANCE_LLOG_VERSION;
+            h->header_size = RESONANCE_LLOG_HEADER_SIZE;
+            h->record_size = (juce::uint32)sizeof(resonance_llog_record);
+            h->interval_ms = RESONANCE_LLOG_INTERVAL_MS;
+            h->capacity = capacity;
+            h->created_ms = juce::Time::currentTimeMillis();
+            out.write(page.data(), page.size());
+
+            const std::vector<char> zeros((size_t)1 << 20, 0);
+            for (juce::int64 left = fileSize() - (juce::int64)page.size(); left > 0 && !threadShouldExit();)
+            {
+                const auto n = (size_t)juce::jmin(left, (juce::int64)zeros.size());
+                if (!out.write(zeros.data(), n))
+                    break;
+                left -= (juce::int64)n;
+            }
+
+            out.flush();
+            if (out.getStatus().failed() || out.getPosition() != fileSize())
+            {
+                file.deleteFile();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool openFile()
+    {
+        const bool reuse = isReusable();
+        if (!reuse && !createFile())
+            return false;
+
+        mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readWrite);
+        if (mapping->getData() == nullptr || (juce::int64)mapping->getSize() != fileSize())
+        {
+            mapping.reset();
+            return false;
+        }
+
+        setStatus((reuse ? "Appending to " : "Created ") + file.getFullPathName());
+        return true;
+    }
+
+    //Copies the queued records into the ring, then publishes them by advancing head.
+    //first is raised before any slot is overwritten, so readers can tell which of the
+    //records they copied may have been replaced.
+    void writePending()
+    {
+        const int ready = fifo.getNumReady();
+        const auto dropped = droppedRecords.exchange(0);
+        if (ready == 0 && dropped == 0)
+            return;
+
+        auto* h = header();
+        auto* records = reinterpret_cast<resonance_llog_record*>(reinterpret_cast<char*>(h) + RESONANCE_LLOG_HEADER_SIZE);
+        juce::uint64 head = h->head;
+        juce::int64 lastMs = head > 0 ? h->updated_ms : std::numeric_limits<juce::int64>::min();
+        juce::uint16 nextFlags = dropped > 0 ? (juce::uint16)RESONANCE_LLOG_FLAG_GAP : (juce::uint16)0;
+
+        auto append = [&](int start, int size)
+            {
+                for (int i = start; i < start + size; ++i)
+                {
+                    auto r = pending[(size_t)i];
+                    r.flags |= nextFlags;
+                    nextFlags = 0;
+
+                    //Binary search needs non-decreasing times: hold them if the clock steps back
+                    //(a step over a second is flagged; smaller ones are block-size stamping jitter)
+                    if (r.time_ms < lastMs)
+                    {
+                        if (lastMs - r.time_ms > 1000)
+                            r.flags |= RESONANCE_LLOG_FLAG_CLOCK_ADJUSTED;
+                        r.time_ms = lastMs;
+                    }
+                    lastMs = r.time_ms;
+
+                    records[head % capacity] = r;
+                    ++head;
+                }
+            };
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(ready, start1, size1, start2, size2);
+
+        const juce::uint64 end = head + (juce::uint64)(size1 + size2);
+        if (end > capacity && end - capacity > h->first)
+        {
+            reinterpret_cast<volatile juce::uint64&>(h->first) = end - capacity;
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        append(start1, size1);
+        append(start2, size2);
+        fifo.finishedRead(size1 + size2);
+
+        h->dropped += dropped;
+        h->sample_rate = sessionSampleRate.load();
+        if (size1 + size2 > 0)
+            h->updated_ms = lastMs;
+
+        std::atomic_thread_fence(std::memory_order_release);
+        reinterpret_cast<volatile juce::uint64&>(h->head) = head;
+    }
+
+    void run() override
+    {
+        TraceRecorder::getInstance().nameCurrentThread("loudness log");
+
+        if (!openFile())
+        {
+            enabled.store(false);
+            setStatus("Could not open " + file.getFullPathName());
+            juce::Logger::writeToLog("Loudness log: " + getStatus());
+            return;
+        }
+
+        //Polled rather than signalled: waking this thread would cost the audio thread a syscall.
+        //Faster-than-real-time runs fill the FIFO quickly, so a full second of records is
+        //written without waiting for the interval.
+        auto lastWriteMs = juce::Time::getMillisecondCounter();
+        while (!threadShouldExit())
+        {
+            wait(pollIntervalMs);
+
+            const auto nowMs = juce::Time::getMillisecondCounter();
+            if (fifo.getNumReady() >= 1000 / RESONANCE_LLOG_INTERVAL_MS || nowMs - lastWriteMs >= (juce::uint32)writeIntervalMs)
+            {
+                writePending();
+                lastWriteMs = nowMs;
+            }
+        }
+
+        //Whatever the audio thread queued before stop() cleared enabled
+        writePending();
+        mapping.reset();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoudnessLog)
+};
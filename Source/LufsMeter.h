@@ -4,25 +4,62 @@
 class LufsMeter
 {
 public:
-    void prepare(double sr)
+    //One K-weighting stage. Runs in double: the 38 Hz high-pass has its poles very close
+    //to z = 1 at high sample rates, where float coefficients and state lose the response.
+    struct Biquad
     {
-        sampleRate = sr;
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+        double z1 = 0.0, z2 = 0.0;
+
+        void setHighShelf(double sr, double f0, double q, double gainDb)
+        {
+            const double k = std::tan(juce::MathConstants<double>::pi * f0 / sr);
+            const double vh = std::pow(10.0, gainDb / 20.0);
+            const double vb = std::pow(vh, 0.4996667741545416);
+            const double a0 = 1.0 + k / q + k * k;
+            set((vh + vb * k / q + k * k) / a0, 2.0 * (k * k - vh) / a0, (vh - vb * k / q + k * k) / a0,
+                2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0);
+        }
+
+        void setHighPass(double sr, double f0, double q)
+        {
+            const double k = std::tan(juce::MathConstants<double>::pi * f0 / sr);
+            const double a0 = 1.0 + k / q + k * k;
+            set(1.0, -2.0, 1.0, 2.0 * (k * k - 1.0) / a0, (1.0 - k / q + k * k) / a0);
+        }
 
-        //Set coefficients the portable way (use .coefficients, not .state)
-        auto hpL = juce::dsp::IIR::Coefficients<float>::makeHighPass(sr, 60.0, 0.5f);
-        auto hpR = juce::dsp::IIR::Coefficients<float>::makeHighPass(sr, 60.0, 0.5f);
-        auto shL = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sr, 4000.0, 0.707f,
-            juce::Decibels::decibelsToGain(4.0f));
-        auto shR = juce::dsp::IIR::Coefficients<float>::makeHighShelf(sr, 4000.0, 0.707f,
-            juce::Decibels::decibelsToGain(4.0f));
+        void set(double nb0, double nb1, double nb2, double na1, double na2)
+        {
+            b0 = nb0; b1 = nb1; b2 = nb2; a1 = na1; a2 = na2;
+            reset();
+        }
 
-        hpfL.coefficients = hpL;
-        hpfR.coefficients = hpR;
-        shelfL.coefficients = shL;
-        shelfR.coefficients = shR;
+        void reset() { z1 = z2 = 0.0; }
+
+        double process(double x) noexcept //transposed direct form II
+        {
+            const double y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            return y;
+        }
+    };
 
-        hpfL.reset(); hpfR.reset();
-        shelfL.reset(); shelfR.reset();
+    //BS.1770 K-weighting at any rate: the standard gives the two stages as 48 kHz
+    //coefficients; these are the analogue prototypes behind them, re-discretised for sr
+    //(identical to the reference at 48 kHz)
+    static void makeKWeighting(double sr, Biquad& shelf, Biquad& highPass)
+    {
+        shelf.setHighShelf(sr, 1681.974450955533, 0.7071752369554196, 3.999843853973347);
+        highPass.setHighPass(sr, 38.13547087602444, 0.5003270373238773);
+    }
+
+    void prepare(double sr)
+    {
+        sampleRate = sr;
+
+        for (int ch = 0; ch < 2; ++ch)
+            makeKWeighting(sr, shelf[ch], hpf[ch]);
 
         mWinSamples = juce::jmax(1, (int)std::round(0.400 * sr)); // 400 ms
         sWinSamples = juce::jmax(1, (int)std::round(3.000 * sr)); // 3 s
@@ -32,7 +69,12 @@ public:
         mIdx = sIdx = 0;
         mSum = sSum = 0.0;
 
-        work.setSize(2, 0);
+        //Gating blocks: 400 ms windows every 100 ms (75% overlap)
+        blockStepSamples = juce::jmax(1, (int)std::round(0.100 * sr));
+        gateHistPower.assign(numGateBins, 0.0);
+        gateHistCount.assign(numGateBins, 0);
+        lraHistCount.assign(numGateBins, 0);
+        resetIntegrated();
     }
 
     void clear()
@@ -41,40 +83,33 @@ public:
         std::fill(sRing.begin(), sRing.end(), 0.0f);
         mIdx = sIdx = 0;
         mSum = sSum = 0.0;
-        hpfL.reset(); hpfR.reset(); shelfL.reset(); shelfR.reset();
+        for (auto& f : shelf) f.reset();
+        for (auto& f : hpf)   f.reset();
+
+        std::fill(gateHistPower.begin(), gateHistPower.end(), 0.0);
+        std::fill(gateHistCount.begin(), gateHistCount.end(), 0);
+        std::fill(lraHistCount.begin(), lraHistCount.end(), 0);
+        resetIntegrated();
     }
 
-    //Feed one block (mic or playback). Mono input is duplicated to stereo.
+    //Feed one block (mic or playback) of any size. Mono input is duplicated to stereo.
+    //All state advances per sample, so the result does not depend on the block size.
     void processBlock(const juce::AudioBuffer<float>& in)
     {
         const int n = in.getNumSamples();
-        if (n <= 0) return;
+        if (n <= 0 || in.getNumChannels() <= 0) return;
 
-        work.setSize(2, n, false, false, true);
-        work.clear();
-
-        if (in.getNumChannels() >= 2)
-        {
-            work.copyFrom(0, 0, in, 0, 0, n);
-            work.copyFrom(1, 0, in, 1, 0, n);
-        }
-        else
-        {
-            work.copyFrom(0, 0, in, 0, 0, n);
-            work.copyFrom(1, 0, in, 0, 0, n);
-        }
+        const float* left = in.getReadPointer(0);
+        const float* right = in.getReadPointer(in.getNumChannels() >= 2 ? 1 : 0);
 
         for (int i = 0; i < n; ++i)
         {
-            float L = work.getSample(0, i);
-            float R = work.getSample(1, i);
+            //K-weighting: high shelf (+4 dB) then high-pass
+            const double L = hpf[0].process(shelf[0].process(left[i]));
+            const double R = hpf[1].process(shelf[1].process(right[i]));
 
-            //K-weighting: HPF then High-shelf (+4 dB @ 4 kHz)
-            L = shelfL.processSample(hpfL.processSample(L));
-            R = shelfR.processSample(hpfR.processSample(R));
-
-            //BS.1770 mean channel power
-            const float p = 0.5f * (L * L + R * R);
+            //BS.1770 channel power sum (L and R weighted 1.0)
+            const float p = (float)(L * L + R * R);
 
             //Momentary (400 ms)
             mSum -= mRing[mIdx];
@@ -87,18 +122,42 @@ public:
             sRing[sIdx] = p;
             sSum += p;
             sIdx = (sIdx + 1) % sWinSamples;
+
+            //Every 100 ms, the current (full) momentary window is one gating block and the
+            //current (full) short-term window one loudness range block
+            if (mFilled < mWinSamples) ++mFilled;
+            if (sFilled < sWinSamples) ++sFilled;
+            if (++samplesSinceBlock >= blockStepSamples)
+            {
+                samplesSinceBlock = 0;
+                if (mFilled == mWinSamples)
+                    addGatingBlock(avgPower(mSum, mWinSamples));
+                if (sFilled == sWinSamples)
+                    addRangeBlock(avgPower(sSum, sWinSamples));
+            }
         }
+
+        if (integratedDirty)
+            updateIntegrated();
+        if (rangeDirty)
+            updateRange();
     }
 
     float getMomentaryLUFS() const { return powerToLufs(avgPower(mSum, mWinSamples)); }
     float getShortTermLUFS() const { return powerToLufs(avgPower(sSum, sWinSamples)); }
 
+    //Gated integrated loudness since prepare()/clear() (BS.1770: -70 LUFS absolute, -10 LU relative gate)
+    float getIntegratedLUFS() const { return integratedLufs; }
+
+    //Loudness range in LU since prepare()/clear() (EBU Tech 3342: short-term values,
+    //-70 LUFS absolute and -20 LU relative gate, 10th to 95th percentile)
+    float getLoudnessRange() const { return loudnessRange; }
+
 private:
     double sampleRate = 48000.0;
 
     //Per-channel filters for K-weighting
-    juce::dsp::IIR::Filter<float> hpfL, hpfR;
-    juce::dsp::IIR::Filter<float> shelfL, shelfR;
+    Biquad shelf[2], hpf[2];
 
     //Running windows
     int mWinSamples = 1, sWinSamples = 1;
@@ -106,8 +165,110 @@ private:
     int mIdx = 0, sIdx = 0;
     double mSum = 0.0, sSum = 0.0;
 
-    //Workspace
-    juce::AudioBuffer<float> work;
+    //Integrated loudness: gating blocks are binned at 0.1 LU (power sum + count per bin),
+    //so memory stays fixed no matter how long the programme runs
+    static constexpr float gateMinLufs = -70.0f;   // absolute gate
+    static constexpr float gateBinLu = 0.1f;
+    static constexpr int numGateBins = 800;        // -70 .. +10 LUFS
+    std::vector<double> gateHistPower;
+    std::vector<juce::uint32> gateHistCount;
+    int blockStepSamples = 1;
+    int samplesSinceBlock = 0;
+    int mFilled = 0;
+    bool integratedDirty = false;
+    float integratedLufs = -100.0f;
+
+    //Loudness range: short-term blocks counted in the same 0.1 LU bins
+    std::vector<juce::uint32> lraHistCount;
+    int sFilled = 0;
+    bool rangeDirty = false;
+    float loudnessRange = 0.0f;
+
+    void resetIntegrated()
+    {
+        samplesSinceBlock = 0;
+        mFilled = sFilled = 0;
+        integratedDirty = rangeDirty = false;
+        integratedLufs = -100.0f;
+        loudnessRange = 0.0f;
+    }
+
+    void addGatingBlock(double power)
+    {
+        const float lufs = powerToLufs(power);
+        if (lufs < gateMinLufs) return;
+
+        const int bin = binOf(lufs);
+        gateHistPower[(size_t)bin] += power;
+        ++gateHistCount[(size_t)bin];
+        integratedDirty = true;
+    }
+
+    void updateIntegrated()
+    {
+        integratedDirty = false;
+
+        //Absolute-gated mean, then the relative gate 10 LU below it
+        double sum = 0.0, count = 0.0;
+        for (int b = 0; b < numGateBins; ++b) { sum += gateHistPower[(size_t)b]; count += gateHistCount[(size_t)b]; }
+        if (count <= 0.0) { integratedLufs = -100.0f; return; }
+
+        const float relativeGate = powerToLufs(sum / count) - 10.0f;
+        const int firstBin = juce::jlimit(0, numGateBins, (int)std::ceil((relativeGate - gateMinLufs) / gateBinLu));
+
+        sum = count = 0.0;
+        for (int b = firstBin; b < numGateBins; ++b) { sum += gateHistPower[(size_t)b]; count += gateHistCount[(size_t)b]; }
+        integratedLufs = count > 0.0 ? powerToLufs(sum / count) : -100.0f;
+    }
+
+    void addRangeBlock(double power)
+    {
+        const float lufs = powerToLufs(power);
+        if (lufs < gateMinLufs) return;
+
+        ++lraHistCount[(size_t)binOf(lufs)];
+        rangeDirty = true;
+    }
+
+    void updateRange()
+    {
+        rangeDirty = false;
+
+        //Relative gate 20 LU below the power mean of the absolute-gated blocks (bin centres)
+        double sum = 0.0, count = 0.0;
+        for (int b = 0; b < numGateBins; ++b)
+        {
+            sum += lraHistCount[(size_t)b] * lufsToPower(binCentre(b));
+            count += lraHistCount[(size_t)b];
+        }
+        if (count <= 0.0) { loudnessRange = 0.0f; return; }
+
+        const float relativeGate = powerToLufs(sum / count) - 20.0f;
+        const int firstBin = juce::jlimit(0, numGateBins, (int)std::ceil((relativeGate - gateMinLufs) / gateBinLu));
+
+        double gated = 0.0;
+        for (int b = firstBin; b < numGateBins; ++b) gated += lraHistCount[(size_t)b];
+        if (gated <= 0.0) { loudnessRange = 0.0f; return; }
+
+        //Bin holding the given fraction of the gated blocks
+        const auto percentileBin = [&](double fraction)
+        {
+            const double target = fraction * (gated - 1.0);
+            double seen = 0.0;
+            for (int b = firstBin; b < numGateBins; ++b)
+            {
+                seen += lraHistCount[(size_t)b];
+                if (seen > target) return b;
+            }
+            return numGateBins - 1;
+        };
+
+        loudnessRange = binCentre(percentileBin(0.95)) - binCentre(percentileBin(0.10));
+    }
+
+    static int binOf(float lufs) { return juce::jlimit(0, numGateBins - 1, (int)((lufs - gateMinLufs) / gateBinLu)); }
+    static float binCentre(int bin) { return gateMinLufs + (bin + 0.5f) * gateBinLu; }
+    static double lufsToPower(float lufs) { return std::pow(10.0, (lufs + 0.691) / 10.0); }
 
     static float powerToLufs(double meanPower)
     {
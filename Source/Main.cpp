@@ -8,6 +8,8 @@
 
 #include <JuceHeader.h>
 #include "MainComponent.h"
+#include "SimulatedAudioDevice.h"
+#include <cstdio>
 
 //==============================================================================
 class AudioVisionApplication  : public juce::JUCEApplication
@@ -25,6 +27,14 @@ public:
     {
         // This method is where you should put your application's initialisation code..
 
+        // --simulate: headless end-to-end run on the simulated audio device
+        const auto args = juce::StringArray::fromTokens (commandLine, true);
+        if (args.contains ("--simulate"))
+        {
+            startSimulation (args);
+            return;
+        }
+
         mainWindow.reset (new MainWindow (getApplicationName()));
     }
 
@@ -33,6 +43,7 @@ public:
         // Add your application's shutdown code here..
 
         mainWindow = nullptr; // (deletes our window)
+        headless = nullptr;
     }
 
     //==============================================================================
@@ -97,7 +108,82 @@ public:
     };
 
 private:
+    //==============================================================================
+    /*
+        Runs MainComponent without a window, in input mode with every analyzer fed,
+        on a SimulatedAudioDevice. When the requested amount of audio has been
+        processed, prints a summary, writes the optional per-callback timings and
+        profiler CSVs, and quits (exit code 1 with --fail-on-xrun if any xrun occurred).
+    */
+    void startSimulation (const juce::StringArray& args)
+    {
+        auto options = SimulatedAudioDevice::Options::fromArguments (args);
+        options.startPaused = true; // until the component is configured
+        if (options.durationSeconds <= 0.0)
+            options.durationSeconds = 10.0;
+
+        options.onFinished = [this]
+        {
+            juce::MessageManager::callAsync ([this] { finishSimulation(); });
+        };
+
+        simulationArgs = args;
+        headless = std::make_unique<MainComponent> (std::make_unique<SimulatedAudioDeviceType> (options));
+        headless->setUseMicInput (true);
+        headless->setFeedAllAnalyzers (true);
+        headless->getProfiler().setEnabled (args.contains ("--profile"));
+
+        // --loudness-log <file> [--loudness-log-days <n>]: keep the 100 ms loudness record like a monitoring install would
+        if (const int i = args.indexOf ("--loudness-log"); i >= 0 && i + 1 < args.size())
+        {
+            const int d = args.indexOf ("--loudness-log-days");
+            const double days = d >= 0 && d + 1 < args.size() ? args[d + 1].getDoubleValue() : LoudnessLog::defaultDays;
+            headless->getLoudnessLog().start (juce::File::getCurrentWorkingDirectory().getChildFile (args[i + 1].unquoted()),
+                                              LoudnessLog::recordsForDays (days));
+        }
+
+        auto* device = dynamic_cast<SimulatedAudioDevice*> (headless->getAudioDeviceManager().getCurrentAudioDevice());
+        if (device == nullptr)
+        {
+            std::fputs ("Could not open the simulated audio device\n", stderr);
+            setApplicationReturnValue (1);
+            quit();
+            return;
+        }
+
+        device->setPaused (false);
+    }
+
+    void finishSimulation()
+    {
+        auto* device = dynamic_cast<SimulatedAudioDevice*> (headless->getAudioDeviceManager().getCurrentAudioDevice());
+        if (device == nullptr)
+            return;
+
+        const auto cwd = juce::File::getCurrentWorkingDirectory();
+        const auto valueAfter = [this] (const char* flag)
+        {
+            const int i = simulationArgs.indexOf (flag);
+            return i >= 0 && i + 1 < simulationArgs.size() ? simulationArgs[i + 1].unquoted() : juce::String();
+        };
+
+        std::fputs (device->getSummary().toRawUTF8(), stdout);
+
+        if (const auto timingsPath = valueAfter ("--timings"); timingsPath.isNotEmpty())
+            device->writeTimingsCsv (cwd.getChildFile (timingsPath));
+
+        if (const auto profilePath = valueAfter ("--profile"); profilePath.isNotEmpty())
+            cwd.getChildFile (profilePath).replaceWithText (headless->getProfiler().toCsv());
+
+        if (simulationArgs.contains ("--fail-on-xrun") && device->getXRunCount() > 0)
+            setApplicationReturnValue (1);
+
+        quit();
+    }
+
     std::unique_ptr<MainWindow> mainWindow;
+    std::unique_ptr<MainComponent> headless;
+    juce::StringArray simulationArgs;
 };
 
 //==============================================================================
@@ -1,17 +1,24 @@
 #include "MainComponent.h"
+#include "BinaryData.h"
 
 juce::String formatTime(double seconds);
 
+//Taken during static initialisation, i.e. close to process start, for the startup log
+static const double launchTimeMs = juce::Time::getMillisecondCounterHiRes();
+
 // helpers 
 void MainComponent::clearVisuals()
 {
     if (isClearing) return;                  // guard against re-entry
     isClearing = true;
 
-    oscilloscopeDisplay.clear();
     waveformDisplay.clear();
-    stereoImageDisplay.clear();
     spectrumDisplay.clear();
+    if (oscilloscopeDisplay != nullptr) oscilloscopeDisplay->clear();
+    if (stereoImageDisplay != nullptr)  stereoImageDisplay->clear();
+    if (transferDisplay != nullptr)     transferDisplay->clear();
+    if (bridgeDisplay != nullptr)       bridgeDisplay->clear();
+    pitchTracker.clear();
 
     isClearing = false;
 }
@@ -22,17 +29,12 @@ void MainComponent::resetMetersAndAnalyzers()
     isResetting = true;
 
     //Reset UI meters
-    leftMeterDisplay.setLevel(-60.0f);
-    rightMeterDisplay.setLevel(-60.0f);
-    lufsLeftMeterDisplay.setLevel(-60.0f);
-    lufsRightMeterDisplay.setLevel(-60.0f);
-    tpLeftMeterDisplay.setLevel(-60.0f);
-    tpRightMeterDisplay.setLevel(-60.0f);
-
-    //Reset analyzer state 
-    lufsMeter.clear();
-    tpLeftSmooth = -60.0f;
-    tpRightSmooth = -60.0f;
+    for (auto* meter : { &leftMeterDisplay, &rightMeterDisplay, &lufsLeftMeterDisplay,
+                         &lufsRightMeterDisplay, &tpLeftMeterDisplay, &tpRightMeterDisplay })
+        meter->setReading({});
+
+    //Reset analyzer state (done by the audio thread at its next callback)
+    meterResetRequested.store(true);
 
     //Reset transport UI 
     positionSlider.setValue(0.0, juce::dontSendNotification);
@@ -43,7 +45,7 @@ void MainComponent::resetMetersAndAnalyzers()
 
 //==============================================================================
 
-MainComponent::MainComponent()
+MainComponent::MainComponent(std::unique_ptr<juce::AudioIODeviceType> audioDeviceType)
     : state(Stopped),
     openButton("openButton", juce::DrawableButton::ImageFitted),
     playButton("playButton", juce::DrawableButton::ImageFitted),
@@ -51,8 +53,11 @@ MainComponent::MainComponent()
     settingsButton("SettingsButton", juce::DrawableButton::ImageFitted),
     micButton("micButton", juce::DrawableButton::ImageFitted)
 {
-    deviceManager.initialiseWithDefaultDevices(1, 2); // 1 input, 2 output
-    deviceManager.addAudioCallback(this);
+    //Shared-memory meter export, mapped before the first callback can publish
+    if (meterExport.open())
+        meterExport.setEnabled(true);
+    else
+        juce::Logger::writeToLog("Meter export: " + meterExport.getLastError());
 
     //--- Meter widgets --------------------------------------------------------
     addAndMakeVisible(leftMeterDisplay);
@@ -114,34 +119,10 @@ MainComponent::MainComponent()
     micButton.setImages(micSvg.get());
     micButton.setButtonText(""); micButton.setTooltip("Mic");
     micButton.setClickingTogglesState(false);
-    micButton.onClick = [this]
-        {
-            //Switching source context => clear visuals + reset analyzers/meters/UI
-            useMicInput = !useMicInput;
-
-            if (useMicInput && transportSource.isPlaying())
-                stopButtonClicked();
-
-            clearVisuals();
-            resetMetersAndAnalyzers();
-
-            //Show/hide playback UI portions when in mic mode
-            const bool showPlayback = !useMicInput && !showingSettings;
-            openButton.setVisible(showPlayback);
-            playButton.setVisible(showPlayback);
-            stopButton.setVisible(showPlayback);
-            positionSlider.setVisible(showPlayback);
-            timeLabel.setVisible(showPlayback);
-
-            resized();
-            repaint();
-        };
+    micButton.onClick = [this] { setUseMicInput(!useMicInput); };
     addAndMakeVisible(micButton);
 
-    //--- Settings panel (hidden initially) -----------------------------------
-    settingsComponent = std::make_unique<Settings>(deviceManager);
-    addAndMakeVisible(settingsComponent.get());
-    settingsComponent->setVisible(false);
+    //--- Settings panel: built on first use (see createSettings) -------------
 
     //--- Seekbar + time -------------------------------------------------------
     positionSlider.setRange(0.0, 1.0);
@@ -204,27 +185,44 @@ MainComponent::MainComponent()
     meterValueLabel.setFont(juce::Font(13.0f, juce::Font::bold));
     addAndMakeVisible(meterValueLabel);
 
+    pitchLabel.setText("--", juce::dontSendNotification);
+    pitchLabel.setJustificationType(juce::Justification::centred);
+    pitchLabel.setColour(juce::Label::textColourId, juce::Colours::white);
+    pitchLabel.setFont(juce::Font(13.0f, juce::Font::bold));
+    pitchLabel.setTooltip("Pitch");
+    addAndMakeVisible(pitchLabel);
+
     //--- Visualizer toggles ---------------------------------------------------
     styleButton(oscilloscopeButton);
     styleButton(spectrumButton);
     styleButton(stereoImageButton);
+    styleButton(transferButton);
+    styleButton(bridgeButton);
 
     oscilloscopeButton.setButtonText("Oscilloscope");
     spectrumButton.setButtonText("Spectrum");
     stereoImageButton.setButtonText("Stereoimage");
+    transferButton.setButtonText("Transfer");
+    bridgeButton.setButtonText("Bridge");
+    bridgeButton.setTooltip("Meters for every input channel");
 
     oscilloscopeButton.onClick = [this] { setVisualizerMode(VisualizerMode::Oscilloscope); };
     spectrumButton.onClick = [this] { setVisualizerMode(VisualizerMode::Spectrum);     };
     stereoImageButton.onClick = [this] { setVisualizerMode(VisualizerMode::StereoImage);  };
+    transferButton.onClick = [this] { setVisualizerMode(VisualizerMode::Transfer);     };
+    bridgeButton.onClick = [this] { setVisualizerMode(VisualizerMode::Bridge);       };
 
     addAndMakeVisible(oscilloscopeButton);
     addAndMakeVisible(spectrumButton);
     addAndMakeVisible(stereoImageButton);
+    addAndMakeVisible(transferButton);
+    addAndMakeVisible(bridgeButton);
 
-    //--- Visualizer components ------------------------------------------------
-    addAndMakeVisible(oscilloscopeDisplay);
+    //--- Visualizer components (the others are created when first selected) ---
     addAndMakeVisible(spectrumDisplay);
-    addAndMakeVisible(stereoImageDisplay);
+
+    //Callback profiler overlay, above the visualizers (off until enabled in Settings)
+    addChildComponent(profilerOverlay);
 
     spectrumDisplay.setDbRange(-90.0f, 0.0f);
     spectrumDisplay.setFreqRange(20.0f, 20000.0f);
@@ -241,13 +239,223 @@ MainComponent::MainComponent()
 
     addAndMakeVisible(waveformDisplay);
 
+    //--- Audio device placeholder ----------------------------------------------
+    deviceStatusLabel.setText("Opening audio device...", juce::dontSendNotification);
+    deviceStatusLabel.setJustificationType(juce::Justification::centred);
+    deviceStatusLabel.setColour(juce::Label::textColourId, juce::Colours::white);
+    deviceStatusLabel.setColour(juce::Label::backgroundColourId, juce::Colours::black.withAlpha(0.6f));
+    addAndMakeVisible(deviceStatusLabel);
+
+    //Everything that needs an open device waits for audioDeviceOpened()
+    for (auto* button : { &openButton, &playButton, &micButton, &settingsButton })
+        button->setEnabled(false);
+
     formatManager.registerBasicFormats();
     setSize(620, 350);
+    TraceRecorder::getInstance().nameCurrentThread("message");
+
+    //A custom device type registered before initialising replaces the system ones. It is
+    //opened right here (headless runs need the device as soon as this returns); the
+    //system devices are opened in the background.
+    if (audioDeviceType != nullptr)
+    {
+        deviceManager.addAudioDeviceType(std::move(audioDeviceType));
+        openAudioDevice();
+        audioDeviceOpened();
+    }
+    else
+    {
+        //Creates the device types here, so only the scan and open run in the background
+        deviceManager.getAvailableDeviceTypes();
+
+        deviceOpener = std::make_unique<DeviceOpener>(*this);
+        deviceOpener->startThread();
+    }
+
+    constructedMs = juce::Time::getMillisecondCounterHiRes();
+    startTimerHz(30);
+}
+
+void MainComponent::openAudioDevice()
+{
+    const auto error = deviceManager.initialiseWithDefaultDevices(2, 2); // 2 inputs (reference + measurement), 2 output
+    deviceManager.addAudioCallback(this);
+
+    deviceOpenError = error;
+    deviceOpened.store(true);
+}
+
+void MainComponent::audioDeviceOpened()
+{
+    deviceOpenHandled = true;
+    if (deviceOpener != nullptr)
+        deviceOpener->stopThread(1000); // already finished; joins it
+
+    juce::Logger::writeToLog("Startup: audio device ready after "
+                             + juce::String(juce::Time::getMillisecondCounterHiRes() - launchTimeMs, 1) + " ms"
+                             + (deviceOpenError.isNotEmpty() ? " (" + deviceOpenError + ")" : juce::String()));
+
+    for (auto* button : { &openButton, &micButton, &settingsButton })
+        button->setEnabled(true);
+    playButton.setEnabled(state != Starting);
+
+    //Without a device the user picks one in Settings
+    if (deviceOpenError.isEmpty() && deviceManager.getCurrentAudioDevice() != nullptr)
+        deviceStatusLabel.setVisible(false);
+    else
+        deviceStatusLabel.setText("No audio device. Choose one in Settings.", juce::dontSendNotification);
+}
+
+void MainComponent::createSettings()
+{
+    if (settingsComponent != nullptr)
+        return;
+
+    settingsComponent = std::make_unique<Settings>(deviceManager);
+    addChildComponent(settingsComponent.get());
+    settingsComponent->onTransferChannelsChanged = [this](int referenceChannel, int measurementChannel)
+        {
+            transferReferenceChannel = referenceChannel;
+            transferMeasurementChannel = measurementChannel;
+            if (transferDisplay != nullptr)
+                transferDisplay->setInputChannels(referenceChannel, measurementChannel);
+        };
+    settingsComponent->onFastTracesChanged = [this](bool fastScope, bool fastSpectrum, bool fastStereo)
+        {
+            const auto modeFor = [](bool fast) { return fast ? TraceRenderer::Mode::speed : TraceRenderer::Mode::quality; };
+            fastScopeTraces = fastScope;
+            fastStereoTraces = fastStereo;
+            spectrumDisplay.setTraceMode(modeFor(fastSpectrum));
+            if (oscilloscopeDisplay != nullptr) oscilloscopeDisplay->setTraceMode(modeFor(fastScope));
+            if (stereoImageDisplay != nullptr)  stereoImageDisplay->setTraceMode(modeFor(fastStereo));
+        };
+    settingsComponent->onProfilerChanged = [this](bool enabled)
+        {
+            profiler.setEnabled(enabled);
+            profiler.reset();
+            profilerOverlay.setVisible(enabled && !showingSettings);
+        };
+    settingsComponent->onProfilerExport = [this] { exportProfile(); };
+    settingsComponent->onTraceRecorderChanged = [this](bool record, bool dumpOnXrun)
+        {
+            TraceRecorder::getInstance().setEnabled(record);
+            dumpTraceOnXrun = dumpOnXrun;
+        };
+    settingsComponent->onTraceSave = [this] { saveTrace(); };
+    settingsComponent->onMeterExportChanged = [this](bool enabled)
+        {
+            //The object may have been held by another instance at startup; try again
+            if (enabled && !meterExport.isOpen() && !meterExport.open())
+                juce::Logger::writeToLog("Meter export: " + meterExport.getLastError());
+
+            meterExport.setEnabled(enabled);
+            settingsComponent->setMeterExportState(meterExport.isEnabled(), meterExport.getLastError());
+        };
+    settingsComponent->setMeterExportState(meterExport.isEnabled(), meterExport.getLastError());
+    settingsComponent->onLoudnessLogChanged = [this](bool enabled)
+        {
+            if (enabled)
+                loudnessLog.start(LoudnessLog::getDefaultFile(), LoudnessLog::recordsForDays(LoudnessLog::defaultDays));
+            else
+                loudnessLog.stop();
+        };
+    settingsComponent->onWaveformHistoryChanged = [this](double seconds) { waveformDisplay.setHistorySeconds(seconds); };
+
+    resized();
+}
+
+void MainComponent::createVisualizer(VisualizerMode mode)
+{
+    const auto modeFor = [](bool fast) { return fast ? TraceRenderer::Mode::speed : TraceRenderer::Mode::quality; };
+    juce::Component* created = nullptr;
+    {
+        const juce::ScopedLock sl(visualizerSetupLock);
+        switch (mode)
+        {
+        case VisualizerMode::Oscilloscope:
+            if (oscilloscopeDisplay != nullptr) return;
+            oscilloscopeDisplay = std::make_unique<Oscilloscope>();
+            oscilloscopeDisplay->setTraceMode(modeFor(fastScopeTraces));
+            if (visualizerSampleRate > 0.0) oscilloscopeDisplay->setSampleRate(visualizerSampleRate);
+            created = oscilloscopeDisplay.get();
+            break;
+
+        case VisualizerMode::StereoImage:
+            if (stereoImageDisplay != nullptr) return;
+            stereoImageDisplay = std::make_unique<StereoImage>();
+            stereoImageDisplay->setTraceMode(modeFor(fastStereoTraces));
+            created = stereoImageDisplay.get();
+            break;
+
+        case VisualizerMode::Transfer:
+            if (transferDisplay != nullptr) return;
+            transferDisplay = std::make_unique<TransferFunctionAnalyzer>();
+            transferDisplay->setInputChannels(transferReferenceChannel, transferMeasurementChannel);
+            if (visualizerSampleRate > 0.0) transferDisplay->setSampleRate(visualizerSampleRate);
+            created = transferDisplay.get();
+            break;
+
+        case VisualizerMode::Bridge:
+            if (bridgeDisplay != nullptr) return;
+            bridgeDisplay = std::make_unique<MeterBridgeView>();
+            bridgeDisplay->setMetric(currentMeterMode == MeterMode::LUFS ? MeterBridgeView::Metric::loudness
+                                   : currentMeterMode == MeterMode::TP   ? MeterBridgeView::Metric::truePeak
+                                                                         : MeterBridgeView::Metric::level);
+            created = bridgeDisplay.get();
+            break;
+
+        case VisualizerMode::Spectrum:
+            return;
+        }
+    }
+
+    //Same z-order as if it had been added with the others: below the overlay and placeholder
+    addChildComponent(created, getIndexOfChildComponent(&spectrumDisplay) + 1);
+    resized();
+}
+
+void MainComponent::setFeedAllAnalyzers(bool shouldFeedAll)
+{
+    feedAllAnalyzers = shouldFeedAll;
+
+    if (feedAllAnalyzers)
+        for (auto mode : { VisualizerMode::Oscilloscope, VisualizerMode::StereoImage,
+                           VisualizerMode::Transfer, VisualizerMode::Bridge })
+            createVisualizer(mode);
+}
+
+void MainComponent::setUseMicInput(bool shouldUseInput)
+{
+    //Switching source context => clear visuals + reset analyzers/meters/UI
+    useMicInput = shouldUseInput;
+
+    if (useMicInput && transportSource.isPlaying())
+        stopButtonClicked();
+
+    clearVisuals();
+    resetMetersAndAnalyzers();
+
+    //Show/hide playback UI portions when in mic mode
+    const bool showPlayback = !useMicInput && !showingSettings;
+    openButton.setVisible(showPlayback);
+    playButton.setVisible(showPlayback);
+    stopButton.setVisible(showPlayback);
+    positionSlider.setVisible(showPlayback);
+    timeLabel.setVisible(showPlayback);
+
+    resized();
+    repaint();
 }
 
 MainComponent::~MainComponent()
 {
+    stopTimer();
+    if (deviceOpener != nullptr)
+        deviceOpener->stopThread(-1); // let a device that is still opening finish first
     deviceManager.removeAudioCallback(this);
+
+    if (RealtimeSanitizer::isEnabled())
+        juce::Logger::writeToLog(RealtimeSanitizer::getReport());
 }
 
 //==============================================================================
@@ -280,6 +488,11 @@ void MainComponent::setMeterMode(MeterMode mode)
     tpLeftMeterDisplay.setVisible(showTP);
     tpRightMeterDisplay.setVisible(showTP);
 
+    if (bridgeDisplay != nullptr)
+        bridgeDisplay->setMetric(mode == MeterMode::LUFS ? MeterBridgeView::Metric::loudness
+                               : mode == MeterMode::TP   ? MeterBridgeView::Metric::truePeak
+                                                         : MeterBridgeView::Metric::level);
+
     resized();   //safe now that resized() doesn't call back into setters
     repaint();
 
@@ -298,19 +511,30 @@ void MainComponent::setVisualizerMode(VisualizerMode mode)
     oscilloscopeButton.setToggleState(mode == VisualizerMode::Oscilloscope, juce::dontSendNotification);
     spectrumButton.setToggleState(mode == VisualizerMode::Spectrum, juce::dontSendNotification);
     stereoImageButton.setToggleState(mode == VisualizerMode::StereoImage, juce::dontSendNotification);
+    transferButton.setToggleState(mode == VisualizerMode::Transfer, juce::dontSendNotification);
+    bridgeButton.setToggleState(mode == VisualizerMode::Bridge, juce::dontSendNotification);
 
     oscilloscopeButton.setEnabled(true);
     spectrumButton.setEnabled(true);
     stereoImageButton.setEnabled(true);
+    transferButton.setEnabled(true);
+    bridgeButton.setEnabled(true);
 
     const bool showUI = !showingSettings;
+    if (showUI)
+        createVisualizer(mode);
+
     const bool showScope = showUI && (mode == VisualizerMode::Oscilloscope);
     const bool showSpec = showUI && (mode == VisualizerMode::Spectrum);
     const bool showStereo = showUI && (mode == VisualizerMode::StereoImage);
+    const bool showTransfer = showUI && (mode == VisualizerMode::Transfer);
+    const bool showBridge = showUI && (mode == VisualizerMode::Bridge);
 
-    oscilloscopeDisplay.setVisible(showScope);
     spectrumDisplay.setVisible(showSpec);
-    stereoImageDisplay.setVisible(showStereo);
+    if (oscilloscopeDisplay != nullptr) oscilloscopeDisplay->setVisible(showScope);
+    if (stereoImageDisplay != nullptr)  stereoImageDisplay->setVisible(showStereo);
+    if (transferDisplay != nullptr)     transferDisplay->setVisible(showTransfer);
+    if (bridgeDisplay != nullptr)       bridgeDisplay->setVisible(showBridge);
 
     resized();   // safe now
     repaint();
@@ -326,13 +550,32 @@ void MainComponent::audioDeviceAboutToStart(juce::AudioIODevice* device)
 
     transportSource.prepareToPlay(bufferSize, sampleRate);
 
-    // analyzers
+    // analyzers (lazily built visualizers pick the rate up when they are created)
+    {
+        const juce::ScopedLock sl(visualizerSetupLock);
+        visualizerSampleRate = sampleRate;
+        if (oscilloscopeDisplay != nullptr) oscilloscopeDisplay->setSampleRate(sampleRate);
+        if (transferDisplay != nullptr)     transferDisplay->setSampleRate(sampleRate);
+    }
     spectrumDisplay.setSampleRate(sampleRate);
-    tpDetector.prepare(sampleRate, bufferSize);
+    waveformDisplay.setSampleRate(sampleRate);
+    pitchTracker.setSampleRate(sampleRate);
+    activityDetector.prepare(sampleRate);
+    tpDetector.prepare(sampleRate);
     lufsMeter.prepare(sampleRate);
-
-    tpLeftSmooth = -60.0f;
-    tpRightSmooth = -60.0f;
+    meterBridge.prepare(sampleRate, bufferSize, juce::jmax(device->getActiveInputChannels().countNumberOfSetBits(),
+                                                           device->getActiveOutputChannels().countNumberOfSetBits()));
+    profiler.prepare(sampleRate);
+    loadShedder.prepare(sampleRate);
+    meterExport.setSampleRate(sampleRate);
+    loudnessLog.prepare(sampleRate);
+    currentSampleRate = sampleRate > 0.0 ? sampleRate : 44100.0;
+
+    for (int ch = 0; ch < MeterSnapshot::numChannels; ++ch)
+    {
+        levelBallistics[ch].prepare(sampleRate, MeterBallistics::Type::VU);
+        truePeakBallistics[ch].prepare(sampleRate * tpDetector.getOversamplingFactor(), MeterBallistics::Type::PPM);
+    }
 }
 
 void MainComponent::audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
@@ -342,189 +585,151 @@ void MainComponent::audioDeviceIOCallbackWithContext(const float* const* inputCh
     int numSamples,
     const juce::AudioIODeviceCallbackContext& ctx)
 {
+    RESONANCE_RT_CONTEXT; //debug builds with RESONANCE_RT_SANITIZER=1 flag allocations/locks below
+    const auto callbackStart = juce::Time::getHighResolutionTicks();
+    profiler.beginCallback(numSamples);
+
+    auto& trace = TraceRecorder::getInstance();
+    trace.nameCurrentThread("audio");
+    const TraceRecorder::ScopedEvent traceCallback("audio callback", "audio");
+
     juce::AudioBuffer<float> outputBuffer(outputChannelData, numOutputChannels, numSamples);
     outputBuffer.clear();
 
-    const bool tpVisible = tpLeftMeterDisplay.isVisible() || tpRightMeterDisplay.isVisible();
-    const bool dbVisible = leftMeterDisplay.isVisible() || rightMeterDisplay.isVisible();
-    const bool lufsVisible = lufsLeftMeterDisplay.isVisible() || lufsRightMeterDisplay.isVisible();
-
-    float leftDb = -100.0f, rightDb = -100.0f;
-    float tpLdb = -100.0f, tpRdb = -100.0f;
-    float lufsShort = -100.0f;
-    bool  haveTP = false, haveDB = false, haveLUFS = false;
+    if (meterResetRequested.exchange(false))
+        resetMeterState();
 
     if (useMicInput)
     {
         juce::AudioBuffer<float> inputBuffer(const_cast<float**>(inputChannelData), numInputChannels, numSamples);
 
-        //Feed whichever visualizer is currently visible (cheap enough to feed all too)
-        oscilloscopeDisplay.pushSamples(inputBuffer);
-        waveformDisplay.pushSamples(inputBuffer);
-        spectrumDisplay.pushSamples(inputBuffer);
-
-        if (numInputChannels >= 2)
-        {
-            stereoImageDisplay.pushSamples(inputBuffer);
-        }
+        //Feed the visualizers that are on screen, only while there is signal and the load allows
+        if (isActive(inputBuffer) && loadShedder.shouldFeedVisualizers())
+            pushToVisualizers(inputBuffer, true); //transfer function needs 2+ inputs (reference + measurement)
         else
-        {
-            //Duplicate mono to L+R so the stereo image has two channels
-            juce::AudioBuffer<float> tempStereo(2, numSamples);
-            tempStereo.copyFrom(0, 0, inputBuffer, 0, 0, numSamples);
-            tempStereo.copyFrom(1, 0, inputBuffer, 0, 0, numSamples);
-            stereoImageDisplay.pushSamples(tempStereo);
-        }
+            advanceVisualizers(numSamples);
 
-        if (dbVisible)
+        measureBlock(inputBuffer);
+    }
+    else if (transportSource.isPlaying())
+    {
         {
-            const float leftRMS = numInputChannels > 0 ? calculateRMS(inputBuffer, 0, numSamples, 0) : 0.0f;
-            const float rightRMS = numInputChannels > 1 ? calculateRMS(inputBuffer, 0, numSamples, 1) : leftRMS;
-            leftDb = rmsToDb(leftRMS);
-            rightDb = rmsToDb(rightRMS);
-            haveDB = true;
+            CallbackProfiler::ScopedStage stage(profiler, CallbackProfiler::transportRead);
+            juce::AudioSourceChannelInfo track(&outputBuffer, 0, numSamples);
+            transportSource.getNextAudioBlock(track);
         }
 
-        if (tpVisible)
-        {
-            tpDetector.processBlock(inputBuffer, tpPeaks);
-            const float tpL = TruePeakDetector::linearToDb(tpPeaks.size() > 0 ? tpPeaks[0] : 0.0f);
-            const float tpR = TruePeakDetector::linearToDb(tpPeaks.size() > 1 ? tpPeaks[1] : tpL);
-
-            const float attack = 0.6f, release = 0.2f;
-            tpLeftSmooth = (tpL > tpLeftSmooth) ? attack * tpL + (1.0f - attack) * tpLeftSmooth
-                : release * tpL + (1.0f - release) * tpLeftSmooth;
-            tpRightSmooth = (tpR > tpRightSmooth) ? attack * tpR + (1.0f - attack) * tpRightSmooth
-                : release * tpR + (1.0f - release) * tpRightSmooth;
-
-            tpLdb = tpLeftSmooth; tpRdb = tpRightSmooth;
-            haveTP = true;
-        }
+        if (isActive(outputBuffer) && loadShedder.shouldFeedVisualizers())
+            pushToVisualizers(outputBuffer, false);
+        else
+            advanceVisualizers(numSamples);
 
-        if (lufsVisible)
-        {
-            lufsMeter.processBlock(inputBuffer);
-            lufsShort = lufsMeter.getShortTermLUFS();
-            haveLUFS = true;
-        }
+        measureBlock(outputBuffer);
     }
-    else if (transportSource.isPlaying())
-    {
-        juce::AudioSourceChannelInfo track(&outputBuffer, 0, numSamples);
-        transportSource.getNextAudioBlock(track);
 
-        oscilloscopeDisplay.pushSamples(outputBuffer);
-        waveformDisplay.pushSamples(outputBuffer);
-        stereoImageDisplay.pushSamples(outputBuffer);
-        spectrumDisplay.pushSamples(outputBuffer);
+    profiler.endCallback();
 
-        if (dbVisible)
-        {
-            const float leftRMS = numOutputChannels > 0 ? calculateRMS(outputBuffer, 0, numSamples, 0) : 0.0f;
-            const float rightRMS = numOutputChannels > 1 ? calculateRMS(outputBuffer, 0, numSamples, 1) : leftRMS;
-            leftDb = rmsToDb(leftRMS);
-            rightDb = rmsToDb(rightRMS);
-            haveDB = true;
-        }
+    //Overrun: the callback took longer than the audio it produced
+    const double elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - callbackStart);
+    if (elapsed > numSamples / currentSampleRate)
+        trace.markXrun("callback overrun");
 
-        if (tpVisible)
-        {
-            tpDetector.processBlock(outputBuffer, tpPeaks);
-            const float tpL = TruePeakDetector::linearToDb(tpPeaks.size() > 0 ? tpPeaks[0] : 0.0f);
-            const float tpR = TruePeakDetector::linearToDb(tpPeaks.size() > 1 ? tpPeaks[1] : tpL);
-
-            const float attack = 0.6f, release = 0.2f;
-            tpLeftSmooth = (tpL > tpLeftSmooth) ? attack * tpL + (1.0f - attack) * tpLeftSmooth
-                : release * tpL + (1.0f - release) * tpLeftSmooth;
-            tpRightSmooth = (tpR > tpRightSmooth) ? attack * tpR + (1.0f - attack) * tpRightSmooth
-                : release * tpR + (1.0f - release) * tpRightSmooth;
-
-            tpLdb = tpLeftSmooth; tpRdb = tpRightSmooth;
-            haveTP = true;
-        }
+    //Shed or restore one tier of optional analysis for the next callbacks
+    if (const int step = loadShedder.endCallback(elapsed, numSamples))
+        trace.instant(step > 0 ? "shed analyzer load" : "restore analyzer load", "load");
+}
+
+bool MainComponent::isActive(const juce::AudioBuffer<float>& buffer)
+{
+    CallbackProfiler::ScopedStage stage(profiler, CallbackProfiler::activityGate);
+    return activityDetector.process(buffer);
+}
+
+void MainComponent::measureBlock(const juce::AudioBuffer<float>& buffer)
+{
+    RESONANCE_TRACE_SCOPE("meters", "audio");
+    const int numChannels = buffer.getNumChannels();
+    const int numSamples = buffer.getNumSamples();
+    if (numChannels <= 0 || numSamples <= 0) return;
 
-        if (lufsVisible)
+    auto& snap = meterSnapshots.getWriteBuffer();
+
+    //VU level and sample-peak hold per channel (mono is shown on both sides)
+    {
+        CallbackProfiler::ScopedStage stage(profiler, CallbackProfiler::levelMeters);
+        for (int ch = 0; ch < MeterSnapshot::numChannels; ++ch)
         {
-            lufsMeter.processBlock(outputBuffer);
-            lufsShort = lufsMeter.getShortTermLUFS();
-            haveLUFS = true;
+            const float* samples = buffer.getReadPointer(juce::jmin(ch, numChannels - 1));
+            const auto range = juce::FloatVectorOperations::findMinAndMax(samples, numSamples);
+            if (juce::jmax(-range.getStart(), range.getEnd()) >= 1.0f)
+                clipLatched[ch] = true;
+
+            levelBallistics[ch].process(samples, numSamples);
+            snap.level[ch] = levelBallistics[ch].getReading(clipLatched[ch]);
         }
+    }
 
-        if (!userIsDraggingSlider)
-        {
-            const double position = transportSource.getCurrentPosition();
-            const double duration = transportSource.getLengthInSeconds();
-            if (duration > 0.0)
+    //True peak: PPM ballistics on the oversampled signal, only while its meters are on screen
+    //or the loudness log needs each block's peak
+    const bool logging = loudnessLog.isRunning();
+    snap.haveTruePeak = truePeakShowing.load() || logging;
+    if (snap.haveTruePeak)
+    {
+        CallbackProfiler::ScopedStage stage(profiler, CallbackProfiler::truePeak);
+        std::fill(std::begin(blockTruePeak), std::end(blockTruePeak), 0.0f);
+        tpDetector.upsample(buffer, [this, logging](const juce::dsp::AudioBlock<float>& upBlock)
             {
-                const double relative = position / duration;
-                juce::MessageManager::callAsync([this, relative, position]
+                for (int ch = 0; ch < MeterSnapshot::numChannels; ++ch)
+                {
+                    const auto src = (size_t)juce::jmin(ch, (int)upBlock.getNumChannels() - 1);
+                    const float* samples = upBlock.getChannelPointer(src);
+                    const int n = (int)upBlock.getNumSamples();
+                    truePeakBallistics[ch].process(samples, n);
+
+                    if (logging)
                     {
-                        positionSlider.setValue(relative, juce::dontSendNotification);
-                        timeLabel.setText(formatTime(position), juce::dontSendNotification);
-                    });
-            }
-        }
+                        const auto range = juce::FloatVectorOperations::findMinAndMax(samples, n);
+                        blockTruePeak[ch] = juce::jmax(blockTruePeak[ch], -range.getStart(), range.getEnd());
+                    }
+                }
+            });
     }
+    for (int ch = 0; ch < MeterSnapshot::numChannels; ++ch)
+        snap.truePeak[ch] = truePeakBallistics[ch].getReading(clipLatched[ch]);
 
-    if (haveDB || haveTP || haveLUFS)
+    //Loudness always runs so the integrated value covers the whole programme
     {
-        //compute a target for the readout on the AUDIO thread
-        float targetValForReadout = smoothedMeterValue;
-        switch (currentMeterMode)
-        {
-        case MeterMode::DB:
-            if (haveDB)   targetValForReadout = juce::jmax(leftDb, rightDb);
-            break;
-        case MeterMode::LUFS:
-            if (haveLUFS) targetValForReadout = lufsShort;
-            break;
-        case MeterMode::TP:
-            if (haveTP)   targetValForReadout = juce::jmax(tpLdb, tpRdb);
-            break;
-        }
+        CallbackProfiler::ScopedStage stage(profiler, CallbackProfiler::loudness);
+        lufsMeter.processBlock(buffer);
+        snap.lufsMomentary = lufsMeter.getMomentaryLUFS();
+        snap.lufsShortTerm = lufsMeter.getShortTermLUFS();
+        snap.lufsIntegrated = lufsMeter.getIntegratedLUFS();
+        snap.lufsRange = lufsMeter.getLoudnessRange();
+    }
 
-        //apply exponential smoothing on the AUDIO thread
-        const float a = juce::jlimit(0.01f, 0.99f, meterSmoothingAlpha);  // safety clamp
-        smoothedMeterValue = a * targetValForReadout + (1.0f - a) * smoothedMeterValue;
+    //Per-channel bridge (all input channels, or the two playback channels)
+    if (bridgeShowing.load())
+    {
+        CallbackProfiler::ScopedStage stage(profiler, CallbackProfiler::meterBridge);
+        meterBridge.process(buffer);
+    }
 
-        //snap tiny near-zero negatives to exactly 0.0 so you don't see "-0.0"
-        float displayVal = smoothedMeterValue;
-        if (std::abs(displayVal) < 0.05f) displayVal = 0.0f;
+    CallbackProfiler::ScopedStage stage(profiler, CallbackProfiler::meterPublish);
+    meterExport.publish(snap, numSamples);
+    loudnessLog.addBlock(numSamples, snap, blockTruePeak);
+    meterSnapshots.publish();
+}
 
-        juce::MessageManager::callAsync([this, haveDB, haveTP, haveLUFS,
-            leftDb, rightDb, tpLdb, tpRdb, lufsShort,
-            displayVal]  //pass the final value into the lambda
-            {
-                if (haveDB)
-                {
-                    leftMeterDisplay.setLevel(leftDb);
-                    rightMeterDisplay.setLevel(rightDb);
-                }
-                if (haveTP)
-                {
-                    tpLeftMeterDisplay.setLevel(tpLdb);
-                    tpRightMeterDisplay.setLevel(tpRdb);
-                }
-                if (haveLUFS)
-                {
-                    lufsLeftMeterDisplay.setLevel(lufsShort);
-                    lufsRightMeterDisplay.setLevel(lufsShort);
-                }
+void MainComponent::resetMeterState()
+{
+    lufsMeter.clear();
+    meterBridge.reset();
 
-                //update the label with the smoothed, snapped value
-                switch (currentMeterMode)
-                {
-                case MeterMode::DB:
-                    meterValueLabel.setText(juce::String(displayVal, 1) + "", juce::dontSendNotification);
-                    break;
-                case MeterMode::LUFS:
-                    meterValueLabel.setText(juce::String(displayVal, 1) + "", juce::dontSendNotification);
-                    break;
-                case MeterMode::TP:
-                    meterValueLabel.setText(juce::String(displayVal, 1) + "", juce::dontSendNotification);
-                    break;
-                }
-            });
+    for (int ch = 0; ch < MeterSnapshot::numChannels; ++ch)
+    {
+        levelBallistics[ch].reset();
+        truePeakBallistics[ch].reset();
+        clipLatched[ch] = false;
     }
 }
 
@@ -541,11 +746,16 @@ juce::String MainComponent::cleanFileName(const juce::String& filePath)
 void MainComponent::showSettings(bool show)
 {
     showingSettings = show;
+    if (showingSettings)
+        createSettings();
 
-    settingsComponent->setVisible(showingSettings);
+    if (settingsComponent != nullptr)
+    {
+        settingsComponent->setVisible(showingSettings);
+        settingsComponent->toFront(true);
+    }
     //Keep Settings button ALWAYS visible
     settingsButton.setVisible(true);
-    settingsComponent->toFront(true);
     settingsButton.toFront(true);
 
     //Playback UI toggles based on mic + settings
@@ -561,6 +771,8 @@ void MainComponent::showSettings(bool show)
     meterBox.setVisible(!showingSettings);
     visualizerSidebar.setVisible(!showingSettings);
     meterValueLabel.setVisible(!showingSettings);
+    profilerOverlay.setVisible(profiler.isEnabled() && !showingSettings);
+    pitchLabel.setVisible(!showingSettings);
 
     //Re-apply mode visibility respecting the settings state
     setMeterMode(currentMeterMode);
@@ -677,9 +889,234 @@ juce::String formatTime(double seconds)
     return juce::String::formatted("%02d:%02d", minutes, secs);
 }
 
+void MainComponent::pushToVisualizers(const juce::AudioBuffer<float>& buffer, bool includeTransfer)
+{
+    RESONANCE_TRACE_SCOPE("push visualizers", "audio");
+    using Stage = CallbackProfiler::ScopedStage;
+
+    if (oscilloscopeShowing.load()) { Stage s(profiler, CallbackProfiler::oscilloscope); oscilloscopeDisplay->pushSamples(buffer); }
+    if (waveformShowing.load())     { Stage s(profiler, CallbackProfiler::waveform);     waveformDisplay.pushSamples(buffer); }
+    else                            { Stage s(profiler, CallbackProfiler::waveform);     waveformDisplay.advance(buffer.getNumSamples()); }
+
+    if (spectrumShowing.load())
+    {
+        Stage s(profiler, CallbackProfiler::spectrum);
+        spectrumDisplay.setOverlap(loadShedder.getSpectrumOverlap());
+        spectrumDisplay.pushSamples(buffer);
+    }
+
+    if (pitchShowing.load())        { Stage s(profiler, CallbackProfiler::pitch);        pitchTracker.pushSamples(buffer); }
+    if (includeTransfer && transferShowing.load()) { Stage s(profiler, CallbackProfiler::transfer); transferDisplay->pushSamples(buffer); }
+
+    if (stereoImageShowing.load())
+    {
+        Stage s(profiler, CallbackProfiler::stereoImage);
+
+        if (buffer.getNumChannels() >= 2)
+        {
+            stereoImageDisplay->pushSamples(buffer);
+        }
+        else if (buffer.getNumChannels() == 1)
+        {
+            //Present mono as L+R by referring to the same channel twice (no copy, no allocation)
+            float* mono = const_cast<float*>(buffer.getReadPointer(0));
+            float* const channels[2] = { mono, mono };
+            const juce::AudioBuffer<float> asStereo(channels, 2, buffer.getNumSamples());
+            stereoImageDisplay->pushSamples(asStereo);
+        }
+    }
+}
+
+void MainComponent::advanceVisualizers(int numSamples)
+{
+    using Stage = CallbackProfiler::ScopedStage;
+
+    if (oscilloscopeShowing.load()) { Stage s(profiler, CallbackProfiler::oscilloscope); oscilloscopeDisplay->advance(numSamples); }
+
+    //Always, hidden or not: the strip's history is wall-clock time
+    { Stage s(profiler, CallbackProfiler::waveform); waveformDisplay.advance(numSamples); }
+}
+
+void MainComponent::exportProfile()
+{
+    profileChooser = std::make_unique<juce::FileChooser>(
+        "Export callback profile",
+        juce::File::getSpecialLocation(juce::File::userDesktopDirectory).getChildFile("callback-profile.csv"),
+        "*.csv",
+        true, false, this);
+
+    profileChooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                                | juce::FileBrowserComponent::warnAboutOverwriting,
+        [this](const juce::FileChooser& fc)
+        {
+            const auto file = fc.getResult();
+            if (file != juce::File{})
+                file.replaceWithText(profiler.toCsv());
+
+            profileChooser.reset();
+        });
+}
+
+void MainComponent::checkForXruns()
+{
+    auto& trace = TraceRecorder::getInstance();
+
+    //Device-reported xruns (-1 when the driver does not count them)
+    if (auto* device = deviceManager.getCurrentAudioDevice())
+    {
+        const int xruns = device->getXRunCount();
+        if (lastXrunCount >= 0 && xruns > lastXrunCount)
+            trace.markXrun("device xrun");
+        lastXrunCount = xruns;
+    }
+
+    const double now = juce::Time::getMillisecondCounterHiRes();
+
+    //Dump half a second after the first xrun, at most every 10 s
+    if (trace.consumeXrun() && dumpTraceOnXrun && traceDumpDueMs == 0.0 && now - lastTraceDumpMs > 10000.0)
+        traceDumpDueMs = now + 500.0;
+
+    if (traceDumpDueMs != 0.0 && now >= traceDumpDueMs)
+    {
+        traceDumpDueMs = 0.0;
+        lastTraceDumpMs = now;
+
+        const auto dir = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("Resonance Traces");
+        dir.createDirectory();
+        const auto file = dir.getChildFile("xrun-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S") + ".json");
+        juce::Logger::writeToLog(trace.writeChromeTrace(file) ? "Xrun trace written to " + file.getFullPathName()
+                                                              : "Xrun trace: could not write " + file.getFullPathName());
+    }
+}
+
+void MainComponent::saveTrace()
+{
+    traceChooser = std::make_unique<juce::FileChooser>(
+        "Save trace (Chrome trace-event JSON)",
+        juce::File::getSpecialLocation(juce::File::userDesktopDirectory).getChildFile("resonance-trace.json"),
+        "*.json",
+        true, false, this);
+
+    traceChooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::canSelectFiles
+                              | juce::FileBrowserComponent::warnAboutOverwriting,
+        [this](const juce::FileChooser& fc)
+        {
+            const auto file = fc.getResult();
+            if (file != juce::File{})
+                TraceRecorder::getInstance().writeChromeTrace(file);
+
+            traceChooser.reset();
+        });
+}
+
+void MainComponent::updateVisualizerVisibility()
+{
+    //isShowing() is false for hidden components and for a minimized window. Visualizers
+    //that haven't been built yet are never fed.
+    const auto showing = [this](const juce::Component* c) { return c != nullptr && (feedAllAnalyzers || c->isShowing()); };
+
+    //A scope that was hidden missed that time entirely: start it empty rather than stale
+    const bool scopeShowing = showing(oscilloscopeDisplay.get());
+    if (scopeShowing && !oscilloscopeShowing.load())
+        oscilloscopeDisplay->clear();
+    oscilloscopeShowing.store(scopeShowing);
+    waveformShowing.store(showing(&waveformDisplay));
+    stereoImageShowing.store(showing(stereoImageDisplay.get()));
+    spectrumShowing.store(showing(&spectrumDisplay));
+    transferShowing.store(showing(transferDisplay.get()));
+    pitchShowing.store(showing(&pitchLabel));
+    truePeakShowing.store(showing(&tpLeftMeterDisplay) || showing(&tpRightMeterDisplay));
+    bridgeShowing.store(showing(bridgeDisplay.get()));
+}
+
+void MainComponent::updateMeters(const MeterSnapshot& snap)
+{
+    //dbMeter only repaints when its fill or marker moves by a pixel or more
+    leftMeterDisplay.setReading(snap.level[0]);
+    rightMeterDisplay.setReading(snap.level[1]);
+    lufsLeftMeterDisplay.setLevel(snap.lufsShortTerm);
+    lufsRightMeterDisplay.setLevel(snap.lufsShortTerm);
+
+    if (snap.haveTruePeak)
+    {
+        tpLeftMeterDisplay.setReading(snap.truePeak[0]);
+        tpRightMeterDisplay.setReading(snap.truePeak[1]);
+    }
+
+    //Readout for the selected mode. The values already carry their meter
+    //ballistics, so no further smoothing is applied here.
+    float displayVal = 0.0f;
+    switch (currentMeterMode)
+    {
+    case MeterMode::DB:   displayVal = juce::jmax(snap.level[0].levelDb, snap.level[1].levelDb); break;
+    case MeterMode::LUFS: displayVal = snap.lufsShortTerm; break;
+    case MeterMode::TP:   displayVal = juce::jmax(snap.truePeak[0].peakHoldDb, snap.truePeak[1].peakHoldDb); break;
+    }
+
+    //snap tiny near-zero negatives to exactly 0.0 so you don't see "-0.0"
+    if (std::abs(displayVal) < 0.05f) displayVal = 0.0f;
+
+    meterValueLabel.setText(juce::String(displayVal, 1), juce::dontSendNotification); //no-op if unchanged
+}
+
+void MainComponent::timerCallback()
+{
+    RESONANCE_TRACE_SCOPE("timer", "message");
+
+    updateVisualizerVisibility();
+
+    //Background device open finished: enable the controls that need it
+    if (!deviceOpenHandled)
+    {
+        if (!deviceOpened.load())
+            return;
+        audioDeviceOpened();
+    }
+
+    checkForXruns();
+
+    //Let the user know when the visualizers are running reduced to protect the audio
+    const int shedLevel = loadShedder.getLevel();
+    if (shedLevel != shownShedLevel)
+    {
+        shownShedLevel = shedLevel;
+        visualizerSidebar.setText(shedLevel == LoadShedder::full ? "Visualizers" : "Visualizers (reduced)");
+    }
+
+    //Newest meter values, if the audio thread published any since the last tick
+    if (meterSnapshots.acquire())
+        updateMeters(meterSnapshots.getReadBuffer());
+
+    if (meterBridge.acquire() && bridgeDisplay != nullptr)
+        bridgeDisplay->setSnapshot(meterBridge.getSnapshot());
+
+    //Playback position
+    if (!useMicInput && transportSource.isPlaying() && !userIsDraggingSlider)
+    {
+        const double position = transportSource.getCurrentPosition();
+        const double duration = transportSource.getLengthInSeconds();
+        if (duration > 0.0)
+        {
+            positionSlider.setValue(position / duration, juce::dontSendNotification);
+            timeLabel.setText(formatTime(position), juce::dontSendNotification);
+        }
+    }
+
+    pitchLabel.setText(PitchTracker::describePitch(pitchTracker.getFrequency()), juce::dontSendNotification);
+}
+
 void MainComponent::paint(juce::Graphics& g)
 {
     g.fillAll(juce::Colours::lightslategrey);
+
+    if (!firstFrameLogged)
+    {
+        firstFrameLogged = true;
+        const double now = juce::Time::getMillisecondCounterHiRes();
+        juce::Logger::writeToLog("Startup: first frame after " + juce::String(now - launchTimeMs, 1) + " ms (main component built in "
+                                 + juce::String(constructedMs - launchTimeMs, 1) + " ms)");
+        TraceRecorder::getInstance().instant("first frame", "startup");
+    }
 }
 
 void MainComponent::resized()
@@ -702,14 +1139,20 @@ void MainComponent::resized()
     //Always keep settings button visible and reachable
     settingsButton.setBounds(getWidth() - 55, bottomY, 50, 40);
 
+    //Settings panel covers everything above the bottom bar
+    if (settingsComponent != nullptr)
+        settingsComponent->setBounds(getLocalBounds().withTrimmedBottom(buttonSize + padding * 2));
+
     //Sidebar
-    visualizerSidebar.setBounds(getWidth() - sidebarWidth, 10, sidebarWidth - 10, 115);
-    spectrumButton.setBounds(getWidth() - sidebarWidth + 10, 30, sidebarWidth - 30, 20);
-    oscilloscopeButton.setBounds(getWidth() - sidebarWidth + 10, 60, sidebarWidth - 30, 20);
-    stereoImageButton.setBounds(getWidth() - sidebarWidth + 10, 90, sidebarWidth - 30, 20);
+    visualizerSidebar.setBounds(getWidth() - sidebarWidth, 10, sidebarWidth - 10, 125);
+    spectrumButton.setBounds(getWidth() - sidebarWidth + 10, 27, sidebarWidth - 30, 16);
+    oscilloscopeButton.setBounds(getWidth() - sidebarWidth + 10, 46, sidebarWidth - 30, 16);
+    stereoImageButton.setBounds(getWidth() - sidebarWidth + 10, 65, sidebarWidth - 30, 16);
+    transferButton.setBounds(getWidth() - sidebarWidth + 10, 84, sidebarWidth - 30, 16);
+    bridgeButton.setBounds(getWidth() - sidebarWidth + 10, 103, sidebarWidth - 30, 16);
 
     const int meterBoxTop = visualizerSidebar.getBottom() + 10;
-    meterBox.setBounds(getWidth() - sidebarWidth, meterBoxTop - 10, sidebarWidth - 10, 170);
+    meterBox.setBounds(getWidth() - sidebarWidth, meterBoxTop - 10, sidebarWidth - 10, 160);
 
     //Main content
     const int contentX = padding;
@@ -723,13 +1166,21 @@ void MainComponent::resized()
     timeLabel.setBounds(sliderX + sliderWid - 5, bottomY + 10, 50, 20);
 
     //Visualizers (stacked; we show one at a time)
-    oscilloscopeDisplay.setBounds(contentX + 5, topBarHeight - 20, contentWidth - 10, 200);
-    spectrumDisplay.setBounds(contentX + 5, topBarHeight - 20, contentWidth - 10, 200);
-    stereoImageDisplay.setBounds(contentX + 5, topBarHeight - 20, contentWidth - 10, 200);
+    const juce::Rectangle<int> visualizerArea(contentX + 5, topBarHeight - 20, contentWidth - 10, 200);
+    spectrumDisplay.setBounds(visualizerArea);
+    for (juce::Component* c : { (juce::Component*)oscilloscopeDisplay.get(), (juce::Component*)stereoImageDisplay.get(),
+                                (juce::Component*)transferDisplay.get(), (juce::Component*)bridgeDisplay.get() })
+        if (c != nullptr)
+            c->setBounds(visualizerArea);
+    deviceStatusLabel.setBounds(visualizerArea.withSizeKeepingCentre(juce::jmin(visualizerArea.getWidth(), 300), 30));
+
+    //Profiler overlay: top-right corner of the visualizer area
+    profilerOverlay.setBounds(visualizerArea.getRight() - 274, visualizerArea.getY() + 4,
+                              270, juce::jmin(ProfilerOverlay::getPreferredHeight(), visualizerArea.getHeight() - 8));
 
     //Waveform
     const int waveformHeight = 40;
-    const int waveformTop = oscilloscopeDisplay.getBottom() + 10;
+    const int waveformTop = visualizerArea.getBottom() + 10;
     const int waveformRight = meterBox.getX() - 10;
     const int waveformWidth = waveformRight - padding;
     waveformDisplay.setBounds(padding + 5, waveformTop + 2, waveformWidth - 10, waveformHeight + 20);
@@ -768,5 +1219,7 @@ void MainComponent::resized()
         valueLabelTop,
         meterBox.getWidth() - 20,
         18);
+
+    pitchLabel.setBounds(meterValueLabel.getX(), meterValueLabel.getBottom() + 2, meterValueLabel.getWidth(), 18);
 }
 
@@ -7,11 +7,26 @@
 #include "Waveform.h"
 #include "StereoImage.h"
 #include "SpectrumAnalyzer.h"
+#include "TransferFunctionAnalyzer.h"
 
 // Meters / analyzers
 #include "dbMeter.h"
 #include "TruePeakDetector.h"
 #include "LufsMeter.h"
+#include "PitchTracker.h"
+#include "ActivityDetector.h"
+#include "MeterBallistics.h"
+#include "MeterSnapshot.h"
+#include "MeterBridge.h"
+#include "MeterBridgeView.h"
+#include "MeterExport.h"
+#include "LoudnessLog.h"
+#include "TripleBuffer.h"
+#include "RealtimeSanitizer.h"
+#include "CallbackProfiler.h"
+#include "LoadShedder.h"
+#include "ProfilerOverlay.h"
+#include "TraceRecorder.h"
 
 // UI / settings
 #include "Settings.h"
@@ -19,12 +34,26 @@
 //==============================================================================
 // Main app component: hosts audio I/O, analyzers, and UI.
 class MainComponent : public juce::Component,
-    public juce::AudioIODeviceCallback
+    public juce::AudioIODeviceCallback,
+    private juce::Timer
 {
 public:
-    MainComponent();
+    //By default the system's audio devices are used, opened on a background thread while
+    //the window shows a placeholder; pass a device type (e.g. the SimulatedAudioDeviceType)
+    //to run on that instead, opened before the constructor returns
+    explicit MainComponent(std::unique_ptr<juce::AudioIODeviceType> audioDeviceType = nullptr);
     ~MainComponent() override;
 
+    //Analyse the device input instead of the file player (what the mic button toggles)
+    void setUseMicInput(bool shouldUseInput);
+
+    //Headless runs: feed every visualizer and analyzer as if all were on screen
+    void setFeedAllAnalyzers(bool shouldFeedAll);
+
+    juce::AudioDeviceManager& getAudioDeviceManager() noexcept { return deviceManager; }
+    CallbackProfiler& getProfiler() noexcept { return profiler; }
+    LoudnessLog& getLoudnessLog() noexcept { return loudnessLog; }
+
     // Audio device callbacks
     void audioDeviceAboutToStart(juce::AudioIODevice* device) override;
     void audioDeviceIOCallbackWithContext(const float* const* inputChannelData,
@@ -39,7 +68,14 @@ public:
     void paint(juce::Graphics& g) override;
     void resized() override;
 
+    //Level helpers (static so the bench can time them without a component)
+    static float calculateRMS(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples, int channel);
+    static float rmsToDb(float rms);
+
 private:
+    //UI refresh for values the analyzers and meters publish (polled at frame rate)
+    void timerCallback() override;
+
     //==============================================================================
     // App state
 
@@ -52,7 +88,7 @@ private:
     void setMeterMode(MeterMode mode);
 
     //Visualizer mode (radio behavior)
-    enum class VisualizerMode { Oscilloscope, Spectrum, StereoImage };
+    enum class VisualizerMode { Oscilloscope, Spectrum, StereoImage, Transfer, Bridge };
     VisualizerMode currentVisualizerMode = VisualizerMode::Oscilloscope;
     void setVisualizerMode(VisualizerMode mode);
 
@@ -69,6 +105,24 @@ private:
     //==============================================================================
     //Audio core
     juce::AudioDeviceManager deviceManager;
+
+    //Opening the default devices can take hundreds of ms (driver scans), so it runs on
+    //this thread; the timer finishes up once deviceOpened is set. Until then nothing on
+    //the message thread touches deviceManager. The device types themselves are created
+    //on the message thread first: some keep thread-bound state (COM, hidden
+    //notification windows on Windows) that must not belong to this short-lived thread.
+    struct DeviceOpener : public juce::Thread
+    {
+        explicit DeviceOpener(MainComponent& o) : juce::Thread("Audio device open"), owner(o) {}
+        void run() override { owner.openAudioDevice(); }
+        MainComponent& owner;
+    };
+    std::unique_ptr<DeviceOpener> deviceOpener;
+    std::atomic<bool> deviceOpened{ false };
+    bool deviceOpenHandled = false;     // message thread
+    juce::String deviceOpenError;       // written before deviceOpened
+    void openAudioDevice();             // opener thread (or the constructor for custom device types)
+    void audioDeviceOpened();           // message thread
     juce::AudioFormatManager formatManager;
     juce::AudioTransportSource transportSource;
 
@@ -81,19 +135,68 @@ private:
     // Utility
     juce::String currentFileName;
     juce::String cleanFileName(const juce::String& filePath);
-    float calculateRMS(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples, int channel);
-    float rmsToDb(float rms);
     float displayDb = 0.0f;
 
     //==============================================================================
     // Analyzers / meters
     TruePeakDetector tpDetector{ 2, 2 };   // stereo, 4x oversampling
-    std::vector<float> tpPeaks;
-    float tpLeftSmooth = -60.0f;
-    float tpRightSmooth = -60.0f;
+
+    //Audio thread: per-sample ballistics, one per meter bar
+    MeterBallistics levelBallistics[MeterSnapshot::numChannels];     // VU
+    MeterBallistics truePeakBallistics[MeterSnapshot::numChannels];  // PPM at the oversampled rate
 
     LufsMeter lufsMeter;
-    float lufsShortVal = -60.0f;
+
+    //Every input channel's peak/RMS/loudness/true peak, only while the bridge is showing
+    MeterBridge meterBridge;
+    std::atomic<bool> bridgeShowing{ false };
+
+    //Audio thread -> UI timer
+    TripleBuffer<MeterSnapshot> meterSnapshots;
+    std::atomic<bool> meterResetRequested{ false };
+    std::atomic<bool> truePeakShowing{ false };
+    bool clipLatched[MeterSnapshot::numChannels] = { false, false }; // audio thread
+
+    //Audio thread -> other processes: every snapshot also goes to shared memory
+    MeterExport meterExport;
+
+    //Audio thread -> writer thread: 100 ms loudness/true-peak records for the ring file
+    LoudnessLog loudnessLog;
+    float blockTruePeak[MeterSnapshot::numChannels] = { 0.0f, 0.0f }; // audio thread
+
+    //Audio thread: meter one block and publish a snapshot
+    void measureBlock(const juce::AudioBuffer<float>& buffer);
+    void resetMeterState();
+
+    //Message thread: apply a snapshot to the meter widgets and readout
+    void updateMeters(const MeterSnapshot& snap);
+
+    PitchTracker pitchTracker;
+
+    //Silence gate: visualizers and analyzers are only fed while there is signal
+    ActivityDetector activityDetector;
+
+    //Steps optional analysis down (spectrum overlap, then visualizer feeds) when the
+    //callback gets close to its buffer period; metering is never shed
+    LoadShedder loadShedder;
+    int shownShedLevel = LoadShedder::full; // message thread
+
+    //Per-stage callback timing (enabled from Settings) and its overlay
+    CallbackProfiler profiler;
+    ProfilerOverlay profilerOverlay{ profiler, loadShedder };
+    std::unique_ptr<juce::FileChooser> profileChooser;
+    void exportProfile();
+    bool isActive(const juce::AudioBuffer<float>& buffer); //timed activity gate (audio thread)
+
+    //Trace recorder: callback overruns (audio thread) and device xruns (polled by the
+    //timer) trigger a dump of the ring shortly afterwards, so the aftermath is included
+    double currentSampleRate = 44100.0;
+    bool dumpTraceOnXrun = true;
+    int lastXrunCount = -1;
+    double traceDumpDueMs = 0.0, lastTraceDumpMs = 0.0;
+    std::unique_ptr<juce::FileChooser> traceChooser;
+    void checkForXruns();
+    void saveTrace();
 
     // Meter widgets (three modes: DB / LUFS / TP)
     dbMeter leftMeterDisplay;
@@ -104,11 +207,41 @@ private:
     dbMeter tpRightMeterDisplay;
 
     //==============================================================================
-    //Visualizers
-    Oscilloscope oscilloscopeDisplay;
+    //Visualizers. The default (spectrum) and the waveform strip are always on screen;
+    //the others are built the first time they are selected (or fed headless). Audio
+    //thread pushes are gated by the *Showing flags, which are only set once they exist.
     Waveform     waveformDisplay;
-    StereoImage  stereoImageDisplay;
     SpectrumAnalyzer spectrumDisplay;
+    std::unique_ptr<Oscilloscope> oscilloscopeDisplay;
+    std::unique_ptr<StereoImage> stereoImageDisplay;
+    std::unique_ptr<TransferFunctionAnalyzer> transferDisplay;
+    std::unique_ptr<MeterBridgeView> bridgeDisplay;
+    void createVisualizer(VisualizerMode mode);   // message thread; no-op if it exists
+
+    //State a lazily built visualizer starts from. The sample rate is also set from
+    //audioDeviceAboutToStart on the opener thread, hence the lock.
+    juce::CriticalSection visualizerSetupLock;
+    double visualizerSampleRate = 0.0;
+    bool fastScopeTraces = false, fastStereoTraces = false;
+    int transferReferenceChannel = 0, transferMeasurementChannel = 1;
+
+    //Which visualizers are on screen (refreshed by the timer, read on the audio thread).
+    //Hidden or minimized ones get no samples, so they never request frames.
+    std::atomic<bool> oscilloscopeShowing{ false };
+    std::atomic<bool> waveformShowing{ false };
+    std::atomic<bool> stereoImageShowing{ false };
+    std::atomic<bool> spectrumShowing{ false };
+    std::atomic<bool> transferShowing{ false };
+    std::atomic<bool> pitchShowing{ false };
+    bool feedAllAnalyzers = false;
+    void updateVisualizerVisibility();
+
+    //Audio thread: feed the showing visualizers (and pitch tracker) with one block
+    void pushToVisualizers(const juce::AudioBuffer<float>& buffer, bool includeTransfer);
+
+    //Audio thread, for a block the visualizers were not fed (gated or shed): keeps the
+    //scrolling views' time axis running, so they never show old signal as live
+    void advanceVisualizers(int numSamples);
 
     //--- Centralized clear/reset (used by multiple places) --------------------
     void clearVisuals();                 
@@ -139,6 +272,8 @@ private:
     juce::TextButton oscilloscopeButton;
     juce::TextButton spectrumButton;
     juce::TextButton stereoImageButton;
+    juce::TextButton transferButton;
+    juce::TextButton bridgeButton;
 
     //Meter mode buttons
     juce::TextButton dbButton{ "dB" };
@@ -146,13 +281,17 @@ private:
     juce::TextButton tpButton{ "dBTP" };
 
     juce::Label meterValueLabel;
+    juce::Label pitchLabel;
 
-    float smoothedMeterValue = -60.0f;   // initial dB/LUFS/TP
-    float meterSmoothingAlpha = 0.2f;    // 0.1–0.3 = slower, 0.6–0.8 = faster
-
-    //Settings panel
+    //Settings panel, built the first time it is opened (it scans the device list)
     std::unique_ptr<Settings> settingsComponent;
     bool showingSettings = false;
+    void createSettings();
+
+    //Startup: placeholder while the device opens, and time to first frame
+    juce::Label deviceStatusLabel;
+    double constructedMs = 0.0;
+    bool firstFrameLogged = false;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainComponent)
 };
@@ -0,0 +1,145 @@
+#pragma once
+#include <JuceHeader.h>
+#include <cmath>
+
+//What one meter bar shows for one channel: the ballistic level, the held peak
+//marker and the (latched) clip indicator. Levels are in dB, floored at -100.
+struct MeterReading
+{
+    float levelDb = -100.0f;
+    float peakHoldDb = -100.0f;
+    bool clipped = false;
+};
+
+//Standard meter ballistics for one channel, run per sample so the reading only
+//depends on the signal and the sample rate, never on the callback block size.
+//
+//  PPM: IEC 60268-10 Type I (DIN). Quasi-peak attack with a 1.7 ms time constant,
+//       fall-back of 20 dB in 1.5 s.
+//  VU:  IEC 60268-17. Full-wave average through a critically damped 2nd order
+//       response reaching 99% in 300 ms; calibrated so a sine reads its RMS level.
+//
+//Both also track a digital sample-peak hold (instant attack, held for
+//peakHoldSeconds, then falling at peakFallDbPerSecond) for the bar's marker.
+class MeterBallistics
+{
+public:
+    enum class Type { PPM, VU };
+
+    void prepare(double sampleRate, Type newType, double peakHoldSeconds = 2.0, float peakFallDbPerSecond = 20.0f)
+    {
+        type = newType;
+        const double sr = juce::jmax(1.0, sampleRate);
+
+        //PPM
+        ppmAttack = (float)(1.0 - std::exp(-1.0 / (ppmAttackSeconds * sr)));
+        ppmRelease = dbPerSecondToGainPerSample(ppmFallDb / ppmFallSeconds, sr);
+
+        //VU: two cascaded one-poles with equal time constants (critically damped);
+        //the step response reaches 99% after ~6.64 time constants
+        vuCoeff = (float)(1.0 - std::exp(-6.64 / (vuRiseSeconds * sr)));
+
+        //Peak hold
+        holdSamples = juce::jmax((juce::int64)0, (juce::int64)(peakHoldSeconds * sr));
+        holdRelease = dbPerSecondToGainPerSample(peakFallDbPerSecond, sr);
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        env1 = env2 = 0.0f;
+        held = 0.0f;
+        holdCounter = 0;
+    }
+
+    //Audio thread
+    void process(const float* samples, int numSamples) noexcept
+    {
+        if (type == Type::PPM) processPPM(samples, numSamples);
+        else                   processVU(samples, numSamples);
+    }
+
+    float getLevelDb() const noexcept
+    {
+        return gainToDb(type == Type::PPM ? env1 : env2 * vuSineCalibration);
+    }
+
+    float getPeakHoldDb() const noexcept { return gainToDb(held); }
+
+    MeterReading getReading(bool clipped) const noexcept
+    {
+        return { getLevelDb(), getPeakHoldDb(), clipped };
+    }
+
+    static float gainToDb(float g) noexcept { return g > 0.00001f ? 20.0f * std::log10(g) : -100.0f; }
+
+private:
+    static constexpr double ppmAttackSeconds = 0.0017;
+    static constexpr double ppmFallDb = 20.0, ppmFallSeconds = 1.5;
+    static constexpr double vuRiseSeconds = 0.3;
+    static constexpr float vuSineCalibration = 1.1107207f; //pi / (2 * sqrt(2)): rectified mean -> RMS for a sine
+    static constexpr float denormalFloor = 1.0e-12f;
+
+    static float dbPerSecondToGainPerSample(double dbPerSecond, double sr)
+    {
+        return (float)std::pow(10.0, -dbPerSecond / (20.0 * sr));
+    }
+
+    //Applied per sample (not per block) so the state stays independent of the block size
+    static float flushDenormal(float v) noexcept { return v < denormalFloor ? 0.0f : v; }
+
+    void updatePeakHold(float x) noexcept
+    {
+        if (x >= held)
+        {
+            held = x;
+            holdCounter = holdSamples;
+        }
+        else if (holdCounter > 0)
+        {
+            --holdCounter;
+        }
+        else
+        {
+            held = flushDenormal(held * holdRelease);
+        }
+    }
+
+    void processPPM(const float* samples, int numSamples) noexcept
+    {
+        float e = env1;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = std::abs(samples[i]);
+            e = (x > e) ? e + ppmAttack * (x - e) : flushDenormal(e * ppmRelease);
+            updatePeakHold(x);
+        }
+        env1 = e;
+    }
+
+    void processVU(const float* samples, int numSamples) noexcept
+    {
+        float a = env1, b = env2;
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float x = std::abs(samples[i]);
+            a = flushDenormal(a + vuCoeff * (x - a));
+            b = flushDenormal(b + vuCoeff * (a - b));
+            updatePeakHold(x);
+        }
+        env1 = a;
+        env2 = b;
+    }
+
+    Type type = Type::PPM;
+
+    float ppmAttack = 1.0f, ppmRelease = 0.0f;
+    float vuCoeff = 1.0f;
+
+    float env1 = 0.0f, env2 = 0.0f;
+
+    float held = 0.0f;
+    float holdRelease = 0.0f;
+    juce::int64 holdSamples = 0, holdCounter = 0;
+};
@@ -0,0 +1,642 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "LufsMeter.h"
+#include "TraceRecorder.h"
+#include "TripleBuffer.h"
+#include "WakeEvent.h"
+
+//Per-channel metering for wide interfaces (up to 64 inputs): sample peak, RMS,
+//momentary and short-term loudness and true peak for every channel, published
+//together in one Snapshot per block.
+//
+//Channels are processed in groups of laneWidth. A group keeps all of its state in
+//struct-of-arrays lanes, and every per-sample step is a fixed-width loop across the
+//group's channels, which the compiler turns into SIMD: one vector operation per step
+//for the whole group instead of one scalar operation per channel. Each chunk of
+//input is first transposed into a frame-major scratch so those loops read
+//contiguous memory.
+//
+//Above parallelThreshold channels, worker threads help. Groups are claimed from an
+//atomic counter by the workers and the audio thread alike, and the audio thread never
+//waits on a worker: it processes every group nobody else has claimed, then returns.
+//Workers read a copy of the input, so they can finish their groups after the
+//callback; whoever finishes the last group publishes the snapshot. A block that
+//arrives while a worker is still busy with the previous one is not waited for: the
+//audio thread only scans it for peaks and power, and the next block folds that into
+//the meters (peaks and clips are kept, loudness counts it at its unweighted power, and
+//the loudness bins keep real time). Such blocks are counted in the snapshot.
+//
+//Loudness uses LufsMeter's BS.1770 K-weighting per channel, on 100 ms bins: M is the
+//mean of the last 4 bins, S of the last 30 (updated every 100 ms). True peak uses a
+//48-tap, 4x polyphase windowed-sinc interpolator (the length of the BS.1770 Annex 2
+//filter) whose first phase is the sample itself.
+class MeterBridge
+{
+public:
+    static constexpr int maxChannels = 64;
+    static constexpr int laneWidth = 8;                 //channels per group (one AVX register of floats)
+    static constexpr int maxGroups = maxChannels / laneWidth;
+    static constexpr int parallelThreshold = 16;        //more channels than this: use the worker pool
+    static constexpr int maxWorkers = 3;
+
+    struct ChannelReading
+    {
+        float peakDb = -100.0f;          //sample peak, PPM-style fall-back
+        float peakHoldDb = -100.0f;
+        float rmsDb = -100.0f;           //300 ms integration
+        float momentaryLufs = -100.0f;
+        float shortTermLufs = -100.0f;
+        float truePeakDb = -100.0f;      //inter-sample peak, same fall-back as peakDb
+        float truePeakHoldDb = -100.0f;
+        bool clipped = false;            //latched until reset()
+    };
+
+    struct Snapshot
+    {
+        int numChannels = 0;
+        int skippedBlocks = 0;           //only scanned for peaks (workers busy), since the last reset
+        ChannelReading channel[maxChannels];
+    };
+
+    MeterBridge() = default;
+    ~MeterBridge() { stopWorkers(); }
+
+    //Before the device starts (not on the audio thread). Starts the worker pool when
+    //more than parallelThreshold channels will be metered, and stops it otherwise.
+    //Blocks longer than maxBlockSize are metered on the audio thread alone.
+    void prepare(double newSampleRate, int maxBlockSize, int numActiveChannels)
+    {
+        //A worker may still be finishing the last block of the previous stream
+        while (jobBusy.load(std::memory_order_acquire))
+            juce::Thread::yield();
+
+        sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+
+        LufsMeter::Biquad shelf, highPass;
+        LufsMeter::makeKWeighting(sampleRate, shelf, highPass);
+        shelfCoeffs = { shelf.b0, shelf.b1, shelf.b2, shelf.a1, shelf.a2 };
+        hpfCoeffs = { highPass.b0, highPass.b1, highPass.b2, highPass.a1, highPass.a2 };
+
+        rmsCoeff = (float)(1.0 - std::exp(-1.0 / (rmsSeconds * sampleRate)));
+        binSamples = juce::jmax(1, (int)std::round(0.100 * sampleRate));
+        designInterpolator();
+
+        groups.resize(maxGroups);
+        for (auto& g : groups)
+            g.frames.assign((size_t)((tpTaps - 1 + chunkSize) * laneWidth), 0.0f);
+
+        clearState();
+
+        const int wantedWorkers = numActiveChannels > parallelThreshold
+                                ? juce::jlimit(0, maxWorkers, juce::SystemStats::getNumCpus() - 2) : 0;
+        if (wantedWorkers != (int)workers.size())
+        {
+            stopWorkers();
+            for (int i = 0; i < wantedWorkers; ++i)
+            {
+                workers.push_back(std::make_unique<Worker>(*this));
+                workers.back()->startThread(juce::Thread::Priority::highest);
+            }
+        }
+
+        //The copy of the input the workers read
+        stagingSamples = wantedWorkers > 0 ? juce::jmax(0, maxBlockSize) : 0;
+        staging.assign((size_t)(maxChannels * stagingSamples), 0.0f);
+        for (int ch = 0; ch < maxChannels; ++ch)
+            stagingChannels[ch] = staging.data() + ch * stagingSamples;
+    }
+
+    //Audio thread. Channels beyond maxChannels are not metered.
+    void process(const juce::AudioBuffer<float>& buffer)
+    {
+        process(buffer.getArrayOfReadPointers(), buffer.getNumChannels(), buffer.getNumSamples());
+    }
+
+    void process(const float* const* channels, int numChannelsIn, int numSamples)
+    {
+        const int numChannels = juce::jmin(numChannelsIn, maxChannels);
+        if (numChannels <= 0 || numSamples <= 0 || groups.empty()) return;
+
+        //A worker still has groups of the previous block: never wait, keep what the
+        //meters must not lose for the next block to fold in
+        if (jobBusy.load(std::memory_order_acquire))
+        {
+            //A reset applies from this block on; the meters themselves are cleared next time
+            if (resetRequested.exchange(false))
+            {
+                clearSkipped();
+                resetDeferred = true;
+            }
+
+            scanSkipped(channels, numChannels, numSamples);
+            droppedBlocks.fetch_add(1, std::memory_order_relaxed);
+            TraceRecorder::getInstance().instant("meter bridge block skipped", "meters");
+            return;
+        }
+
+        if (resetRequested.exchange(false))
+            clearState();
+        else if (resetDeferred)
+            clearMeters();
+        resetDeferred = false;
+
+        const int numGroups = (numChannels + laneWidth - 1) / laneWidth;
+        jobNumChannels = numChannels;
+        jobNumSamples = numSamples;
+        jobBinIndex = binIndex;
+        jobSamplesIntoBin = samplesIntoBin;
+
+        //Hand the skipped blocks' scan to this job
+        jobSkippedSamples = skippedSamples;
+        std::copy(skippedPeak, skippedPeak + maxChannels, jobSkippedPeak);
+        std::copy(skippedPower, skippedPower + maxChannels, jobSkippedPower);
+        skippedSamples = 0;
+        std::fill(skippedPeak, skippedPeak + maxChannels, 0.0f);
+        std::fill(skippedPower, skippedPower + maxChannels, 0.0);
+
+        if (numChannels <= parallelThreshold || workers.empty() || numSamples > stagingSamples)
+        {
+            jobChannels = channels;
+            for (int g = 0; g < numGroups; ++g)
+                processGroup(groups[(size_t)g], g * laneWidth);
+            finishJob();
+            return;
+        }
+
+        //Workers may still be reading after the callback returns, so they get a copy
+        for (int ch = 0; ch < numChannels; ++ch)
+            std::memcpy(stagingChannels[ch], channels[ch], sizeof(float) * (size_t)numSamples);
+
+        //Publish the job, then open the group counter (release: claimers see the job)
+        jobChannels = stagingChannels;
+        doneGroups.store(0, std::memory_order_relaxed);
+        jobBusy.store(true, std::memory_order_relaxed);
+        nextGroup.store(numGroups << claimBits, std::memory_order_release);
+
+        for (auto& w : workers)
+            w->wake.signal();
+
+        runGroups();
+    }
+
+    //Any thread: clears peaks, holds, clip indicators and loudness at the next block
+    void reset() noexcept { resetRequested.store(true); }
+
+    //UI thread: true if a newer snapshot arrived since the last call
+    bool acquire() noexcept { return snapshots.acquire(); }
+    const Snapshot& getSnapshot() const noexcept { return snapshots.getReadBuffer(); }
+
+    int getNumWorkers() const noexcept { return (int)workers.size(); }
+
+    //True while workers are still finishing the last block; blocks passed to process()
+    //meanwhile are skipped. Benchmarks wait on this to time a block to its snapshot.
+    bool isBusy() const noexcept { return jobBusy.load(std::memory_order_acquire); }
+
+    //Blocks only scanned for peaks because a worker was still busy with the one before
+    int getNumDroppedBlocks() const noexcept { return droppedBlocks.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int chunkSize = 256;      //frames transposed at a time
+    static constexpr int numBins = 30;         //100 ms loudness bins: 3 s of short-term history
+    static constexpr int momentaryBins = 4;
+    static constexpr int tpPhases = 4, tpTaps = 12;
+    static constexpr double rmsSeconds = 0.3;
+    static constexpr double holdSeconds = 2.0;
+    static constexpr double fallDbPerSecond = 20.0 / 1.5;  //as MeterBallistics' PPM
+    static constexpr double holdFallDbPerSecond = 20.0;
+    static constexpr int claimBits = 16;       //group counter: number of groups << claimBits | next group
+
+    struct Coefficients { double b0, b1, b2, a1, a2; };
+
+    struct alignas(64) Group
+    {
+        //K-weighting state, transposed direct form II per stage
+        double shelfZ1[laneWidth], shelfZ2[laneWidth], hpfZ1[laneWidth], hpfZ2[laneWidth];
+        double binPower[laneWidth];        //K-weighted power summed over the current bin
+        float meanSquare[laneWidth];       //RMS integrator
+        float peak[laneWidth];             //sample peak since the last publish
+        float truePeak[laneWidth];         //interpolated peak since the last publish
+        float momentary[laneWidth], shortTerm[laneWidth];  //mean K-weighted power
+        float bins[numBins][laneWidth];    //mean power of the finished bins
+        std::vector<float> frames;         //(tpTaps - 1 + chunkSize) frames x laneWidth, frame-major
+
+        void clear()
+        {
+            for (auto* lane : { shelfZ1, shelfZ2, hpfZ1, hpfZ2, binPower })
+                std::fill(lane, lane + laneWidth, 0.0);
+            for (auto* lane : { meanSquare, peak, truePeak, momentary, shortTerm })
+                std::fill(lane, lane + laneWidth, 0.0f);
+            std::fill(&bins[0][0], &bins[0][0] + numBins * laneWidth, 0.0f);
+            std::fill(frames.begin(), frames.end(), 0.0f);
+        }
+    };
+
+    class Worker : public juce::Thread
+    {
+    public:
+        explicit Worker(MeterBridge& o) : juce::Thread("Meter bridge worker"), owner(o) {}
+        ~Worker() override { stopThread(1000); }
+
+        void run() override
+        {
+            for (;;)
+            {
+                wake.wait();
+                if (threadShouldExit())
+                    return;
+                owner.runGroups();
+            }
+        }
+
+        WakeEvent wake;
+
+    private:
+        MeterBridge& owner;
+    };
+
+    //Audio thread and workers: claim and process groups until none are left. The
+    //group count travels in the same word as the claim, so a claim left over from an
+    //earlier block can never pass for one of the current block.
+    void runGroups() noexcept
+    {
+        for (;;)
+        {
+            const int claim = nextGroup.fetch_add(1, std::memory_order_acq_rel);
+            const int g = claim & ((1 << claimBits) - 1), numGroups = claim >> claimBits;
+            if (g >= numGroups)
+                return;
+
+            processGroup(groups[(size_t)g], g * laneWidth);
+
+            //The last group to finish completes the block (acq_rel: it sees every group)
+            if (doneGroups.fetch_add(1, std::memory_order_acq_rel) + 1 == numGroups)
+            {
+                finishJob();
+                jobBusy.store(false, std::memory_order_release);
+            }
+        }
+    }
+
+    //Whoever completes the block: advance the loudness bins and publish
+    void finishJob() noexcept
+    {
+        const juce::int64 elapsed = jobSkippedSamples + jobNumSamples;
+        const juce::int64 total = samplesIntoBin + elapsed;
+        binIndex = (int)((binIndex + total / binSamples) % numBins);
+        samplesIntoBin = (int)(total % binSamples);
+
+        publish(jobNumChannels, elapsed);
+    }
+
+    //Audio thread, for a skipped block: sample peak and power per channel
+    void scanSkipped(const float* const* channels, int numChannels, int numSamples) noexcept
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* x = channels[ch];
+            const auto range = juce::FloatVectorOperations::findMinAndMax(x, numSamples);
+            skippedPeak[ch] = juce::jmax(skippedPeak[ch], -range.getStart(), range.getEnd());
+
+            double power = 0.0;
+            for (int i = 0; i < numSamples; ++i)
+                power += (double)x[i] * x[i];
+            skippedPower[ch] += power;
+        }
+        skippedSamples += numSamples;
+    }
+
+    //Folds the skipped blocks before the job into a group: their peaks (the sample peak
+    //also bounds the true peak from below), and their power spread evenly over the
+    //time they took, finishing the loudness bins that time crosses
+    void addSkipped(Group& grp, int firstChannel, int lanes, int& bin, int& intoBin) noexcept
+    {
+        double meanPower[laneWidth] = {};
+        for (int c = 0; c < lanes; ++c)
+        {
+            const int ch = firstChannel + c;
+            grp.peak[c] = juce::jmax(grp.peak[c], jobSkippedPeak[ch]);
+            grp.truePeak[c] = juce::jmax(grp.truePeak[c], jobSkippedPeak[ch]);
+            meanPower[c] = jobSkippedPower[ch] / (double)jobSkippedSamples;
+
+            const double decay = std::pow(1.0 - (double)rmsCoeff, (double)jobSkippedSamples);
+            grp.meanSquare[c] = (float)(meanPower[c] + (grp.meanSquare[c] - meanPower[c]) * decay);
+        }
+
+        for (juce::int64 left = jobSkippedSamples; left > 0;)
+        {
+            const int n = (int)juce::jmin(left, (juce::int64)(binSamples - intoBin));
+            for (int c = 0; c < laneWidth; ++c)
+                grp.binPower[c] += meanPower[c] * n;
+
+            left -= n;
+            intoBin += n;
+            if (intoBin == binSamples)
+            {
+                intoBin = 0;
+                finishBin(grp, bin);
+                bin = (bin + 1) % numBins;
+            }
+        }
+    }
+
+    void processGroup(Group& grp, int firstChannel) noexcept
+    {
+        const int lanes = juce::jmin(laneWidth, jobNumChannels - firstChannel);
+        int bin = jobBinIndex, intoBin = jobSamplesIntoBin;
+
+        if (jobSkippedSamples > 0)
+            addSkipped(grp, firstChannel, lanes, bin, intoBin);
+
+        const auto sc = shelfCoeffs, hc = hpfCoeffs;
+        const float rc = rmsCoeff;
+        float* const frames = grp.frames.data();
+        float* const fresh = frames + (tpTaps - 1) * laneWidth;
+
+        for (int start = 0; start < jobNumSamples; start += chunkSize)
+        {
+            const int n = juce::jmin(chunkSize, jobNumSamples - start);
+
+            //Transpose into frame-major order; lanes without a channel stay silent
+            for (int c = 0; c < laneWidth; ++c)
+            {
+                if (c < lanes)
+                {
+                    const float* src = jobChannels[firstChannel + c] + start;
+                    for (int i = 0; i < n; ++i) fresh[i * laneWidth + c] = src[i];
+                }
+                else
+                {
+                    for (int i = 0; i < n; ++i) fresh[i * laneWidth + c] = 0.0f;
+                }
+            }
+
+            for (int i = 0; i < n; ++i)
+            {
+                const float* x = fresh + i * laneWidth;
+
+                for (int c = 0; c < laneWidth; ++c)
+                {
+                    grp.peak[c] = juce::jmax(grp.peak[c], std::abs(x[c]));
+                    grp.meanSquare[c] += rc * (x[c] * x[c] - grp.meanSquare[c]);
+                }
+
+                //K-weighting: high shelf then high-pass
+                for (int c = 0; c < laneWidth; ++c)
+                {
+                    const double in = x[c];
+                    const double s = sc.b0 * in + grp.shelfZ1[c];
+                    grp.shelfZ1[c] = sc.b1 * in - sc.a1 * s + grp.shelfZ2[c];
+                    grp.shelfZ2[c] = sc.b2 * in - sc.a2 * s;
+
+                    const double y = hc.b0 * s + grp.hpfZ1[c];
+                    grp.hpfZ1[c] = hc.b1 * s - hc.a1 * y + grp.hpfZ2[c];
+                    grp.hpfZ2[c] = hc.b2 * s - hc.a2 * y;
+
+                    grp.binPower[c] += y * y;
+                }
+
+                //True peak: x[-6] itself and the points a quarter, half and three
+                //quarters of the way to x[-5] (the interpolator's delay is 6 samples)
+                for (int p = 0; p < tpPhases; ++p)
+                {
+                    float acc[laneWidth] = {};
+                    for (int k = 0; k < tpTaps; ++k)
+                    {
+                        const float h = tpCoeffs[p][k];
+                        const float* xk = x - k * laneWidth;
+                        for (int c = 0; c < laneWidth; ++c)
+                            acc[c] += h * xk[c];
+                    }
+
+                    for (int c = 0; c < laneWidth; ++c)
+                        grp.truePeak[c] = juce::jmax(grp.truePeak[c], std::abs(acc[c]));
+                }
+
+                if (++intoBin == binSamples)
+                {
+                    intoBin = 0;
+                    finishBin(grp, bin);
+                    bin = (bin + 1) % numBins;
+                }
+            }
+
+            //The last tpTaps - 1 frames are the interpolator's history for the next chunk
+            std::memmove(frames, frames + n * laneWidth, sizeof(float) * (size_t)((tpTaps - 1) * laneWidth));
+        }
+    }
+
+    void finishBin(Group& grp, int bin) noexcept
+    {
+        for (int c = 0; c < laneWidth; ++c)
+        {
+            grp.bins[bin][c] = (float)(grp.binPower[c] / binSamples);
+            grp.binPower[c] = 0.0;
+        }
+
+        float m[laneWidth] = {}, s[laneWidth] = {};
+        for (int b = 0; b < numBins; ++b)
+        {
+            const int age = (bin - b + numBins) % numBins;   //0 = the bin just finished
+            for (int c = 0; c < laneWidth; ++c)
+            {
+                s[c] += grp.bins[b][c];
+                if (age < momentaryBins) m[c] += grp.bins[b][c];
+            }
+        }
+
+        for (int c = 0; c < laneWidth; ++c)
+        {
+            grp.momentary[c] = m[c] / (float)momentaryBins;
+            grp.shortTerm[c] = s[c] / (float)numBins;
+        }
+    }
+
+    //Audio thread: ballistics and holds per channel, then one snapshot for all channels
+    void publish(int numChannels, juce::int64 numSamples) noexcept
+    {
+        const double blockSeconds = numSamples / sampleRate;
+        const float fall = (float)(fallDbPerSecond * blockSeconds);
+        const float holdFall = (float)(holdFallDbPerSecond * blockSeconds);
+        const auto holdBlocks = (int)std::ceil(holdSeconds / blockSeconds);
+
+        auto& snap = snapshots.getWriteBuffer();
+        snap.numChannels = numChannels;
+        snap.skippedBlocks = droppedBlocks.load(std::memory_order_relaxed);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& grp = groups[(size_t)(ch / laneWidth)];
+            const int c = ch % laneWidth;
+            auto& r = snap.channel[ch];
+            auto& state = channelState[ch];
+
+            if (grp.peak[c] >= 1.0f) state.clipped = true;
+
+            state.peak.update(gainToDb(grp.peak[c]), fall, holdFall, holdBlocks);
+            state.truePeak.update(gainToDb(grp.truePeak[c]), fall, holdFall, holdBlocks);
+            grp.peak[c] = grp.truePeak[c] = 0.0f;
+
+            r.peakDb = state.peak.levelDb;
+            r.peakHoldDb = state.peak.holdDb;
+            r.truePeakDb = state.truePeak.levelDb;
+            r.truePeakHoldDb = state.truePeak.holdDb;
+            r.rmsDb = powerToDb(grp.meanSquare[c]);
+            r.momentaryLufs = powerToLufs(grp.momentary[c]);
+            r.shortTermLufs = powerToLufs(grp.shortTerm[c]);
+            r.clipped = state.clipped;
+        }
+
+        snapshots.publish();
+    }
+
+    void clearState() noexcept
+    {
+        clearMeters();
+        clearSkipped();
+    }
+
+    void clearMeters() noexcept
+    {
+        for (auto& g : groups)
+            g.clear();
+        for (auto& s : channelState)
+            s = {};
+
+        binIndex = samplesIntoBin = 0;
+    }
+
+    void clearSkipped() noexcept
+    {
+        std::fill(skippedPeak, skippedPeak + maxChannels, 0.0f);
+        std::fill(skippedPower, skippedPower + maxChannels, 0.0);
+        skippedSamples = 0;
+        droppedBlocks.store(0, std::memory_order_relaxed);
+    }
+
+    //48-tap low-pass at the 4x rate (Kaiser-windowed sinc), split into 4 phases of 12
+    //taps; each phase is normalised to unity gain at DC. The centre sits on a tap of
+    //phase 0, so that phase passes the input sample through and the input samples are
+    //among the points checked, as in BS.1770 Annex 2.
+    void designInterpolator()
+    {
+        constexpr int length = tpPhases * tpTaps;
+        constexpr double beta = 6.0;
+        const double centre = 0.5 * length;
+
+        const auto besselI0 = [](double x)
+        {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 25; ++k)
+            {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+            return sum;
+        };
+
+        for (int p = 0; p < tpPhases; ++p)
+        {
+            double sum = 0.0;
+            for (int k = 0; k < tpTaps; ++k)
+            {
+                const double t = (k * tpPhases + p - centre) / tpPhases;   //in input samples
+                const double sinc = std::abs(t) < 1.0e-9 ? 1.0 : std::sin(juce::MathConstants<double>::pi * t) / (juce::MathConstants<double>::pi * t);
+                const double r = (k * tpPhases + p - centre) / centre;
+                const double window = besselI0(beta * std::sqrt(juce::jmax(0.0, 1.0 - r * r))) / besselI0(beta);
+                tpCoeffs[p][k] = (float)(sinc * window);
+                sum += sinc * window;
+            }
+            for (int k = 0; k < tpTaps; ++k)
+                tpCoeffs[p][k] = (float)(tpCoeffs[p][k] / sum);
+        }
+    }
+
+    void stopWorkers()
+    {
+        for (auto& w : workers)
+        {
+            w->signalThreadShouldExit();
+            w->wake.signal();
+        }
+        workers.clear();
+    }
+
+    static float gainToDb(float g) noexcept { return g > 0.00001f ? 20.0f * std::log10(g) : -100.0f; }
+    static float powerToDb(float p) noexcept { return p > 1.0e-10f ? 10.0f * std::log10(p) : -100.0f; }
+    static float powerToLufs(float p) noexcept { return p > 1.0e-10f ? 10.0f * std::log10(p) - 0.691f : -100.0f; }
+
+    //Per-channel peak display: instant attack with a fall-back, plus a held maximum
+    struct PeakState
+    {
+        float levelDb = -100.0f, holdDb = -100.0f;
+        int holdBlocksLeft = 0;
+
+        void update(float blockPeakDb, float fallDb, float holdFallDb, int holdBlocks) noexcept
+        {
+            levelDb = juce::jmax(blockPeakDb, juce::jmax(-100.0f, levelDb - fallDb));
+
+            if (blockPeakDb >= holdDb)
+            {
+                holdDb = blockPeakDb;
+                holdBlocksLeft = holdBlocks;
+            }
+            else if (holdBlocksLeft > 0)
+            {
+                --holdBlocksLeft;
+            }
+            else
+            {
+                holdDb = juce::jmax(-100.0f, holdDb - holdFallDb);
+            }
+        }
+    };
+
+    struct ChannelState
+    {
+        PeakState peak, truePeak;
+        bool clipped = false;
+    };
+
+    double sampleRate = 44100.0;
+    Coefficients shelfCoeffs{}, hpfCoeffs{};
+    float rmsCoeff = 0.0f;
+    float tpCoeffs[tpPhases][tpTaps] = {};
+    int binSamples = 4410;
+
+    std::vector<Group> groups;
+    ChannelState channelState[maxChannels];
+    int binIndex = 0, samplesIntoBin = 0;    //audio thread, between blocks
+
+    //Current job (written by the audio thread before nextGroup opens)
+    const float* const* jobChannels = nullptr;
+    int jobNumChannels = 0, jobNumSamples = 0, jobBinIndex = 0, jobSamplesIntoBin = 0;
+    std::atomic<int> nextGroup{ 0 };
+    std::atomic<int> doneGroups{ 0 };
+    std::atomic<bool> jobBusy{ false };       //groups of a shared block still outstanding
+    std::atomic<int> droppedBlocks{ 0 };
+
+    //Skipped blocks not yet folded in (audio thread), and the ones the current job folds in
+    float skippedPeak[maxChannels] = {};
+    double skippedPower[maxChannels] = {};
+    juce::int64 skippedSamples = 0;
+    bool resetDeferred = false;               //reset() arrived during a skipped block
+    float jobSkippedPeak[maxChannels] = {};
+    double jobSkippedPower[maxChannels] = {};
+    juce::int64 jobSkippedSamples = 0;
+
+    std::vector<float> staging;               //maxChannels x stagingSamples
+    float* stagingChannels[maxChannels] = {};
+    int stagingSamples = 0;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> resetRequested{ false };
+    TripleBuffer<Snapshot> snapshots;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MeterBridge)
+};
@@ -0,0 +1,138 @@
+#include "MeterBridgeView.h"
+
+MeterBridgeView::MeterBridgeView()
+{
+    setOpaque(true);
+}
+
+MeterBridgeView::~MeterBridgeView()
+{
+}
+
+void MeterBridgeView::setMetric(Metric newMetric)
+{
+    if (metric != newMetric)
+    {
+        metric = newMetric;
+        repaint();
+    }
+}
+
+void MeterBridgeView::clear()
+{
+    for (auto& r : readings)
+        r = {};
+    skippedBlocks = 0;
+    repaint();
+}
+
+std::pair<float, float> MeterBridgeView::valuesFor(const MeterBridge::ChannelReading& r) const
+{
+    switch (metric)
+    {
+    case Metric::loudness: return { r.shortTermLufs, r.momentaryLufs };
+    case Metric::truePeak: return { r.truePeakDb, r.truePeakHoldDb };
+    case Metric::level:    break;
+    }
+    return { r.rmsDb, r.peakHoldDb };
+}
+
+int MeterBridgeView::heightFor(float db, int barHeight) const
+{
+    return juce::roundToInt(juce::jmap(juce::jlimit(minDb, maxDb, db), minDb, maxDb, 0.0f, 1.0f) * barHeight);
+}
+
+void MeterBridgeView::setSnapshot(const MeterBridge::Snapshot& snapshot)
+{
+    //Compare in pixels so a steady signal costs no repaints
+    const int barHeight = juce::jmax(1, getHeight() - labelHeight - 8);
+    bool moved = snapshot.numChannels != numChannels || snapshot.skippedBlocks != skippedBlocks;
+
+    for (int ch = 0; ch < snapshot.numChannels && !moved; ++ch)
+    {
+        const auto before = valuesFor(readings[ch]), after = valuesFor(snapshot.channel[ch]);
+        moved = heightFor(before.first, barHeight) != heightFor(after.first, barHeight)
+             || heightFor(before.second, barHeight) != heightFor(after.second, barHeight)
+             || readings[ch].clipped != snapshot.channel[ch].clipped;
+    }
+
+    numChannels = snapshot.numChannels;
+    skippedBlocks = snapshot.skippedBlocks;
+    std::copy(snapshot.channel, snapshot.channel + numChannels, readings);
+
+    if (moved)
+        repaint();
+}
+
+void MeterBridgeView::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds();
+    g.fillAll(juce::Colours::lightgrey);
+
+    g.setColour(juce::Colours::lightslategrey);
+    g.drawRect(bounds, 1);
+
+    if (numChannels <= 0)
+    {
+        g.setColour(juce::Colours::darkslategrey);
+        g.setFont(12.0f);
+        g.drawText("No input channels", bounds, juce::Justification::centred);
+        return;
+    }
+
+    auto area = bounds.reduced(6, 4);
+    auto labels = area.removeFromBottom(labelHeight);
+    const int barHeight = area.getHeight();
+    const float slot = area.getWidth() / (float)numChannels;
+    const int gap = slot >= 8.0f ? 2 : 1;
+
+    juce::ColourGradient gradient;
+    gradient.addColour(0.0, juce::Colours::lightgrey);
+    gradient.addColour(0.7, juce::Colours::lightslategrey);
+    gradient.addColour(1.0, juce::Colours::darkgrey);
+    gradient.point1 = area.getBottomLeft().toFloat();
+    gradient.point2 = area.getTopLeft().toFloat();
+
+    //Label every channel when there is room, otherwise every 4th / 8th
+    const int labelEvery = slot >= 16.0f ? 1 : (slot >= 6.0f ? 4 : 8);
+    g.setFont(10.0f);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        const int x = area.getX() + juce::roundToInt(ch * slot);
+        const int w = juce::jmax(1, juce::roundToInt((ch + 1) * slot) - juce::roundToInt(ch * slot) - gap);
+        const auto [barDb, markerDb] = valuesFor(readings[ch]);
+
+        g.setColour(juce::Colours::white.withAlpha(0.35f));
+        g.fillRect(x, area.getY(), w, barHeight);
+
+        const int fill = heightFor(barDb, barHeight);
+        g.setGradientFill(gradient);
+        g.fillRect(x, area.getBottom() - fill, w, fill);
+
+        if (markerDb >= minDb)
+        {
+            g.setColour(juce::Colours::darkslategrey);
+            g.fillRect(x, juce::jmax(area.getY(), area.getBottom() - heightFor(markerDb, barHeight) - 1), w, 2);
+        }
+
+        if (readings[ch].clipped)
+        {
+            g.setColour(juce::Colours::red);
+            g.fillRect(x, area.getY(), w, 4);
+        }
+
+        if (ch % labelEvery == 0)
+        {
+            g.setColour(juce::Colours::darkslategrey);
+            g.drawText(juce::String(ch + 1), x - 10, labels.getY(), w + 20, labelHeight, juce::Justification::centred, false);
+        }
+    }
+
+    if (skippedBlocks > 0)
+    {
+        g.setColour(juce::Colours::darkred);
+        g.drawText(juce::String(skippedBlocks) + (skippedBlocks == 1 ? " block skipped" : " blocks skipped"),
+                   area.removeFromTop(labelHeight), juce::Justification::topRight, false);
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <JuceHeader.h>
+#include "MeterBridge.h"
+
+//One bar per input channel for the MeterBridge readings. The metric follows the
+//main meter mode: RMS with sample-peak hold, short-term loudness with a momentary
+//marker, or true peak with its hold. Clip indicators latch until the meters reset;
+//so does the count of blocks the bridge only scanned for peaks because it was busy.
+class MeterBridgeView : public juce::Component
+{
+public:
+    enum class Metric { level, loudness, truePeak };
+
+    MeterBridgeView();
+    ~MeterBridgeView() override;
+
+    void paint(juce::Graphics& g) override;
+
+    void setMetric(Metric newMetric);
+    void setSnapshot(const MeterBridge::Snapshot& snapshot); //repaints only when a bar or marker moves
+    void clear();
+
+private:
+    //Bar and marker levels (dB / LUFS) of one channel for the current metric
+    std::pair<float, float> valuesFor(const MeterBridge::ChannelReading& r) const;
+    int heightFor(float db, int barHeight) const;
+
+    Metric metric = Metric::level;
+    int numChannels = 0;
+    int skippedBlocks = 0;
+    MeterBridge::ChannelReading readings[MeterBridge::maxChannels];
+
+    static constexpr float minDb = -60.0f, maxDb = 0.0f;
+    static constexpr int labelHeight = 14;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MeterBridgeView)
+};
@@ -0,0 +1,188 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstring>
+#include "MeterSnapshot.h"
+#include "resonance_meters.h"
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+ #define RESONANCE_METER_EXPORT 1
+ #include <cerrno>
+ #include <fcntl.h>
+ #include <signal.h>
+ #include <sys/mman.h>
+ #include <unistd.h>
+#else
+ #define RESONANCE_METER_EXPORT 0
+#endif
+
+//Publishes every MeterSnapshot into a POSIX shared memory object so other processes
+//(automation, loggers, a second UI) can poll the meters without any IPC round trip.
+//The layout and the reader side are in resonance_meters.h.
+//
+//open()/close() run on the message thread and make the only syscalls; publish() runs
+//on the audio thread and only writes mapped memory under a sequence lock. The mapping
+//stays valid until destruction, so close the audio callback first.
+//Unsupported platforms (Windows) compile to no-ops.
+class MeterExport
+{
+public:
+    ~MeterExport() { close(); }
+
+    //Creates the shared memory object, or takes over one whose writer has exited, and
+    //starts publishing. The sequence lock allows one writer, so while another process
+    //(a second Resonance) is writing the object this fails and leaves it untouched;
+    //getLastError() says why.
+    bool open(const char* name = RESONANCE_METERS_SHM_NAME)
+    {
+       #if RESONANCE_METER_EXPORT
+        if (shm != nullptr)
+            return true;
+
+        bool created = true;
+        int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd < 0 && errno == EEXIST)
+        {
+            created = false;
+            fd = shm_open(name, O_RDWR, 0644);
+        }
+        if (fd < 0)
+        {
+            lastError = "could not create shared memory " + juce::String(name);
+            return false;
+        }
+
+        void* mapped = ftruncate(fd, (off_t)sizeof(resonance_meters_shm)) == 0
+            ? mmap(nullptr, sizeof(resonance_meters_shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)
+            : MAP_FAILED;
+        ::close(fd);
+
+        if (mapped == MAP_FAILED)
+        {
+            if (created)
+                shm_unlink(name);
+            lastError = "could not map shared memory " + juce::String(name);
+            return false;
+        }
+
+        //Claim the writer slot: a new object has no writer yet, an existing one is only
+        //taken over from a process that no longer runs. The compare-and-swap keeps two
+        //instances starting together from both winning.
+        auto* s = static_cast<resonance_meters_shm*>(mapped);
+        uint32_t writer = __atomic_load_n(&s->writer_pid, __ATOMIC_ACQUIRE);
+        const bool writerAlive = writer != 0 && (kill((pid_t)writer, 0) == 0 || errno != ESRCH);
+        if (writerAlive || !__atomic_compare_exchange_n(&s->writer_pid, &writer, (uint32_t)getpid(),
+                                                        false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            munmap(mapped, sizeof(resonance_meters_shm));
+            lastError = juce::String(name) + " is already exported by process " + juce::String((int)writer);
+            return false;
+        }
+
+        //Invalidate the header while it is rewritten, in case a reader maps it now
+        __atomic_store_n(&s->magic, 0u, __ATOMIC_RELEASE);
+        std::memset(&s->data, 0, sizeof(s->data));
+        s->version = RESONANCE_METERS_VERSION;
+        s->size = (uint32_t)sizeof(resonance_meters_shm);
+        s->data.num_channels = RESONANCE_METERS_CHANNELS;
+        __atomic_store_n(&s->sequence, 0u, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->flags, 0u, __ATOMIC_RELAXED);
+        __atomic_store_n(&s->magic, RESONANCE_METERS_MAGIC, __ATOMIC_RELEASE);
+
+        shmName = name;
+        lastError = {};
+        shm = s;
+        return true;
+       #else
+        juce::ignoreUnused(name);
+        lastError = "not supported on this platform";
+        return false;
+       #endif
+    }
+
+    //Stops publishing, clears the active flag for mapped readers and removes the name
+    //(this instance is its only writer)
+    void close()
+    {
+       #if RESONANCE_METER_EXPORT
+        if (shm == nullptr)
+            return;
+
+        enabled.store(false);
+        __atomic_store_n(&shm->flags, 0u, __ATOMIC_RELEASE);
+        munmap(shm, sizeof(resonance_meters_shm));
+        shm_unlink(shmName.toRawUTF8());
+        shm = nullptr;
+       #endif
+    }
+
+    bool isOpen() const noexcept { return shm != nullptr; }
+    juce::String getName() const { return shmName; }
+
+    //Why the last open() failed (empty after a successful one)
+    juce::String getLastError() const { return lastError; }
+
+    //Any thread. Readers see the active flag drop while disabled.
+    void setEnabled(bool shouldPublish) noexcept
+    {
+        enabled.store(shouldPublish && shm != nullptr);
+       #if RESONANCE_METER_EXPORT
+        if (shm != nullptr)
+            __atomic_store_n(&shm->flags, shouldPublish ? RESONANCE_METERS_FLAG_ACTIVE : 0u, __ATOMIC_RELEASE);
+       #endif
+    }
+
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    void setSampleRate(double newSampleRate) noexcept { sampleRate = newSampleRate; }
+
+    //Audio thread, once per analysed block: no syscalls (the wall clock is read through the vDSO)
+    void publish(const MeterSnapshot& snap, int numSamples) noexcept
+    {
+        samplePosition += (uint64_t)juce::jmax(0, numSamples);
+       #if RESONANCE_METER_EXPORT
+        if (!enabled.load(std::memory_order_relaxed))
+            return;
+
+        auto& d = shm->data;
+        const uint32_t seq = __atomic_load_n(&shm->sequence, __ATOMIC_RELAXED);
+        __atomic_store_n(&shm->sequence, seq + 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+
+        d.update_count = ++updateCount;
+        d.sample_position = samplePosition;
+        d.time_ms = (int64_t)juce::Time::currentTimeMillis();
+        d.sample_rate = sampleRate;
+        d.lufs_momentary = snap.lufsMomentary;
+        d.lufs_short_term = snap.lufsShortTerm;
+        d.lufs_integrated = snap.lufsIntegrated;
+        d.lufs_range = snap.lufsRange;
+        d.have_true_peak = snap.haveTruePeak ? 1u : 0u;
+        d.num_channels = RESONANCE_METERS_CHANNELS;
+
+        static_assert(MeterSnapshot::numChannels == RESONANCE_METERS_CHANNELS, "shared layout is stereo");
+        for (int ch = 0; ch < MeterSnapshot::numChannels; ++ch)
+        {
+            auto& out = d.channel[ch];
+            out.level_db = snap.level[ch].levelDb;
+            out.peak_hold_db = snap.level[ch].peakHoldDb;
+            out.true_peak_db = snap.truePeak[ch].levelDb;
+            out.true_peak_hold_db = snap.truePeak[ch].peakHoldDb;
+            out.clipped = snap.level[ch].clipped ? 1u : 0u;
+        }
+
+        __atomic_store_n(&shm->sequence, seq + 2, __ATOMIC_RELEASE);
+       #else
+        juce::ignoreUnused(snap);
+       #endif
+    }
+
+private:
+    resonance_meters_shm* shm = nullptr;
+    juce::String shmName, lastError;
+    std::atomic<bool> enabled{ false };
+
+    //Audio thread
+    double sampleRate = 0.0;
+    uint64_t updateCount = 0, samplePosition = 0;
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include "MeterBallistics.h"
+
+//Everything the meters display, written once per audio callback and handed to
+//the UI timer through a TripleBuffer (no locks, no allocation, no callAsync).
+//Levels are in dB / LUFS, floored at -100; meter bars carry their ballistic state.
+
+struct MeterSnapshot
+{
+    static constexpr int numChannels = 2;
+
+    MeterReading level[numChannels];      // VU bar with sample-peak hold; clip latched until reset
+    MeterReading truePeak[numChannels];   // PPM on the oversampled signal with true-peak hold
+
+    float lufsMomentary  = -100.0f;
+    float lufsShortTerm  = -100.0f;
+    float lufsIntegrated = -100.0f;
+    float lufsRange      = 0.0f;     // loudness range (LU)
+
+    bool haveTruePeak = false;   // true-peak detection only runs while its meters are showing
+};
\ No newline at end of file
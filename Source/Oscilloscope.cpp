@@ -1,71 +1,187 @@
 #include "Oscilloscope.h"
+#include "RealtimeSanitizer.h"
 
 Oscilloscope::Oscilloscope()
-    : samplePointer(0)
+    : VisualizerComponent("oscilloscope")
 {
-    audioHistory.resize(maxHistorySize, 0.0f); //size our buffer and fill with 0s
+    audioHistory.resize(rawCapacity, 0.0f); //size our buffers and fill with 0s
+
+    int samplesPerBin = 1;
+    for (auto& level : levels)
+    {
+        samplesPerBin *= envelopeRatio;
+        level.samplesPerBin = samplesPerBin;
+        level.mins.resize(envelopeCapacity, 0.0f);
+        level.maxs.resize(envelopeCapacity, 0.0f);
+    }
 
     setOpaque(true); //skip the redraw of any components beneath this one
 }
 
 Oscilloscope::~Oscilloscope()
 {
+    stopRendering();
 }
 
-void Oscilloscope::paint(juce::Graphics& g)
+void Oscilloscope::renderFrame(juce::Graphics& g, juce::Rectangle<int> bounds)
 {
     g.fillAll(juce::Colours::lightgrey);  //background
 
     g.setColour(juce::Colours::lightslategrey);  //border
-    g.drawRect(getLocalBounds(), 1);    //draw the border
+    g.drawRect(bounds, 1);    //draw the border
 
-    g.setColour(juce::Colours::lightslategrey); //waveform
+    const int width = bounds.getWidth();
+    const float centerY = bounds.getHeight() / 2.0f;
+    const float gainFactor = bounds.getHeight() / 2.0f * 0.9f; //determines how much the waveform will scale
 
-    const float centerY = getHeight() / 2.0f;
-    const float gainFactor = getHeight() / 2.0f * 0.9f; //determines how much the waveform will scale 
+    if (width <= 0) return;
 
-    juce::Path waveformPath; // used to store the points of the audio waveform as a series of connected lines.
-                             //The waveform is constructed by iterating through the audioHistory buffer and adding points to the waveformPath
+    const double timebase = getTimebase();
+    const bool triggerActive = triggerEnabled.load() && timebase <= triggerMaxTimebase;
 
-    bool pathStarted = false; //ensures that the first point of the waveform is added using startNewSubPath while subsequent points are connected using lineTo
+    //Level of detail: fewer envelope columns / raw vertices, and no anti-aliasing at the coarsest level
+    const int detail = getDetailLevel();
+    const int columnStep = 1 << juce::jmin(detail, 2); //pixels per envelope column, samples per raw vertex
+    const bool lowDetail = detail >= maxDetailLevel;
+    const int numColumns = (width + columnStep - 1) / columnStep;
 
-    const juce::ScopedReadLock readLock(lock);
+    bool drawEnvelope = false;
+    bool drawSamples = false;
 
-    //iterate through all the samples in our buffer 
-    for (int i = 0; i < maxHistorySize; ++i)
     {
-        float x = (float)i / maxHistorySize * getWidth(); //we normalize the sample index to a value between 0.0 and 1.0 and scale it to the width of the oscilloscope
-        float y = centerY - audioHistory[(i + samplePointer) % maxHistorySize] * gainFactor; 
-        //Adding i and samplePointer ensures the loop starts at the oldest sample, the modulo ensures we wrap around the buffer
-        //we subract to center and multiply to scale 
+        const juce::ScopedReadLock readLock(lock);
+
+        const juce::int64 span = juce::jmax((juce::int64)1, (juce::int64)std::llround(timebase * sampleRate));
+        juce::int64 end = samplesWritten;
+        juce::int64 start = end - span;
+
+        //Lock onto the latest rising zero crossing that still leaves a full span after it
+        if (triggerActive)
+        {
+            const juce::int64 trigger = findTrigger(start - span, start);
+            if (trigger >= 0)
+            {
+                start = trigger;
+                end = trigger + span;
+            }
+        }
+
+        const double samplesPerPixel = (double)span / width;
 
-        if (!pathStarted)
+        if (samplesPerPixel <= 1.0)
         {
-            waveformPath.startNewSubPath(x, y);
-            pathStarted = true;
+            trace.begin(g, bounds.toFloat(), 1.5f, lowDetail);
+            drawSamples = true;
+
+            //Fewer samples than pixels: one vertex per sample
+            const juce::int64 oldest = juce::jmax(start, samplesWritten - rawCapacity, (juce::int64)0);
+            bool pathStarted = false;
+
+            for (juce::int64 n = oldest; n < end; n += columnStep)
+            {
+                const float x = (float)((double)(n - start) / (double)span * width);
+                const float y = centerY - audioHistory[(size_t)(n % rawCapacity)] * gainFactor;
+
+                if (!pathStarted) { trace.startNewSubPath(x, y); pathStarted = true; }
+                else              trace.lineTo(x, y);
+            }
         }
         else
         {
-            waveformPath.lineTo(x, y);
+            //More samples than pixels: min/max per column from the coarsest source that still resolves it
+            const double samplesPerColumn = (double)span / numColumns;
+            columnMin.resize((size_t)numColumns);
+            columnMax.resize((size_t)numColumns);
+
+            for (int col = 0; col < numColumns; ++col)
+            {
+                const juce::int64 colStart = start + (juce::int64)(col * samplesPerColumn);
+                const juce::int64 colEnd = juce::jmax(colStart + 1, start + (juce::int64)((col + 1) * samplesPerColumn));
+
+                float lo = 0.0f, hi = 0.0f;
+                readRange(colStart, colEnd, samplesPerColumn, lo, hi);
+                columnMin[(size_t)col] = lo;
+                columnMax[(size_t)col] = hi;
+            }
+
+            drawEnvelope = true;
         }
     }
 
-    g.strokePath(waveformPath, juce::PathStrokeType(1.5f)); //draw the waveform
+    if (drawEnvelope)
+    {
+        //Two vertices per column: down to the minimum, back up to the maximum
+        trace.begin(g, bounds.toFloat(), 1.0f, lowDetail);
+        trace.startNewSubPath(0.5f * columnStep, centerY - columnMax[0] * gainFactor);
+        for (int col = 0; col < numColumns; ++col)
+        {
+            const float x = ((float)col + 0.5f) * columnStep;
+            trace.lineTo(x, centerY - columnMax[(size_t)col] * gainFactor);
+            trace.lineTo(x, centerY - columnMin[(size_t)col] * gainFactor);
+        }
+    }
+
+    if (drawEnvelope || drawSamples)
+        trace.finish(g, juce::Colours::lightslategrey); //draw the waveform
 
     //Draw center line
     g.setColour(juce::Colours::lightslategrey);
-    g.drawHorizontalLine(getHeight() / 2, 0.0f, (float)getWidth());
+    g.drawHorizontalLine(bounds.getHeight() / 2, 0.0f, (float)bounds.getWidth());
+
+    //Timebase readout
+    const juce::String spanText = timebase < 1.0 ? juce::String(juce::roundToInt(timebase * 1000.0)) + " ms"
+                                                 : juce::String(juce::roundToInt(timebase)) + " s";
+    g.setColour(juce::Colours::darkslategrey);
+    g.setFont(12.0f);
+    g.drawText(spanText + (triggerActive ? "  trig" : ""), bounds.reduced(6, 4),
+        juce::Justification::topLeft);
+}
+
+void Oscilloscope::mouseWheelMove(const juce::MouseEvent&, const juce::MouseWheelDetails& wheel)
+{
+    //Wheel up zooms in (shorter span), wheel down zooms out
+    if (wheel.deltaY == 0.0f) return;
+
+    const int step = wheel.deltaY > 0.0f ? -1 : 1;
+    timebaseIndex.store(juce::jlimit(0, numTimebases - 1, timebaseIndex.load() + step));
+    requestFrame();
+}
+
+void Oscilloscope::mouseDoubleClick(const juce::MouseEvent&)
+{
+    setTriggerEnabled(!triggerEnabled.load());
+}
+
+void Oscilloscope::setSampleRate(double sr)
+{
+    const juce::ScopedWriteLock writeLock(lock);
+    sampleRate = sr > 0.0 ? sr : 44100.0;
+}
+
+void Oscilloscope::setTimebase(double seconds)
+{
+    //Nearest step on a log scale
+    int best = 0;
+    for (int i = 1; i < numTimebases; ++i)
+        if (std::abs(std::log(timebases[i] / seconds)) < std::abs(std::log(timebases[best] / seconds)))
+            best = i;
+
+    timebaseIndex.store(best);
+    requestFrame();
 }
 
-void Oscilloscope::resized()
+void Oscilloscope::setTriggerEnabled(bool shouldTrigger)
 {
+    triggerEnabled.store(shouldTrigger);
+    requestFrame();
 }
 
 void Oscilloscope::pushSamples(const juce::AudioBuffer<float>& buffer)
 {
+    RESONANCE_RT_BLOCKING("ReadWriteLock::enterWrite");
     const juce::ScopedWriteLock writeLock(lock);
 
-    //get num of channels and samples for the input 
+    //get num of channels and samples for the input
     int numChannels = buffer.getNumChannels();
     int numSamples = buffer.getNumSamples();
 
@@ -80,22 +196,157 @@ void Oscilloscope::pushSamples(const juce::AudioBuffer<float>& buffer)
             sum += buffer.getSample(channel, sampleIdx);
         }
 
-        //calculate  and store in the buffer
-        float average = numChannels > 0 ? sum / numChannels : 0.0f;
-
-        audioHistory[samplePointer] = average;
-        samplePointer = (samplePointer + 1) % maxHistorySize;
+        //calculate and store in the buffers
+        addSample(numChannels > 0 ? sum / numChannels : 0.0f);
     }
 
-    //Request a repaint to show the new data
-    //triggers the paint method 
-    juce::MessageManager::callAsync([this]() { repaint(); }); 
+    silentSamples = 0;
+
+    //Ask the render thread for a new frame showing the new data
+    requestFrame();
+}
+
+void Oscilloscope::advance(int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    RESONANCE_RT_BLOCKING("ReadWriteLock::enterWrite");
+    const juce::ScopedWriteLock writeLock(lock);
+
+    const auto longestSpan = (juce::int64)std::ceil(timebases[numTimebases - 1] * sampleRate);
+    if (silentSamples >= longestSpan)
+        return;
+
+    silentSamples += numSamples;
+    for (int i = 0; i < numSamples; ++i)
+        addSample(0.0f);
+
+    requestFrame();
 }
 
 void Oscilloscope::clear()
 {
     const juce::ScopedWriteLock writeLock(lock);
     std::fill(audioHistory.begin(), audioHistory.end(), 0.0f);
-    samplePointer = 0;
-    repaint();
+    samplesWritten = 0;
+
+    for (auto& level : levels)
+    {
+        level.numBins = 0;
+        level.accCount = 0;
+    }
+
+    requestFrame();
+}
+
+//==============================================================================
+void Oscilloscope::addSample(float x)
+{
+    audioHistory[(size_t)(samplesWritten % rawCapacity)] = x;
+    ++samplesWritten;
+
+    addToLevel(0, x, x);
+}
+
+void Oscilloscope::addToLevel(int levelIdx, float lo, float hi)
+{
+    auto& level = levels[levelIdx];
+
+    if (level.accCount == 0)
+    {
+        level.accMin = lo;
+        level.accMax = hi;
+    }
+    else
+    {
+        level.accMin = juce::jmin(level.accMin, lo);
+        level.accMax = juce::jmax(level.accMax, hi);
+    }
+
+    if (++level.accCount < envelopeRatio) return;
+
+    //Bin complete: store it and fold it into the next coarser level
+    const size_t idx = (size_t)(level.numBins % envelopeCapacity);
+    level.mins[idx] = level.accMin;
+    level.maxs[idx] = level.accMax;
+    ++level.numBins;
+    level.accCount = 0;
+
+    if (levelIdx + 1 < numEnvelopeLevels)
+        addToLevel(levelIdx + 1, level.accMin, level.accMax);
+}
+
+juce::int64 Oscilloscope::findTrigger(juce::int64 searchStart, juce::int64 searchEnd) const
+{
+    searchStart = juce::jmax(searchStart, samplesWritten - rawCapacity, (juce::int64)0);
+
+    //Arm below -hysteresis, fire on the next sample at or above zero; keep the latest
+    juce::int64 trigger = -1;
+    bool armed = false;
+
+    for (juce::int64 n = searchStart; n < searchEnd; ++n)
+    {
+        const float x = audioHistory[(size_t)(n % rawCapacity)];
+
+        if (x < -triggerHysteresis)
+            armed = true;
+        else if (armed && x >= 0.0f)
+        {
+            trigger = n;
+            armed = false;
+        }
+    }
+
+    return trigger;
+}
+
+bool Oscilloscope::readRange(juce::int64 start, juce::int64 end, double samplesPerPixel, float& lo, float& hi) const
+{
+    end = juce::jmin(end, samplesWritten);
+    start = juce::jmax(start, (juce::int64)0);
+    if (start >= end) return false;
+
+    //Raw samples while a column spans only a handful of them
+    if (samplesPerPixel < rawMaxSamplesPerPixel && start >= samplesWritten - rawCapacity)
+    {
+        lo = hi = audioHistory[(size_t)(start % rawCapacity)];
+        for (juce::int64 n = start + 1; n < end; ++n)
+        {
+            const float x = audioHistory[(size_t)(n % rawCapacity)];
+            lo = juce::jmin(lo, x);
+            hi = juce::jmax(hi, x);
+        }
+        return true;
+    }
+
+    //Finest envelope level whose bins are no wider than a column and which still holds this range
+    int levelIdx = 0;
+    while (levelIdx + 1 < numEnvelopeLevels
+           && (levels[levelIdx + 1].samplesPerBin <= samplesPerPixel
+               || start < (levels[levelIdx].numBins - envelopeCapacity) * levels[levelIdx].samplesPerBin))
+        ++levelIdx;
+
+    const auto& level = levels[levelIdx];
+    const juce::int64 firstBin = juce::jmax(start / level.samplesPerBin, level.numBins - envelopeCapacity);
+    const juce::int64 lastBin = juce::jmin((end - 1) / level.samplesPerBin, level.numBins - 1);
+
+    bool found = false;
+    for (juce::int64 b = firstBin; b <= lastBin; ++b)
+    {
+        const size_t idx = (size_t)(b % envelopeCapacity);
+        lo = found ? juce::jmin(lo, level.mins[idx]) : level.mins[idx];
+        hi = found ? juce::jmax(hi, level.maxs[idx]) : level.maxs[idx];
+        found = true;
+    }
+
+    //Newest samples are still accumulating in the open bin
+    if (end > level.numBins * level.samplesPerBin && level.accCount > 0)
+    {
+        lo = found ? juce::jmin(lo, level.accMin) : level.accMin;
+        hi = found ? juce::jmax(hi, level.accMax) : level.accMax;
+        found = true;
+    }
+
+    return found;
 }
\ No newline at end of file
@@ -1,24 +1,92 @@
 #pragma once
 #include <JuceHeader.h>
 
-class Oscilloscope : public juce::Component
+#include "TraceRenderer.h"
+#include "VisualizerComponent.h"
+
+//Scrolling oscilloscope with a selectable timebase (1 ms .. 10 s).
+//Incoming samples are kept in a raw ring for short timebases and folded into
+//min/max envelope levels as they arrive, so any timebase renders from at most
+//2 x width vertices and history memory stays fixed regardless of sample rate.
+
+class Oscilloscope : public VisualizerComponent
 {
 public:
     Oscilloscope();
     ~Oscilloscope() override;
 
-    void paint(juce::Graphics& g) override;
-    void resized() override;
+    void mouseWheelMove(const juce::MouseEvent&, const juce::MouseWheelDetails& wheel) override;
+    void mouseDoubleClick(const juce::MouseEvent&) override;
+
+    void pushSamples(const juce::AudioBuffer<float>& buffer); //for pushing samples to the circular buffer
 
-    void pushSamples(const juce::AudioBuffer<float>& buffer); //for pushing samples to the circular buffer 
+    //Audio thread, for blocks that are not pushed (activity gate, load shedding): appends
+    //silence so old signal scrolls off as it would live instead of freezing on screen.
+    //Does nothing once the longest timebase shows only silence.
+    void advance(int numSamples);
 
     void clear();
 
+    void setSampleRate(double sr);
+
+    //Visible time span in seconds, snapped to the nearest 1-2-5 step
+    void setTimebase(double seconds);
+    double getTimebase() const { return timebases[timebaseIndex.load()]; }
+
+    //Rising zero-crossing trigger (with hysteresis) for short timebases
+    void setTriggerEnabled(bool shouldTrigger);
+    bool isTriggerEnabled() const { return triggerEnabled.load(); }
+
+    //Path stroking (quality) or direct-to-bitmap rasterizing (speed)
+    void setTraceMode(TraceRenderer::Mode mode) { trace.setMode(mode); requestFrame(); }
+
 private:
-    static constexpr int maxHistorySize = 2048; //How many samples the oscilloscope can store and display at once.
-    std::vector<float> audioHistory; //circular buffer for the audio samples
-    int samplePointer; //curent pos of the circular buffer, points to the oldest sample 
-    juce::ReadWriteLock lock; //Thread safety for accessing the buffer
+    //Raw ring: newest samples at full rate, used directly below rawMaxSamplesPerPixel
+    static constexpr int rawCapacity = 1 << 17;
+    static constexpr int rawMaxSamplesPerPixel = 16;
+
+    //Envelope levels: each bin folds envelopeRatio bins of the level below it
+    static constexpr int numEnvelopeLevels = 3;
+    static constexpr int envelopeRatio = 16;     //1 bin = 16, 256, 4096 samples
+    static constexpr int envelopeCapacity = 1 << 14;
+
+    static constexpr double triggerMaxTimebase = 0.2; //longer spans free-run
+    static constexpr float triggerHysteresis = 0.01f;
+
+    static constexpr double timebases[] = { 0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5,
+                                            1.0, 2.0, 5.0, 10.0 };
+    static constexpr int numTimebases = (int)(sizeof(timebases) / sizeof(timebases[0]));
+
+    struct EnvelopeLevel
+    {
+        int samplesPerBin = 1;
+        std::vector<float> mins, maxs;   //circular, envelopeCapacity
+        juce::int64 numBins = 0;         //total bins completed
+        float accMin = 0.0f, accMax = 0.0f;
+        int accCount = 0;
+    };
+
+    std::vector<float> audioHistory; //raw circular buffer for the audio samples
+    juce::int64 samplesWritten = 0;  //total samples pushed; the newest one is samplesWritten - 1
+    juce::int64 silentSamples = 0;   //audio thread: silence appended by advance() since the last push
+    EnvelopeLevel levels[numEnvelopeLevels];
+    juce::ReadWriteLock lock; //Thread safety for accessing the buffers
+
+    double sampleRate = 44100.0;
+    std::atomic<int> timebaseIndex{ 3 };    //10 ms
+    std::atomic<bool> triggerEnabled{ true };
+
+    //Per-column envelope and trace renderer (render thread only)
+    std::vector<float> columnMin, columnMax;
+    TraceRenderer trace;
+
+    void renderFrame(juce::Graphics& g, juce::Rectangle<int> bounds) override;
+
+    void addSample(float x);
+    void addToLevel(int levelIdx, float lo, float hi);
+
+    juce::int64 findTrigger(juce::int64 searchStart, juce::int64 searchEnd) const;
+    bool readRange(juce::int64 start, juce::int64 end, double samplesPerPixel, float& lo, float& hi) const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Oscilloscope)
 };
\ No newline at end of file
@@ -0,0 +1,245 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+
+#include "SampleFifo.h"
+#include "SpectrumAnalyzer.h"
+#include "TraceRecorder.h"
+
+//Monophonic pitch tracker (McLeod pitch method). The audio thread only downmixes
+//and queues samples; a worker thread builds the normalised square difference
+//function from an FFT autocorrelation (O(N log N) per frame instead of O(N^2))
+//and publishes frequency/clarity as atomics for the UI to poll.
+
+class PitchTracker : private juce::Thread
+{
+public:
+    explicit PitchTracker(int frameOrder = 12)
+        : juce::Thread("Pitch tracker"),
+        frameSize(1 << frameOrder),
+        hopSize(frameSize / 4),
+        fft(frameOrder + 1) //zero-padded to 2N so the autocorrelation is linear, not circular
+    {
+        fifo.prepare(1, 8 * frameSize);
+        popBuffer.resize(hopSize, 0.0f);
+        history.resize(frameSize, 0.0f);
+        frame.resize(frameSize, 0.0f);
+        fftBuffer.resize(4 * frameSize, 0.0f);
+        nsdf.resize(frameSize / 2, 0.0f);
+        keyMaxima.resize(frameSize / 2, 0);
+
+        startThread();
+    }
+
+    ~PitchTracker() override { stopThread(2000); }
+
+    void setSampleRate(double sr)
+    {
+        sampleRate.store(sr > 0.0 ? sr : 44100.0);
+        resetRequested.store(true);
+    }
+
+    //Audio thread: downmix + FIFO copy only
+    void pushSamples(const juce::AudioBuffer<float>& buffer)
+    {
+        const int numSmps = buffer.getNumSamples();
+        float mono[SpectrumAnalyzer::monoChunkSize];
+        const float* channels[1] = { mono };
+
+        for (int start = 0; start < numSmps; start += SpectrumAnalyzer::monoChunkSize)
+        {
+            const int n = juce::jmin(SpectrumAnalyzer::monoChunkSize, numSmps - start);
+            SpectrumAnalyzer::mixToMono(buffer, start, n, mono);
+            fifo.push(channels, n);
+        }
+    }
+
+    void clear()
+    {
+        resetRequested.store(true);
+        frequencyHz.store(0.0f);
+        clarity.store(0.0f);
+    }
+
+    //Latest estimate (0 Hz when there is no clear pitch) and its NSDF peak height (0..1)
+    float getFrequency() const noexcept { return frequencyHz.load(std::memory_order_relaxed); }
+    float getClarity() const noexcept { return clarity.load(std::memory_order_relaxed); }
+
+    //Nearest note name + cents offset, e.g. "A4 +3c"
+    static juce::String describePitch(float hz)
+    {
+        if (hz <= 0.0f) return "--";
+
+        static const char* const names[] = { "C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B" };
+        const float midi = 69.0f + 12.0f * std::log2(hz / 440.0f);
+        const int note = juce::roundToInt(midi);
+        const int cents = juce::roundToInt((midi - (float)note) * 100.0f);
+        const int octave = (note / 12) - 1;
+
+        return juce::String(names[((note % 12) + 12) % 12]) + juce::String(octave)
+            + " " + (cents >= 0 ? "+" : "") + juce::String(cents) + "c";
+    }
+
+private:
+    const int frameSize;
+    const int hopSize;
+    juce::dsp::FFT fft;
+
+    SampleFifo fifo;
+    std::atomic<double> sampleRate{ 44100.0 };
+    std::atomic<bool> resetRequested{ false };
+    std::atomic<float> frequencyHz{ 0.0f };
+    std::atomic<float> clarity{ 0.0f };
+
+    //Worker state
+    std::vector<float> popBuffer;
+    std::vector<float> history;     // circular, frameSize
+    std::vector<float> frame;       // unwrapped analysis frame
+    std::vector<float> fftBuffer;   // 2 * (2 * frameSize) for the real-only transform
+    std::vector<float> nsdf;        // lags 0..frameSize/2
+    std::vector<int>   keyMaxima;
+    int writePos = 0;
+    int filled = 0;
+    int samplesSinceFrame = 0;
+
+    static constexpr float silenceMeanSquare = 1.0e-7f; // ~ -70 dBFS
+    static constexpr float keyThreshold = 0.9f;         // of the highest key maximum
+    static constexpr float minClarity = 0.6f;
+
+    void run() override
+    {
+        float* dest[1] = { popBuffer.data() };
+        TraceRecorder::getInstance().nameCurrentThread("pitch tracker");
+
+        while (!threadShouldExit())
+        {
+            if (resetRequested.exchange(false))
+            {
+                fifo.drain();
+                std::fill(history.begin(), history.end(), 0.0f);
+                writePos = filled = samplesSinceFrame = 0;
+            }
+
+            const int got = fifo.pop(dest, hopSize);
+            if (got == 0)
+            {
+                wait(5);
+                continue;
+            }
+
+            for (int i = 0; i < got; ++i)
+            {
+                history[writePos] = popBuffer[i];
+                writePos = (writePos + 1) % frameSize;
+                filled = juce::jmin(filled + 1, frameSize);
+
+                if (++samplesSinceFrame >= hopSize && filled == frameSize)
+                {
+                    samplesSinceFrame = 0;
+                    RESONANCE_TRACE_SCOPE("pitch frame", "analysis");
+                    analyseFrame();
+                }
+            }
+        }
+    }
+
+    void publish(float hz, float c)
+    {
+        frequencyHz.store(hz, std::memory_order_relaxed);
+        clarity.store(c, std::memory_order_relaxed);
+    }
+
+    void analyseFrame()
+    {
+        //Oldest sample first
+        for (int i = 0; i < frameSize; ++i)
+            frame[i] = history[(writePos + i) % frameSize];
+
+        double energy = 0.0;
+        for (float x : frame) energy += (double)x * x;
+
+        if (energy / frameSize < silenceMeanSquare) { publish(0.0f, 0.0f); return; }
+
+        //Autocorrelation r(tau) = IFFT(|FFT(x)|^2), zero-padded to 2N
+        const int paddedSize = 2 * frameSize;
+        std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+        std::copy(frame.begin(), frame.end(), fftBuffer.begin());
+
+        fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
+        for (int k = 0; k <= paddedSize / 2; ++k)
+        {
+            const float re = fftBuffer[2 * k];
+            const float im = fftBuffer[2 * k + 1];
+            fftBuffer[2 * k] = re * re + im * im;
+            fftBuffer[2 * k + 1] = 0.0f;
+        }
+        fft.performRealOnlyInverseTransform(fftBuffer.data());
+
+        //r(0) must equal the frame energy, which fixes whatever scaling the inverse applied
+        if (fftBuffer[0] <= 0.0f) { publish(0.0f, 0.0f); return; }
+        const double scale = energy / (double)fftBuffer[0];
+
+        //NSDF n(tau) = 2 r(tau) / m(tau), with m(tau) = sum x_j^2 + x_{j+tau}^2 updated incrementally
+        const int maxLag = frameSize / 2;
+        double m = 2.0 * energy;
+        for (int tau = 0; tau < maxLag; ++tau)
+        {
+            if (tau > 0)
+                m -= (double)frame[tau - 1] * frame[tau - 1]
+                   + (double)frame[frameSize - tau] * frame[frameSize - tau];
+
+            nsdf[tau] = m > 0.0 ? (float)(2.0 * fftBuffer[tau] * scale / m) : 0.0f;
+        }
+
+        //Key maxima: highest point of each positive lobe after the lag-0 lobe
+        int numKeys = 0;
+        int tau = 1;
+        while (tau < maxLag && nsdf[tau] > 0.0f) ++tau;
+
+        while (tau < maxLag)
+        {
+            while (tau < maxLag && nsdf[tau] <= 0.0f) ++tau;
+            if (tau >= maxLag) break;
+
+            int best = tau;
+            while (tau < maxLag && nsdf[tau] > 0.0f)
+            {
+                if (nsdf[tau] > nsdf[best]) best = tau;
+                ++tau;
+            }
+            keyMaxima[numKeys++] = best;
+        }
+
+        if (numKeys == 0) { publish(0.0f, 0.0f); return; }
+
+        float highest = 0.0f;
+        for (int k = 0; k < numKeys; ++k) highest = juce::jmax(highest, nsdf[keyMaxima[k]]);
+
+        //First key maximum close enough to the highest one gives the period
+        int chosen = keyMaxima[0];
+        for (int k = 0; k < numKeys; ++k)
+            if (nsdf[keyMaxima[k]] >= keyThreshold * highest) { chosen = keyMaxima[k]; break; }
+
+        //Parabolic interpolation around the chosen lag
+        float period = (float)chosen;
+        float peak = nsdf[chosen];
+        if (chosen > 0 && chosen < maxLag - 1)
+        {
+            const float a = nsdf[chosen - 1], b = nsdf[chosen], c = nsdf[chosen + 1];
+            const float denom = a - 2.0f * b + c;
+            if (denom != 0.0f)
+            {
+                const float delta = 0.5f * (a - c) / denom;
+                period += delta;
+                peak = b - 0.25f * (a - c) * delta;
+            }
+        }
+
+        if (peak < minClarity || period <= 0.0f) { publish(0.0f, juce::jmax(0.0f, peak)); return; }
+
+        publish((float)(sampleRate.load() / (double)period), juce::jmin(1.0f, peak));
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PitchTracker)
+};
@@ -0,0 +1,75 @@
+#include "ProfilerOverlay.h"
+
+ProfilerOverlay::ProfilerOverlay(const CallbackProfiler& profilerIn, const LoadShedder& loadShedderIn)
+    : profiler(profilerIn), loadShedder(loadShedderIn)
+{
+    setInterceptsMouseClicks(false, false);
+    startTimerHz(4);
+}
+
+ProfilerOverlay::~ProfilerOverlay()
+{
+    stopTimer();
+}
+
+int ProfilerOverlay::getPreferredHeight()
+{
+    //header + stages + budget + shedding, with a little padding
+    return (CallbackProfiler::numStages + 3) * rowHeight + 8;
+}
+
+void ProfilerOverlay::paint(juce::Graphics& g)
+{
+    auto bounds = getLocalBounds();
+
+    g.setColour(juce::Colours::black.withAlpha(0.65f));
+    g.fillRoundedRectangle(bounds.toFloat(), 4.0f);
+
+    g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 10.5f, juce::Font::plain));
+
+    auto area = bounds.reduced(6, 4);
+    const int nameWidth = area.getWidth() - 3 * 54;
+
+    auto drawRow = [&](const juce::String& name, const juce::String& a, const juce::String& b,
+                       const juce::String& c, juce::Colour colour)
+        {
+            auto row = area.removeFromTop(rowHeight);
+            g.setColour(colour);
+            g.drawText(name, row.removeFromLeft(nameWidth), juce::Justification::centredLeft, false);
+            g.drawText(a, row.removeFromLeft(54), juce::Justification::centredRight, false);
+            g.drawText(b, row.removeFromLeft(54), juce::Justification::centredRight, false);
+            g.drawText(c, row.removeFromLeft(54), juce::Justification::centredRight, false);
+        };
+
+    auto fmt = [](double v) { return juce::String(v, v < 10.0 ? 2 : (v < 100.0 ? 1 : 0)); };
+
+    drawRow("stage (us)", "p50", "p99", "max", juce::Colours::lightgrey);
+
+    for (int s = 0; s < CallbackProfiler::numStages; ++s)
+    {
+        const auto stats = profiler.getStageStats(s);
+        if (stats.count == 0)
+            drawRow(CallbackProfiler::getStageName(s), "-", "-", "-", juce::Colours::grey);
+        else
+            drawRow(CallbackProfiler::getStageName(s), fmt(stats.p50), fmt(stats.p99), fmt(stats.max),
+                    s == CallbackProfiler::total ? juce::Colours::white : juce::Colours::lightgrey);
+    }
+
+    //Budget: callback time as a percentage of the buffer duration
+    const auto budget = profiler.getBudgetStats();
+    const auto budgetColour = budget.p99 >= 75.0 ? juce::Colours::orangered
+                            : budget.p99 >= 50.0 ? juce::Colours::orange
+                            : juce::Colours::lightgreen;
+
+    if (budget.count == 0)
+        drawRow("budget %", "-", "-", "-", juce::Colours::grey);
+    else
+        drawRow("budget %", fmt(budget.p50), fmt(budget.p99), fmt(budget.max), budgetColour);
+
+    //Load shedding tier (optional analysis dropped to protect the callback)
+    const int shedLevel = loadShedder.getLevel();
+    g.setColour(shedLevel == LoadShedder::full ? juce::Colours::lightgrey
+              : shedLevel == LoadShedder::visualizersOff ? juce::Colours::orangered : juce::Colours::orange);
+    g.drawText(juce::String("shedding: ") + LoadShedder::getLevelName(shedLevel),
+               area.removeFromTop(rowHeight), juce::Justification::centredLeft, false);
+}
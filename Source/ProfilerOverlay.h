@@ -0,0 +1,32 @@
+#pragma once
+#include <JuceHeader.h>
+
+#include "CallbackProfiler.h"
+#include "LoadShedder.h"
+
+//Translucent table of the audio callback profiler's per-stage p50/p99/max (in
+//microseconds), the callback's share of the buffer duration and the current load
+//shedding tier. Refreshed a few times per second; ignores the mouse so it can sit
+//over the visualizers.
+class ProfilerOverlay : public juce::Component,
+    private juce::Timer
+{
+public:
+    ProfilerOverlay(const CallbackProfiler& profiler, const LoadShedder& loadShedder);
+    ~ProfilerOverlay() override;
+
+    void paint(juce::Graphics& g) override;
+
+    //Height that fits every row
+    static int getPreferredHeight();
+
+private:
+    void timerCallback() override { repaint(); }
+
+    static constexpr int rowHeight = 12;
+
+    const CallbackProfiler& profiler;
+    const LoadShedder& loadShedder;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProfilerOverlay)
+};
@@ -0,0 +1,418 @@
+#include "RealtimeSanitizer.h"
+
+#if RESONANCE_RT_SANITIZER
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+ #include <crtdbg.h>
+#else
+ #include <execinfo.h>
+#endif
+
+#if defined(__GLIBC__)
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <time.h>
+ #include <unistd.h>
+#endif
+
+namespace RealtimeSanitizer
+{
+namespace detail
+{
+    //Per-thread state; plain ints so the hooks never allocate to read them
+    thread_local int realtimeDepth = 0;
+    thread_local int suppressDepth = 0;
+
+    constexpr int maxFrames = 32;
+    constexpr int maxCallSites = 256;
+
+    struct CallSite
+    {
+        juce::uint64 hash = 0;      //0 = free slot
+        juce::uint32 count = 0;
+        const char* what = nullptr;
+        juce::String stack;         //symbolized on the first hit
+    };
+
+    CallSite callSites[maxCallSites];
+    int numCallSites = 0;
+    int totalViolations = 0;
+    int droppedViolations = 0;      //call-site table full
+    juce::SpinLock tableLock;       //no pthread underneath, so the hooks below never see it
+
+    int captureStack(void** frames) noexcept
+    {
+       #if JUCE_WINDOWS
+        return (int)CaptureStackBackTrace(0, (DWORD)maxFrames, frames, nullptr);
+       #else
+        return backtrace(frames, maxFrames);
+       #endif
+    }
+
+    juce::uint64 hashStack(void* const* frames, int numFrames) noexcept
+    {
+        juce::uint64 h = 14695981039346656037ull; //FNV-1a over the return addresses
+        for (int i = 0; i < numFrames; ++i)
+        {
+            h ^= (juce::uint64)(juce::pointer_sized_uint)frames[i];
+            h *= 1099511628211ull;
+        }
+        return h | 1; //never 0
+    }
+
+    juce::String symbolize(void* const* frames, int numFrames)
+    {
+       #if JUCE_WINDOWS
+        juce::ignoreUnused(frames, numFrames);
+        return juce::SystemStats::getStackBacktrace();
+       #else
+        juce::String s;
+        if (char** symbols = backtrace_symbols(frames, numFrames))
+        {
+            for (int i = 0; i < numFrames; ++i)
+                s << "    " << symbols[i] << juce::newLine;
+            std::free(symbols);
+        }
+        return s;
+       #endif
+    }
+
+    void report(const char* what) noexcept
+    {
+        if (realtimeDepth == 0 || suppressDepth > 0)
+            return;
+
+        const ScopedSuppress suppress; //capturing, symbolizing and logging allocate
+
+        void* frames[maxFrames];
+        const int numFrames = captureStack(frames);
+        const auto hash = hashStack(frames, numFrames);
+
+        const juce::SpinLock::ScopedLockType sl(tableLock);
+        ++totalViolations;
+
+        for (int i = 0; i < numCallSites; ++i)
+        {
+            if (callSites[i].hash == hash)
+            {
+                ++callSites[i].count;
+                return;
+            }
+        }
+
+        if (numCallSites == maxCallSites)
+        {
+            ++droppedViolations;
+            return;
+        }
+
+        auto& site = callSites[numCallSites++];
+        site.hash = hash;
+        site.count = 1;
+        site.what = what;
+        site.stack = symbolize(frames, numFrames);
+
+        juce::Logger::writeToLog(juce::String("RT sanitizer: ") + what + " in the audio callback" + juce::newLine + site.stack);
+    }
+
+   #if JUCE_WINDOWS && defined(_DEBUG)
+    //Debug CRT: sees malloc/realloc/free, including allocations made inside the runtime
+    int crtAllocHook(int allocType, void*, size_t, int blockType, long, const unsigned char*, int)
+    {
+        if (blockType != _CRT_BLOCK) //skip the CRT's own bookkeeping blocks
+            report(allocType == _HOOK_FREE ? "free" : (allocType == _HOOK_REALLOC ? "realloc" : "malloc"));
+        return TRUE;
+    }
+
+    const struct CrtHookInstaller { CrtHookInstaller() { _CrtSetAllocHook(crtAllocHook); } } crtHookInstaller;
+   #endif
+
+   #if defined(__GLIBC__)
+    //The cache is a constant-initialized atomic rather than a function-local static,
+    //whose guard could itself end up in pthread_mutex_lock
+    template <typename Fn>
+    Fn nextSymbol(std::atomic<void*>& cache, const char* name) noexcept
+    {
+        void* fn = cache.load(std::memory_order_acquire);
+        if (fn == nullptr)
+        {
+            const ScopedSuppress suppress; //dlsym may allocate on first use
+            fn = dlsym(RTLD_NEXT, name);
+            cache.store(fn, std::memory_order_release);
+        }
+        return reinterpret_cast<Fn>(fn);
+    }
+   #endif
+} // namespace detail
+
+ScopedRealtimeContext::ScopedRealtimeContext() noexcept { ++detail::realtimeDepth; }
+ScopedRealtimeContext::~ScopedRealtimeContext() noexcept { --detail::realtimeDepth; }
+
+ScopedSuppress::ScopedSuppress() noexcept { ++detail::suppressDepth; }
+ScopedSuppress::~ScopedSuppress() noexcept { --detail::suppressDepth; }
+
+void blockingCall(const char* what) noexcept { detail::report(what); }
+
+juce::String getReport()
+{
+    const ScopedSuppress suppress;
+    const juce::SpinLock::ScopedLockType sl(detail::tableLock);
+
+    juce::String s;
+    s << "RT sanitizer: " << detail::totalViolations << " violation(s) from "
+      << detail::numCallSites << " call site(s) in the audio callback" << juce::newLine;
+
+    for (int i = 0; i < detail::numCallSites; ++i)
+    {
+        const auto& site = detail::callSites[i];
+        s << juce::newLine << (int)site.count << " x " << site.what << juce::newLine << site.stack;
+    }
+
+    if (detail::droppedViolations > 0)
+        s << juce::newLine << detail::droppedViolations << " violation(s) not attributed (call-site table full)" << juce::newLine;
+
+    return s;
+}
+
+int getTotalViolations() noexcept
+{
+    const juce::SpinLock::ScopedLockType sl(detail::tableLock);
+    return detail::totalViolations;
+}
+
+void reset()
+{
+    const ScopedSuppress suppress;
+    const juce::SpinLock::ScopedLockType sl(detail::tableLock);
+
+    for (int i = 0; i < detail::numCallSites; ++i)
+        detail::callSites[i] = {};
+
+    detail::numCallSites = 0;
+    detail::totalViolations = 0;
+    detail::droppedViolations = 0;
+}
+} // namespace RealtimeSanitizer
+
+//==============================================================================
+//Global operator new/delete (all platforms). The underlying malloc/free is the same
+//allocation, so it runs suppressed to keep it from being counted twice.
+
+namespace
+{
+    void* sanitizedAlloc(std::size_t size, const char* what) noexcept
+    {
+        RealtimeSanitizer::detail::report(what);
+        const RealtimeSanitizer::ScopedSuppress suppress;
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+    void sanitizedFree(void* p, const char* what) noexcept
+    {
+        if (p == nullptr) return;
+        RealtimeSanitizer::detail::report(what);
+        const RealtimeSanitizer::ScopedSuppress suppress;
+        std::free(p);
+    }
+
+    //Over-aligned new/delete (alignas types, SIMD buffers) need the platform's aligned allocator
+    void* sanitizedAlignedAlloc(std::size_t size, std::align_val_t alignment, const char* what) noexcept
+    {
+        RealtimeSanitizer::detail::report(what);
+        const RealtimeSanitizer::ScopedSuppress suppress;
+        const auto align = juce::jmax((std::size_t)alignment, sizeof(void*));
+       #if JUCE_WINDOWS
+        return _aligned_malloc(size == 0 ? 1 : size, align);
+       #else
+        void* p = nullptr;
+        return posix_memalign(&p, align, size == 0 ? 1 : size) == 0 ? p : nullptr;
+       #endif
+    }
+
+    void sanitizedAlignedFree(void* p, const char* what) noexcept
+    {
+        if (p == nullptr) return;
+        RealtimeSanitizer::detail::report(what);
+        const RealtimeSanitizer::ScopedSuppress suppress;
+       #if JUCE_WINDOWS
+        _aligned_free(p);
+       #else
+        std::free(p);
+       #endif
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    if (void* p = sanitizedAlloc(size, "operator new")) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    if (void* p = sanitizedAlloc(size, "operator new[]")) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept   { return sanitizedAlloc(size, "operator new"); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return sanitizedAlloc(size, "operator new[]"); }
+
+void operator delete(void* p) noexcept                               { sanitizedFree(p, "operator delete"); }
+void operator delete[](void* p) noexcept                             { sanitizedFree(p, "operator delete[]"); }
+void operator delete(void* p, std::size_t) noexcept                  { sanitizedFree(p, "operator delete"); }
+void operator delete[](void* p, std::size_t) noexcept                { sanitizedFree(p, "operator delete[]"); }
+void operator delete(void* p, const std::nothrow_t&) noexcept        { sanitizedFree(p, "operator delete"); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept      { sanitizedFree(p, "operator delete[]"); }
+
+void* operator new(std::size_t size, std::align_val_t al)
+{
+    if (void* p = sanitizedAlignedAlloc(size, al, "operator new (aligned)")) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t al)
+{
+    if (void* p = sanitizedAlignedAlloc(size, al, "operator new[] (aligned)")) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept   { return sanitizedAlignedAlloc(size, al, "operator new (aligned)"); }
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept { return sanitizedAlignedAlloc(size, al, "operator new[] (aligned)"); }
+
+void operator delete(void* p, std::align_val_t) noexcept                          { sanitizedAlignedFree(p, "operator delete (aligned)"); }
+void operator delete[](void* p, std::align_val_t) noexcept                        { sanitizedAlignedFree(p, "operator delete[] (aligned)"); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept             { sanitizedAlignedFree(p, "operator delete (aligned)"); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept           { sanitizedAlignedFree(p, "operator delete[] (aligned)"); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept   { sanitizedAlignedFree(p, "operator delete (aligned)"); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { sanitizedAlignedFree(p, "operator delete[] (aligned)"); }
+
+//==============================================================================
+//glibc: interpose the C allocator and the blocking pthread/sleep entry points.
+//Definitions in the executable take precedence over libc's; they forward to the
+//real implementations after reporting.
+
+#if defined(__GLIBC__)
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void  __libc_free(void*);
+    void* __libc_memalign(size_t, size_t);
+
+    void* malloc(size_t size)
+    {
+        RealtimeSanitizer::detail::report("malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size)
+    {
+        RealtimeSanitizer::detail::report("calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* p, size_t size)
+    {
+        RealtimeSanitizer::detail::report("realloc");
+        return __libc_realloc(p, size);
+    }
+
+    void free(void* p)
+    {
+        if (p != nullptr) RealtimeSanitizer::detail::report("free");
+        __libc_free(p);
+    }
+
+    //Aligned allocations (JUCE's SIMD and dsp buffers among them)
+    int posix_memalign(void** result, size_t alignment, size_t size)
+    {
+        RealtimeSanitizer::detail::report("posix_memalign");
+        if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+
+        void* p = __libc_memalign(alignment, size);
+        if (p == nullptr)
+            return ENOMEM;
+
+        *result = p;
+        return 0;
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size)
+    {
+        RealtimeSanitizer::detail::report("aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    void* memalign(size_t alignment, size_t size)
+    {
+        RealtimeSanitizer::detail::report("memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    int pthread_mutex_lock(pthread_mutex_t* m)
+    {
+        static std::atomic<void*> cache{ nullptr };
+        const auto real = RealtimeSanitizer::detail::nextSymbol<int (*)(pthread_mutex_t*)>(cache, "pthread_mutex_lock");
+        RealtimeSanitizer::detail::report("pthread_mutex_lock");
+        return real(m);
+    }
+
+    int pthread_rwlock_rdlock(pthread_rwlock_t* l)
+    {
+        static std::atomic<void*> cache{ nullptr };
+        const auto real = RealtimeSanitizer::detail::nextSymbol<int (*)(pthread_rwlock_t*)>(cache, "pthread_rwlock_rdlock");
+        RealtimeSanitizer::detail::report("pthread_rwlock_rdlock");
+        return real(l);
+    }
+
+    int pthread_rwlock_wrlock(pthread_rwlock_t* l)
+    {
+        static std::atomic<void*> cache{ nullptr };
+        const auto real = RealtimeSanitizer::detail::nextSymbol<int (*)(pthread_rwlock_t*)>(cache, "pthread_rwlock_wrlock");
+        RealtimeSanitizer::detail::report("pthread_rwlock_wrlock");
+        return real(l);
+    }
+
+    int pthread_cond_wait(pthread_cond_t* c, pthread_mutex_t* m)
+    {
+        static std::atomic<void*> cache{ nullptr };
+        const auto real = RealtimeSanitizer::detail::nextSymbol<int (*)(pthread_cond_t*, pthread_mutex_t*)>(cache, "pthread_cond_wait");
+        RealtimeSanitizer::detail::report("pthread_cond_wait");
+        return real(c, m);
+    }
+
+    int pthread_cond_timedwait(pthread_cond_t* c, pthread_mutex_t* m, const struct timespec* t)
+    {
+        static std::atomic<void*> cache{ nullptr };
+        const auto real = RealtimeSanitizer::detail::nextSymbol<int (*)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*)>(cache, "pthread_cond_timedwait");
+        RealtimeSanitizer::detail::report("pthread_cond_timedwait");
+        return real(c, m, t);
+    }
+
+    int nanosleep(const struct timespec* req, struct timespec* rem)
+    {
+        static std::atomic<void*> cache{ nullptr };
+        const auto real = RealtimeSanitizer::detail::nextSymbol<int (*)(const struct timespec*, struct timespec*)>(cache, "nanosleep");
+        RealtimeSanitizer::detail::report("nanosleep");
+        return real(req, rem);
+    }
+
+    int usleep(useconds_t usec)
+    {
+        static std::atomic<void*> cache{ nullptr };
+        const auto real = RealtimeSanitizer::detail::nextSymbol<int (*)(useconds_t)>(cache, "usleep");
+        RealtimeSanitizer::detail::report("usleep");
+        return real(usec);
+    }
+}
+#endif
+
+#endif // RESONANCE_RT_SANITIZER
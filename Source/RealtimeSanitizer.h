@@ -0,0 +1,69 @@
+#pragma once
+#include <JuceHeader.h>
+
+//Debug build mode that flags real-time violations made inside the audio callback:
+//heap allocations/frees, lock and condition-variable waits, and sleeps.
+//
+//Build with RESONANCE_RT_SANITIZER=1 to enable it. The callback marks itself with
+//RESONANCE_RT_CONTEXT; while that scope is active on a thread, the hooks in
+//RealtimeSanitizer.cpp record every violation against its call stack. The first
+//hit from a call site logs the symbolized stack; later hits only bump its counter.
+//
+//Hooks: global operator new/delete including the aligned overloads (all platforms),
+//malloc/calloc/realloc/free, posix_memalign/aligned_alloc/memalign and pthread
+//mutex/rwlock/condvar/sleep calls (glibc), the CRT allocation hook (MSVC debug
+//runtime), plus RESONANCE_RT_BLOCKING() at lock sites we own.
+//
+//With the flag off, every entry point below compiles to nothing.
+
+#ifndef RESONANCE_RT_SANITIZER
+ #define RESONANCE_RT_SANITIZER 0
+#endif
+
+namespace RealtimeSanitizer
+{
+#if RESONANCE_RT_SANITIZER
+    constexpr bool isEnabled() noexcept { return true; }
+
+    //Marks the current thread as real-time for the lifetime of the scope (nestable)
+    struct ScopedRealtimeContext
+    {
+        ScopedRealtimeContext() noexcept;
+        ~ScopedRealtimeContext() noexcept;
+    };
+
+    //Temporarily stops checking on the current thread (for known, accepted exceptions)
+    struct ScopedSuppress
+    {
+        ScopedSuppress() noexcept;
+        ~ScopedSuppress() noexcept;
+    };
+
+    //Report a potentially blocking call if we are in a real-time context
+    void blockingCall(const char* what) noexcept;
+
+    //Per call site: violation kind, hit count and symbolized stack
+    juce::String getReport();
+    int getTotalViolations() noexcept;
+    void reset();
+#else
+    constexpr bool isEnabled() noexcept { return false; }
+
+    struct ScopedRealtimeContext {};
+    struct ScopedSuppress {};
+
+    inline void blockingCall(const char*) noexcept {}
+
+    inline juce::String getReport() { return {}; }
+    inline int getTotalViolations() noexcept { return 0; }
+    inline void reset() {}
+#endif
+}
+
+#if RESONANCE_RT_SANITIZER
+ #define RESONANCE_RT_CONTEXT         const RealtimeSanitizer::ScopedRealtimeContext rtSanitizerContext
+ #define RESONANCE_RT_BLOCKING(what)  RealtimeSanitizer::blockingCall(what)
+#else
+ #define RESONANCE_RT_CONTEXT         ((void)0)
+ #define RESONANCE_RT_BLOCKING(what)  ((void)0)
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+#include <JuceHeader.h>
+#include <vector>
+
+//Single-producer / single-consumer sample FIFO for handing audio from the
+//audio thread to an analysis worker. Storage is sized once in prepare();
+//push() never allocates or blocks and simply drops what doesn't fit.
+
+class SampleFifo
+{
+public:
+    void prepare(int numChannelsIn, int capacity)
+    {
+        numChannels = juce::jmax(1, numChannelsIn);
+        storage.assign((size_t)numChannels, std::vector<float>((size_t)juce::jmax(1, capacity), 0.0f));
+        fifo.setTotalSize(juce::jmax(1, capacity));
+        fifo.reset();
+    }
+
+    int getNumChannels() const noexcept { return numChannels; }
+    int getNumReady() const noexcept { return fifo.getNumReady(); }
+    int getFreeSpace() const noexcept { return fifo.getFreeSpace(); }
+
+    //Producer side (audio thread). channelData must hold getNumChannels() pointers.
+    int push(const float* const* channelData, int numSamples) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            float* dst = storage[(size_t)ch].data();
+            if (size1 > 0) juce::FloatVectorOperations::copy(dst + start1, channelData[ch], size1);
+            if (size2 > 0) juce::FloatVectorOperations::copy(dst + start2, channelData[ch] + size1, size2);
+        }
+
+        fifo.finishedWrite(size1 + size2);
+        return size1 + size2;
+    }
+
+    //Consumer side (worker thread). Returns the number of samples copied into dest.
+    int pop(float* const* dest, int numSamples) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead(numSamples, start1, size1, start2, size2);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const float* src = storage[(size_t)ch].data();
+            if (size1 > 0) juce::FloatVectorOperations::copy(dest[ch], src + start1, size1);
+            if (size2 > 0) juce::FloatVectorOperations::copy(dest[ch] + size1, src + start2, size2);
+        }
+
+        fifo.finishedRead(size1 + size2);
+        return size1 + size2;
+    }
+
+    //Consumer side: discard everything currently queued.
+    void drain() noexcept { fifo.finishedRead(fifo.getNumReady()); }
+
+private:
+    int numChannels = 1;
+    std::vector<std::vector<float>> storage;
+    juce::AbstractFifo fifo{ 1 };
+};
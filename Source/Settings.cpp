@@ -1,12 +1,17 @@
 #include "Settings.h"
+#include "MeterBridge.h"
+#include "LoudnessLog.h"
+#include "Waveform.h"
+#include "resonance_meters.h"
 
-Settings::Settings(juce::AudioDeviceManager& deviceManager)
+Settings::Settings(juce::AudioDeviceManager& deviceManagerIn)
+    : deviceManager(deviceManagerIn)
 {
     // Create audio settings component
     audioSettings = std::make_unique<juce::AudioDeviceSelectorComponent>(
         deviceManager,
-        1, 2, // Min I/O channels
-        1, 2, // Max I/O channels
+        1, MeterBridge::maxChannels, // Min/max input channels (2+ for transfer function, up to 64 for the meter bridge)
+        1, 2, // Min/max output channels
         false, // MIDI input
         false, // MIDI output
         true, // Stereo/mono combo
@@ -14,9 +19,203 @@ Settings::Settings(juce::AudioDeviceManager& deviceManager)
     );
 
     addAndMakeVisible(audioSettings.get());
+
+    // Transfer function channel pickers
+    referenceChannelBox.onChange = [this] { transferChannelsChanged(); };
+    measurementChannelBox.onChange = [this] { transferChannelsChanged(); };
+
+    addAndMakeVisible(referenceLabel);
+    addAndMakeVisible(measurementLabel);
+    addAndMakeVisible(referenceChannelBox);
+    addAndMakeVisible(measurementChannelBox);
+
+    // Trace renderer switches
+    for (auto* toggle : { &fastScopeToggle, &fastSpectrumToggle, &fastStereoToggle })
+    {
+        toggle->onClick = [this] { fastTracesChanged(); };
+        addAndMakeVisible(toggle);
+    }
+    addAndMakeVisible(fastTracesLabel);
+
+    // Callback profiler
+    profilerToggle.onClick = [this]
+        {
+            if (onProfilerChanged != nullptr)
+                onProfilerChanged(profilerToggle.getToggleState());
+        };
+    profilerExportButton.onClick = [this]
+        {
+            if (onProfilerExport != nullptr)
+                onProfilerExport();
+        };
+    addAndMakeVisible(profilerLabel);
+    addAndMakeVisible(profilerToggle);
+    addAndMakeVisible(profilerExportButton);
+
+    // Trace recorder
+    traceRecordToggle.onClick = [this] { traceRecorderChanged(); };
+    traceDumpOnXrunToggle.onClick = [this] { traceRecorderChanged(); };
+    traceDumpOnXrunToggle.setToggleState(true, juce::dontSendNotification);
+    traceSaveButton.onClick = [this]
+        {
+            if (onTraceSave != nullptr)
+                onTraceSave();
+        };
+    addAndMakeVisible(traceLabel);
+    addAndMakeVisible(traceRecordToggle);
+    addAndMakeVisible(traceDumpOnXrunToggle);
+    addAndMakeVisible(traceSaveButton);
+
+    // Shared-memory meter export (on by default; MainComponent reports the actual state)
+    meterExportToggle.setToggleState(true, juce::dontSendNotification);
+    setMeterExportState(true, {});
+    meterExportToggle.onClick = [this]
+        {
+            if (onMeterExportChanged != nullptr)
+                onMeterExportChanged(meterExportToggle.getToggleState());
+        };
+    addAndMakeVisible(meterExportLabel);
+    addAndMakeVisible(meterExportToggle);
+
+    // Loudness log (off by default; 7 days of 100 ms records in the app data folder)
+    loudnessLogToggle.setTooltip("Record momentary, short-term and true-peak values every 100 ms to "
+                                 + LoudnessLog::getDefaultFile().getFullPathName()
+                                 + " (a fixed-size ring holding the last " + juce::String((int)LoudnessLog::defaultDays) + " days)");
+    loudnessLogToggle.onClick = [this]
+        {
+            if (onLoudnessLogChanged != nullptr)
+                onLoudnessLogChanged(loudnessLogToggle.getToggleState());
+        };
+    addAndMakeVisible(loudnessLogToggle);
+
+    // Waveform history; item IDs are the length in seconds
+    waveformHistoryBox.addItem("10 seconds", 10);
+    waveformHistoryBox.addItem("1 minute", 60);
+    waveformHistoryBox.addItem("10 minutes", 600);
+    waveformHistoryBox.addItem("1 hour", (int)Waveform::maxHistorySeconds);
+    waveformHistoryBox.setSelectedId((int)Waveform::defaultHistorySeconds, juce::dontSendNotification);
+    waveformHistoryBox.onChange = [this]
+        {
+            if (onWaveformHistoryChanged != nullptr)
+                onWaveformHistoryChanged((double)waveformHistoryBox.getSelectedId());
+        };
+    addAndMakeVisible(waveformHistoryLabel);
+    addAndMakeVisible(waveformHistoryBox);
+
+    deviceManager.addChangeListener(this);
+    updateTransferChannelLists();
+}
+
+Settings::~Settings()
+{
+    deviceManager.removeChangeListener(this);
 }
 
 void Settings::resized()
 {
-    audioSettings->setBounds(getLocalBounds());
+    auto area = getLocalBounds();
+    auto transferArea = area.removeFromBottom(194).reduced(10, 4);
+
+    audioSettings->setBounds(area);
+
+    auto refRow = transferArea.removeFromTop(26);
+    referenceLabel.setBounds(refRow.removeFromLeft(130));
+    referenceChannelBox.setBounds(refRow.removeFromLeft(200).reduced(0, 2));
+
+    auto measRow = transferArea.removeFromTop(26);
+    measurementLabel.setBounds(measRow.removeFromLeft(130));
+    measurementChannelBox.setBounds(measRow.removeFromLeft(200).reduced(0, 2));
+
+    auto traceRow = transferArea.removeFromTop(26);
+    fastTracesLabel.setBounds(traceRow.removeFromLeft(130));
+    fastScopeToggle.setBounds(traceRow.removeFromLeft(110));
+    fastSpectrumToggle.setBounds(traceRow.removeFromLeft(90));
+    fastStereoToggle.setBounds(traceRow.removeFromLeft(80));
+
+    auto profilerRow = transferArea.removeFromTop(26);
+    profilerLabel.setBounds(profilerRow.removeFromLeft(130));
+    profilerToggle.setBounds(profilerRow.removeFromLeft(110));
+    profilerExportButton.setBounds(profilerRow.removeFromLeft(100).reduced(0, 2));
+
+    auto recorderRow = transferArea.removeFromTop(26);
+    traceLabel.setBounds(recorderRow.removeFromLeft(130));
+    traceRecordToggle.setBounds(recorderRow.removeFromLeft(80));
+    traceDumpOnXrunToggle.setBounds(recorderRow.removeFromLeft(120));
+    traceSaveButton.setBounds(recorderRow.removeFromLeft(100).reduced(0, 2));
+
+    auto exportRow = transferArea.removeFromTop(26);
+    meterExportLabel.setBounds(exportRow.removeFromLeft(130));
+    meterExportToggle.setBounds(exportRow.removeFromLeft(130));
+    loudnessLogToggle.setBounds(exportRow.removeFromLeft(120));
+
+    auto waveformRow = transferArea.removeFromTop(26);
+    waveformHistoryLabel.setBounds(waveformRow.removeFromLeft(130));
+    waveformHistoryBox.setBounds(waveformRow.removeFromLeft(200).reduced(0, 2));
+}
+
+void Settings::changeListenerCallback(juce::ChangeBroadcaster*)
+{
+    //Device or channel selection changed
+    updateTransferChannelLists();
+}
+
+void Settings::updateTransferChannelLists()
+{
+    //Items follow the order the audio callback sees the active inputs in
+    juce::StringArray names;
+    if (auto* device = deviceManager.getCurrentAudioDevice())
+    {
+        const auto allNames = device->getInputChannelNames();
+        const auto active = device->getActiveInputChannels();
+
+        for (int i = 0; i <= active.getHighestBit(); ++i)
+            if (active[i])
+                names.add(allNames[i].isNotEmpty() ? allNames[i] : "Input " + juce::String(i + 1));
+    }
+
+    const int prevRef = referenceChannelBox.getSelectedItemIndex();
+    const int prevMeas = measurementChannelBox.getSelectedItemIndex();
+
+    referenceChannelBox.clear(juce::dontSendNotification);
+    measurementChannelBox.clear(juce::dontSendNotification);
+    referenceChannelBox.addItemList(names, 1);
+    measurementChannelBox.addItemList(names, 1);
+
+    const int last = names.size() - 1;
+    if (last < 0) return;
+
+    referenceChannelBox.setSelectedItemIndex(prevRef >= 0 ? juce::jmin(prevRef, last) : 0, juce::dontSendNotification);
+    measurementChannelBox.setSelectedItemIndex(prevMeas >= 0 ? juce::jmin(prevMeas, last) : juce::jmin(1, last), juce::dontSendNotification);
+    transferChannelsChanged();
+}
+
+void Settings::transferChannelsChanged()
+{
+    const int ref = referenceChannelBox.getSelectedItemIndex();
+    const int meas = measurementChannelBox.getSelectedItemIndex();
+
+    if (onTransferChannelsChanged != nullptr && ref >= 0 && meas >= 0)
+        onTransferChannelsChanged(ref, meas);
+}
+
+void Settings::traceRecorderChanged()
+{
+    if (onTraceRecorderChanged != nullptr)
+        onTraceRecorderChanged(traceRecordToggle.getToggleState(), traceDumpOnXrunToggle.getToggleState());
+}
+
+void Settings::fastTracesChanged()
+{
+    if (onFastTracesChanged != nullptr)
+        onFastTracesChanged(fastScopeToggle.getToggleState(),
+                            fastSpectrumToggle.getToggleState(),
+                            fastStereoToggle.getToggleState());
+}
+
+void Settings::setMeterExportState(bool publishing, const juce::String& problem)
+{
+    meterExportToggle.setToggleState(publishing, juce::dontSendNotification);
+    meterExportToggle.setTooltip(problem.isEmpty()
+        ? juce::String("Publish the meters to the shared memory object " RESONANCE_METERS_SHM_NAME " for other processes")
+        : "Not exporting: " + problem + ". Switch on to try again.");
 }
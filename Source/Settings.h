@@ -1,16 +1,82 @@
 #pragma once
 #include <JuceHeader.h>
 
-class Settings : public juce::Component
+class Settings : public juce::Component,
+    private juce::ChangeListener
 {
 public:
     Settings(juce::AudioDeviceManager& deviceManager);
-    ~Settings() override = default;
+    ~Settings() override;
 
     void resized() override;
 
+    //Fired with (referenceChannel, measurementChannel) input indices for the transfer function view
+    std::function<void(int, int)> onTransferChannelsChanged;
+
+    //Fired with the fast (direct-to-bitmap) trace switches for oscilloscope, spectrum and stereo
+    std::function<void(bool, bool, bool)> onFastTracesChanged;
+
+    //Audio callback profiler: overlay on/off (also enables timing) and CSV export
+    std::function<void(bool)> onProfilerChanged;
+    std::function<void()> onProfilerExport;
+
+    //Trace recorder: (record, dump automatically on xrun) and save-now
+    std::function<void(bool, bool)> onTraceRecorderChanged;
+    std::function<void()> onTraceSave;
+
+    //Shared-memory meter export (see resonance_meters.h) on/off
+    std::function<void(bool)> onMeterExportChanged;
+
+    //Shows whether the export is publishing, and if not, why the object could not be opened
+    void setMeterExportState(bool publishing, const juce::String& problem);
+
+    //Loudness log (100 ms records in a ring file, see LoudnessLog.h) on/off
+    std::function<void(bool)> onLoudnessLogChanged;
+
+    //Waveform strip history length in seconds
+    std::function<void(double)> onWaveformHistoryChanged;
+
 private:
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+    void updateTransferChannelLists();
+    void transferChannelsChanged();
+    void fastTracesChanged();
+
+    juce::AudioDeviceManager& deviceManager;
     std::unique_ptr<juce::AudioDeviceSelectorComponent> audioSettings;
 
+    //Transfer function inputs (indices into the active input channels)
+    juce::Label referenceLabel{ {}, "Reference input" };
+    juce::Label measurementLabel{ {}, "Measurement input" };
+    juce::ComboBox referenceChannelBox;
+    juce::ComboBox measurementChannelBox;
+
+    //Trace rendering (quality path stroking vs fast rasterizer, per visualizer)
+    juce::Label fastTracesLabel{ {}, "Fast trace rendering" };
+    juce::ToggleButton fastScopeToggle{ "Oscilloscope" };
+    juce::ToggleButton fastSpectrumToggle{ "Spectrum" };
+    juce::ToggleButton fastStereoToggle{ "Stereo" };
+
+    //Callback profiler
+    juce::Label profilerLabel{ {}, "Callback profiler" };
+    juce::ToggleButton profilerToggle{ "Show overlay" };
+    juce::TextButton profilerExportButton{ "Export CSV..." };
+
+    //Trace recorder
+    juce::Label traceLabel{ {}, "Trace recorder" };
+    juce::ToggleButton traceRecordToggle{ "Record" };
+    juce::ToggleButton traceDumpOnXrunToggle{ "Dump on xrun" };
+    juce::TextButton traceSaveButton{ "Save trace..." };
+    void traceRecorderChanged();
+
+    //Meter export: shared memory and the loudness log
+    juce::Label meterExportLabel{ {}, "Meter export" };
+    juce::ToggleButton meterExportToggle{ "Shared memory" };
+    juce::ToggleButton loudnessLogToggle{ "Loudness log" };
+
+    //Waveform history (the strip shows the newest quarter of it)
+    juce::Label waveformHistoryLabel{ {}, "Waveform history" };
+    juce::ComboBox waveformHistoryBox;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Settings)
 };
@@ -0,0 +1,335 @@
+#include "SimulatedAudioDevice.h"
+
+SimulatedAudioDevice::Options SimulatedAudioDevice::Options::fromArguments(const juce::StringArray& args)
+{
+    Options o;
+    auto valueAfter = [&args](const char* flag) -> juce::String
+        {
+            const int i = args.indexOf(flag);
+            return i >= 0 && i + 1 < args.size() ? args[i + 1].unquoted() : juce::String();
+        };
+
+    const auto source = valueAfter("--simulate");
+    if (source.isEmpty() || source.startsWith("--") || source == "sine") o.signal = Signal::sine;
+    else if (source == "noise")               o.signal = Signal::noise;
+    else if (source == "silence")             o.signal = Signal::silence;
+    else { o.signal = Signal::file; o.file = juce::File::getCurrentWorkingDirectory().getChildFile(source); }
+
+    if (auto v = valueAfter("--frequency");   v.isNotEmpty()) o.frequencyHz = v.getFloatValue();
+    if (auto v = valueAfter("--level-db");    v.isNotEmpty()) o.levelDb = v.getFloatValue();
+    if (auto v = valueAfter("--sample-rate"); v.isNotEmpty()) o.sampleRate = v.getDoubleValue();
+    if (auto v = valueAfter("--block");       v.isNotEmpty()) o.bufferSize = v.getIntValue();
+    if (auto v = valueAfter("--min-block");   v.isNotEmpty()) o.minBlockSize = v.getIntValue();
+    if (auto v = valueAfter("--jitter-ms");   v.isNotEmpty()) o.jitterMs = v.getDoubleValue();
+    if (auto v = valueAfter("--seconds");     v.isNotEmpty()) o.durationSeconds = v.getDoubleValue();
+    if (auto v = valueAfter("--seed");        v.isNotEmpty()) o.seed = v.getLargeIntValue();
+    o.realtime = args.contains("--realtime");
+
+    o.sampleRate = o.sampleRate > 0.0 ? o.sampleRate : 48000.0;
+    o.bufferSize = juce::jlimit(1, 16384, o.bufferSize);
+    o.minBlockSize = juce::jlimit(0, o.bufferSize, o.minBlockSize);
+    o.jitterMs = juce::jmax(0.0, o.jitterMs);
+    return o;
+}
+
+//==============================================================================
+
+SimulatedAudioDevice::SimulatedAudioDevice(const Options& optionsIn)
+    : juce::AudioIODevice(SimulatedAudioDeviceType::deviceName, SimulatedAudioDeviceType::typeName),
+    juce::Thread("Simulated audio device"),
+    options(optionsIn),
+    random(optionsIn.seed)
+{
+    paused.store(options.startPaused);
+    formatManager.registerBasicFormats();
+    timings.ensureStorageAllocated(maxTimings);
+}
+
+SimulatedAudioDevice::~SimulatedAudioDevice()
+{
+    close();
+}
+
+juce::StringArray SimulatedAudioDevice::getOutputChannelNames()
+{
+    juce::StringArray names;
+    for (int ch = 0; ch < options.numOutputChannels; ++ch)
+        names.add("Output " + juce::String(ch + 1));
+    return names;
+}
+
+juce::StringArray SimulatedAudioDevice::getInputChannelNames()
+{
+    juce::StringArray names;
+    for (int ch = 0; ch < options.numInputChannels; ++ch)
+        names.add("Input " + juce::String(ch + 1));
+    return names;
+}
+
+//Only the configured rate and size are offered, so the device manager cannot pick others
+juce::Array<double> SimulatedAudioDevice::getAvailableSampleRates() { return { options.sampleRate }; }
+juce::Array<int> SimulatedAudioDevice::getAvailableBufferSizes()    { return { options.bufferSize }; }
+int SimulatedAudioDevice::getDefaultBufferSize()                    { return options.bufferSize; }
+
+juce::String SimulatedAudioDevice::open(const juce::BigInteger& inputChannels, const juce::BigInteger& outputChannels,
+                                        double /*sampleRate*/, int /*bufferSizeSamples*/)
+{
+    close();
+    lastError.clear();
+
+    activeInputs = inputChannels;
+    activeInputs.setRange(options.numInputChannels, juce::jmax(0, activeInputs.getHighestBit() + 1 - options.numInputChannels), false);
+    activeOutputs = outputChannels;
+    activeOutputs.setRange(options.numOutputChannels, juce::jmax(0, activeOutputs.getHighestBit() + 1 - options.numOutputChannels), false);
+
+    //Callback buffers are sized once here; the run never allocates
+    inputBuffer.setSize(juce::jmax(1, activeInputs.countNumberOfSetBits()), options.bufferSize);
+    outputBuffer.setSize(juce::jmax(1, activeOutputs.countNumberOfSetBits()), options.bufferSize);
+
+    if (options.signal == Options::Signal::file)
+    {
+        auto* reader = formatManager.createReaderFor(options.file);
+        if (reader == nullptr)
+        {
+            lastError = "Could not open " + options.file.getFullPathName();
+            return lastError;
+        }
+
+        const double fileRate = reader->sampleRate;
+        readerSource = std::make_unique<juce::AudioFormatReaderSource>(reader, true);
+        readerSource->setLooping(true);
+
+        resampler = std::make_unique<juce::ResamplingAudioSource>(readerSource.get(), false, inputBuffer.getNumChannels());
+        resampler->setResamplingRatio(fileRate / options.sampleRate);
+        resampler->prepareToPlay(options.bufferSize, options.sampleRate);
+    }
+
+    opened = true;
+    return {};
+}
+
+void SimulatedAudioDevice::close()
+{
+    stop();
+
+    if (resampler != nullptr)
+        resampler->releaseResources();
+    resampler.reset();
+    readerSource.reset();
+
+    opened = false;
+}
+
+bool SimulatedAudioDevice::isOpen() { return opened; }
+
+void SimulatedAudioDevice::start(juce::AudioIODeviceCallback* newCallback)
+{
+    if (!opened || newCallback == nullptr) return;
+    stop();
+
+    newCallback->audioDeviceAboutToStart(this);
+    {
+        const juce::ScopedLock sl(callbackLock);
+        callback = newCallback;
+    }
+
+    finished.store(false);
+    startThread(juce::Thread::Priority::highest);
+}
+
+void SimulatedAudioDevice::stop()
+{
+    juce::AudioIODeviceCallback* oldCallback = nullptr;
+    {
+        const juce::ScopedLock sl(callbackLock);
+        std::swap(oldCallback, callback);
+    }
+
+    stopThread(2000);
+
+    if (oldCallback != nullptr)
+        oldCallback->audioDeviceStopped();
+}
+
+bool SimulatedAudioDevice::isPlaying() { return callback != nullptr; }
+
+//==============================================================================
+
+int SimulatedAudioDevice::nextBlockSize() noexcept
+{
+    if (options.minBlockSize <= 0 || options.minBlockSize >= options.bufferSize)
+        return options.bufferSize;
+
+    return options.minBlockSize + random.nextInt(options.bufferSize - options.minBlockSize + 1);
+}
+
+void SimulatedAudioDevice::renderInput(int numSamples)
+{
+    const float gain = juce::Decibels::decibelsToGain(options.levelDb);
+
+    switch (options.signal)
+    {
+    case Options::Signal::file:
+    {
+        const juce::AudioSourceChannelInfo info(&inputBuffer, 0, numSamples);
+        resampler->getNextAudioBlock(info);
+        break;
+    }
+    case Options::Signal::sine:
+    {
+        const double delta = juce::MathConstants<double>::twoPi * options.frequencyHz / options.sampleRate;
+        float* first = inputBuffer.getWritePointer(0);
+        for (int i = 0; i < numSamples; ++i)
+        {
+            first[i] = gain * (float)std::sin(phase);
+            phase = std::fmod(phase + delta, juce::MathConstants<double>::twoPi);
+        }
+        for (int ch = 1; ch < inputBuffer.getNumChannels(); ++ch)
+            inputBuffer.copyFrom(ch, 0, inputBuffer, 0, 0, numSamples);
+        break;
+    }
+    case Options::Signal::noise:
+        for (int ch = 0; ch < inputBuffer.getNumChannels(); ++ch)
+        {
+            float* d = inputBuffer.getWritePointer(ch);
+            for (int i = 0; i < numSamples; ++i)
+                d[i] = gain * (random.nextFloat() * 2.0f - 1.0f);
+        }
+        break;
+    case Options::Signal::silence:
+        inputBuffer.clear(0, numSamples);
+        break;
+    }
+}
+
+//Sleep most of the way, then yield until the exact time
+void SimulatedAudioDevice::waitUntil(double wallMs)
+{
+    for (;;)
+    {
+        const double remaining = wallMs - juce::Time::getMillisecondCounterHiRes();
+        if (remaining <= 0.0 || threadShouldExit()) return;
+
+        if (remaining > 2.0) wait((int)(remaining - 1.0));
+        else juce::Thread::yield();
+    }
+}
+
+void SimulatedAudioDevice::recordTiming(const CallbackTiming& timing)
+{
+    const juce::ScopedLock sl(timingLock);
+
+    if (timings.size() < maxTimings)
+        timings.add(timing); //storage was reserved up front
+
+    ++totalCallbacks;
+    totalSamples += timing.numSamples;
+    totalCallbackUs += timing.durationUs;
+    maxCallbackUs = juce::jmax(maxCallbackUs, timing.durationUs);
+    runWallMs = timing.startMs + timing.durationUs * 0.001;
+}
+
+void SimulatedAudioDevice::run()
+{
+    while (paused.load() && !threadShouldExit())
+        wait(1);
+
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+    const auto limitSamples = (juce::int64)(options.durationSeconds * options.sampleRate);
+    const double ticksToUs = 1.0e6 / (double)juce::Time::getHighResolutionTicksPerSecond();
+
+    juce::uint64 hostTimeNs = 0;
+    juce::AudioIODeviceCallbackContext context;
+    context.hostTimeNs = &hostTimeNs;
+
+    juce::int64 samplesDone = 0;
+
+    while (!threadShouldExit())
+    {
+        if (paused.load()) { wait(1); continue; }
+
+        if (limitSamples > 0 && samplesDone >= limitSamples)
+        {
+            finished.store(true);
+            if (options.onFinished != nullptr)
+                options.onFinished();
+            return;
+        }
+
+        int numSamples = nextBlockSize();
+        if (limitSamples > 0)
+            numSamples = (int)juce::jmin((juce::int64)numSamples, limitSamples - samplesDone);
+
+        //The block is due once its audio would have been captured at real time
+        const double blockMs = 1000.0 * numSamples / options.sampleRate;
+        const double dueMs = startMs + 1000.0 * (double)(samplesDone + numSamples) / options.sampleRate;
+
+        renderInput(numSamples);
+
+        if (options.realtime)
+            waitUntil(dueMs + (options.jitterMs > 0.0 ? random.nextDouble() * options.jitterMs : 0.0));
+
+        const double callbackStartMs = juce::Time::getMillisecondCounterHiRes();
+        hostTimeNs = (juce::uint64)((double)samplesDone * 1.0e9 / options.sampleRate);
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        {
+            const juce::ScopedLock sl(callbackLock);
+            if (callback != nullptr)
+                callback->audioDeviceIOCallbackWithContext(inputBuffer.getArrayOfReadPointers(), activeInputs.countNumberOfSetBits(),
+                                                           outputBuffer.getArrayOfWritePointers(), activeOutputs.countNumberOfSetBits(),
+                                                           numSamples, context);
+        }
+        const double durationUs = (double)(juce::Time::getHighResolutionTicks() - startTicks) * ticksToUs;
+
+        //Real time: the output was needed one block after it was due. Fast: the callback
+        //itself must fit in the block's duration.
+        const double deadlineMs = options.realtime ? dueMs + blockMs : callbackStartMs + blockMs;
+        const bool xrun = callbackStartMs + durationUs * 0.001 > deadlineMs;
+        if (xrun) xrunCount.fetch_add(1);
+
+        recordTiming({ callbackStartMs - startMs, durationUs, numSamples, xrun });
+        samplesDone += numSamples;
+    }
+}
+
+//==============================================================================
+
+juce::Array<SimulatedAudioDevice::CallbackTiming> SimulatedAudioDevice::getTimings() const
+{
+    const juce::ScopedLock sl(timingLock);
+    return timings;
+}
+
+bool SimulatedAudioDevice::writeTimingsCsv(const juce::File& file) const
+{
+    const auto recorded = getTimings();
+
+    juce::String csv;
+    csv.preallocateBytes((size_t)recorded.size() * 40 + 64);
+    csv << "index,start_ms,samples,duration_us,budget_percent,xrun\n";
+
+    for (int i = 0; i < recorded.size(); ++i)
+    {
+        const auto& t = recorded.getReference(i);
+        const double budgetUs = 1.0e6 * t.numSamples / options.sampleRate;
+        csv << i << "," << juce::String(t.startMs, 3) << "," << t.numSamples << "," << juce::String(t.durationUs, 2) << ","
+            << juce::String(100.0 * t.durationUs / budgetUs, 2) << "," << (t.xrun ? 1 : 0) << "\n";
+    }
+
+    return file.replaceWithText(csv);
+}
+
+juce::String SimulatedAudioDevice::getSummary() const
+{
+    const juce::ScopedLock sl(timingLock);
+
+    const double audioSeconds = (double)totalSamples / options.sampleRate;
+    const double meanUs = totalCallbacks > 0 ? totalCallbackUs / (double)totalCallbacks : 0.0;
+
+    juce::String s;
+    s << "Simulated " << juce::String(audioSeconds, 2) << " s of audio at " << juce::String(options.sampleRate, 0) << " Hz in "
+      << juce::String(runWallMs * 0.001, 2) << " s (" << (options.realtime ? "real time" : "as fast as possible") << ")" << juce::newLine
+      << (int)totalCallbacks << " callbacks, mean " << juce::String(meanUs, 1) << " us, max " << juce::String(maxCallbackUs, 1)
+      << " us, " << xrunCount.load() << " xrun(s)" << juce::newLine;
+    return s;
+}
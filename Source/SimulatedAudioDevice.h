@@ -0,0 +1,156 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+
+//Virtual audio device for end-to-end runs without a sound card. A worker thread
+//drives the callback with input read from a file (looped, resampled to the device
+//rate) or a generator, either as fast as the CPU allows or paced at exact simulated
+//real time with optional wake-up jitter. Every callback's timing is recorded, and a
+//callback that finishes after its block's real-time deadline counts as an xrun.
+//
+//Registered through SimulatedAudioDeviceType, so the normal AudioDeviceManager path
+//(and MainComponent's device callbacks) runs unchanged.
+class SimulatedAudioDevice : public juce::AudioIODevice,
+    private juce::Thread
+{
+public:
+    struct Options
+    {
+        enum class Signal { sine, noise, silence, file };
+        Signal signal = Signal::sine;
+        juce::File file;                //Signal::file
+        float frequencyHz = 997.0f;     //Signal::sine
+        float levelDb = -12.0f;         //generators
+
+        double sampleRate = 48000.0;
+        int bufferSize = 512;
+        int minBlockSize = 0;           //> 0: each callback gets a random size in [minBlockSize, bufferSize]
+        int numInputChannels = 2;
+        int numOutputChannels = 2;
+
+        bool realtime = false;          //false: as fast as the CPU allows
+        double jitterMs = 0.0;          //realtime: random extra wake-up delay in [0, jitterMs]
+        double durationSeconds = 0.0;   //of audio; 0 = until stopped
+        bool startPaused = false;       //no callbacks until setPaused(false)
+        juce::int64 seed = 1;           //for noise, jitter and block sizes
+
+        //Called once on the device thread when durationSeconds of audio have been processed
+        std::function<void()> onFinished;
+
+        //"--simulate <sine|noise|silence|file>" plus the flags documented in the README
+        static Options fromArguments(const juce::StringArray& args);
+    };
+
+    struct CallbackTiming
+    {
+        double startMs;      //since the run started (wall clock)
+        double durationUs;   //time spent inside the callback
+        int numSamples;
+        bool xrun;           //finished after the block's real-time deadline
+    };
+
+    explicit SimulatedAudioDevice(const Options& options);
+    ~SimulatedAudioDevice() override;
+
+    //Any thread
+    void setPaused(bool shouldBePaused) noexcept { paused.store(shouldBePaused); }
+    bool isFinished() const noexcept { return finished.load(); }
+
+    //Recorded timings (the oldest maxTimings callbacks are kept; later ones only go into the counters)
+    static constexpr int maxTimings = 1 << 18;
+    juce::Array<CallbackTiming> getTimings() const;
+    bool writeTimingsCsv(const juce::File& file) const;
+    juce::String getSummary() const;
+
+    //AudioIODevice
+    juce::StringArray getOutputChannelNames() override;
+    juce::StringArray getInputChannelNames() override;
+    juce::Array<double> getAvailableSampleRates() override;
+    juce::Array<int> getAvailableBufferSizes() override;
+    int getDefaultBufferSize() override;
+
+    juce::String open(const juce::BigInteger& inputChannels, const juce::BigInteger& outputChannels,
+                      double sampleRate, int bufferSizeSamples) override;
+    void close() override;
+    bool isOpen() override;
+
+    void start(juce::AudioIODeviceCallback* callback) override;
+    void stop() override;
+    bool isPlaying() override;
+
+    juce::String getLastError() override { return lastError; }
+    int getCurrentBufferSizeSamples() override { return options.bufferSize; }
+    double getCurrentSampleRate() override { return options.sampleRate; }
+    int getCurrentBitDepth() override { return 32; }
+    juce::BigInteger getActiveOutputChannels() const override { return activeOutputs; }
+    juce::BigInteger getActiveInputChannels() const override { return activeInputs; }
+    int getOutputLatencyInSamples() override { return 0; }
+    int getInputLatencyInSamples() override { return 0; }
+    int getXRunCount() const noexcept override { return xrunCount.load(); }
+
+private:
+    void run() override;
+
+    int nextBlockSize() noexcept;
+    void renderInput(int numSamples);
+    void waitUntil(double wallMs);
+    void recordTiming(const CallbackTiming& timing);
+
+    Options options;
+    juce::String lastError;
+    juce::BigInteger activeInputs, activeOutputs;
+    bool opened = false;
+
+    //Device thread
+    juce::AudioBuffer<float> inputBuffer, outputBuffer;
+    juce::AudioFormatManager formatManager;
+    std::unique_ptr<juce::AudioFormatReaderSource> readerSource;
+    std::unique_ptr<juce::ResamplingAudioSource> resampler;
+    juce::Random random;
+    double phase = 0.0;
+
+    juce::CriticalSection callbackLock;
+    juce::AudioIODeviceCallback* callback = nullptr;
+
+    std::atomic<bool> paused{ false };
+    std::atomic<bool> finished{ false };
+    std::atomic<int> xrunCount{ 0 };
+
+    mutable juce::CriticalSection timingLock;
+    juce::Array<CallbackTiming> timings;
+    juce::int64 totalCallbacks = 0, totalSamples = 0;
+    double totalCallbackUs = 0.0, maxCallbackUs = 0.0, runWallMs = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SimulatedAudioDevice)
+};
+
+//Device type with a single simulated device, configured by Options
+class SimulatedAudioDeviceType : public juce::AudioIODeviceType
+{
+public:
+    static constexpr const char* typeName = "Simulated";
+    static constexpr const char* deviceName = "Simulated device";
+
+    explicit SimulatedAudioDeviceType(const SimulatedAudioDevice::Options& optionsIn)
+        : juce::AudioIODeviceType(typeName), options(optionsIn) {}
+
+    void scanForDevices() override {}
+    juce::StringArray getDeviceNames(bool) const override { return { deviceName }; }
+    int getDefaultDeviceIndex(bool) const override { return 0; }
+    int getIndexOfDevice(juce::AudioIODevice* device, bool) const override
+    {
+        return dynamic_cast<SimulatedAudioDevice*>(device) != nullptr ? 0 : -1;
+    }
+    bool hasSeparateInputsAndOutputs() const override { return false; }
+
+    juce::AudioIODevice* createDevice(const juce::String&, const juce::String&) override
+    {
+        return new SimulatedAudioDevice(options);
+    }
+
+private:
+    SimulatedAudioDevice::Options options;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SimulatedAudioDeviceType)
+};
@@ -1,139 +1,486 @@
 #pragma once
 #include <JuceHeader.h>
+#include <atomic>
 
-//Real-time spectrum analyzer (single trace) with overlap + smoothing
+#include "TraceRenderer.h"
+#include "TripleBuffer.h"
+#include "VisualizerComponent.h"
 
-class SpectrumAnalyzer : public juce::Component
+//Real-time spectrum analyzer (single trace) with overlap + smoothing.
+//Finished frames are handed to the render thread through a lock-free triple buffer.
+
+class SpectrumAnalyzer : public VisualizerComponent
 {
 public:
     explicit SpectrumAnalyzer(int fftOrder = 12)
-        : order(fftOrder),
+        : VisualizerComponent("spectrum"),
+        order(fftOrder),
         fftSize(1 << order),
-        hopSize(fftSize / 4), // 4x overlap
+        hopSize(fftSize / 4), // 4x overlap (lowered under load, see setOverlap)
         window(fftSize, juce::dsp::WindowingFunction<float>::hann, true /*normalise*/),
         fft(order),
         fifo(fftSize, 0.0f),
+        fftBuffer(2 * fftSize, 0.0f),
         magDb(fftSize / 2, -120.0f),
         magDbEma(fftSize / 2, -120.0f)
     {
+        //Every slot can hold either a full-band or a zoomed frame
+        const int maxBins = juce::jmax(fftSize / 2, 1 << zoomOrder);
+        frames.forEachSlot([maxBins](SpectrumFrame& f) { f.dB.assign((size_t)maxBins, -120.0f); });
+
+        //The overlap ring never holds more than fftSize samples
+        ring.reserve((size_t)fftSize);
+
         setOpaque(true);
     }
 
-    void setDbRange(float minDbIn, float maxDbIn) { minDb = minDbIn; maxDb = maxDbIn; repaint(); }
-    void setFreqRange(float minHz, float maxHz) { minFreq = minHz; maxFreq = maxHz; repaint(); }
-    void setSampleRate(double sr) { sampleRate = (sr > 0.0 ? sr : 44100.0); }
+    ~SpectrumAnalyzer() override { stopRendering(); }
+
+    //Any thread; the render thread picks the new range up at its next frame
+    void setDbRange(float minDbIn, float maxDbIn) { minDb.store(minDbIn); maxDb.store(maxDbIn); requestFrame(); }
+    void setFreqRange(float minHz, float maxHz) { minFreq.store(minHz); maxFreq.store(maxHz); requestFrame(); }
+    void setSampleRate(double sr)
+    {
+        sampleRate = (sr > 0.0 ? sr : 44100.0);
+
+        //Zoom filters depend on the rate; rebuild on the message thread
+        juce::MessageManager::callAsync([safe = juce::Component::SafePointer<SpectrumAnalyzer>(this)]
+            {
+                if (safe != nullptr && safe->zoom != nullptr)
+                    safe->setZoomBand(safe->zoom->centreHz, safe->zoom->spanHz);
+            });
+    }
     void setSmoothing(float timeAlphaIn, int freqSmoothRadiusIn)
     {
         timeAlpha = juce::jlimit(0.0f, 1.0f, timeAlphaIn);
         freqSmoothRadius = juce::jmax(0, freqSmoothRadiusIn);
     }
 
+    //Zoom-FFT: analyse only [centreHz - spanHz/2, centreHz + spanHz/2] at much finer
+    //resolution. The full-band FFT is skipped while zoomed. Message thread only.
+    void setZoomBand(float centreHz, float spanHz)
+    {
+        const float nyquist = (float)sampleRate * 0.5f;
+        spanHz = juce::jlimit(1.0f, nyquist, spanHz);
+        centreHz = juce::jlimit(spanHz * 0.5f, nyquist - spanHz * 0.5f, centreHz);
+
+        auto newZoom = std::make_unique<ZoomStage>(sampleRate, centreHz, spanHz, zoomOrder);
+        setZoomView({ true, centreHz, spanHz, newZoom->getBinHz() });
+        {
+            const juce::SpinLock::ScopedLockType sl(zoomLock);
+            std::swap(zoom, newZoom);
+        }
+        requestFrame(); //old stage (if any) is freed here, off the audio thread
+    }
+
+    void clearZoom()
+    {
+        std::unique_ptr<ZoomStage> old;
+        {
+            const juce::SpinLock::ScopedLockType sl(zoomLock);
+            std::swap(zoom, old);
+        }
+        setZoomView({});
+        requestFrame();
+    }
+
+    bool isZoomed() const { return zoom != nullptr; }
+
+    //Frames per fftSize samples: 4 (default), 2 or 1. Lower overlap means fewer
+    //FFTs per second; used by the callback's load shedding. Any thread.
+    void setOverlap(int factor) noexcept
+    {
+        hopSize.store(fftSize / juce::jlimit(1, 4, factor), std::memory_order_relaxed);
+    }
+
+    //Average all channels of buffer[startSample, startSample + numSamples) into dest.
+    //Shared by the analyzers that work on a mono signal.
+    static void mixToMono(const juce::AudioBuffer<float>& buffer, int startSample, int numSamples, float* dest)
+    {
+        const int numCh = buffer.getNumChannels();
+        if (numCh <= 0) { juce::FloatVectorOperations::clear(dest, numSamples); return; }
+
+        juce::FloatVectorOperations::copy(dest, buffer.getReadPointer(0, startSample), numSamples);
+        for (int ch = 1; ch < numCh; ++ch)
+            juce::FloatVectorOperations::add(dest, buffer.getReadPointer(ch, startSample), numSamples);
+
+        if (numCh > 1)
+            juce::FloatVectorOperations::multiply(dest, 1.0f / (float)numCh, numSamples);
+    }
+
+    static constexpr int monoChunkSize = 256; //stack scratch for the downmix
+
     void pushSamples(const juce::AudioBuffer<float>& buffer)
     {
-        const int numCh = juce::jmax(1, buffer.getNumChannels());
         const int numSmps = buffer.getNumSamples();
+        float mono[monoChunkSize];
 
-        for (int i = 0; i < numSmps; ++i)
+        //Never wait for the message thread: if it is swapping the zoom stage, skip this block
+        const juce::SpinLock::ScopedTryLockType zoomTryLock(zoomLock);
+        if (!zoomTryLock.isLocked()) return;
+
+        if (clearRequested.exchange(false))
+            resetAnalysis();
+
+        const int hop = hopSize.load(std::memory_order_relaxed);
+
+        for (int start = 0; start < numSmps; start += monoChunkSize)
         {
-            float s = 0.0f;
-            for (int ch = 0; ch < numCh; ++ch) s += buffer.getSample(ch, i);
-            s *= (1.0f / (float)numCh);
+            const int n = juce::jmin(monoChunkSize, numSmps - start);
+            mixToMono(buffer, start, n, mono);
 
-            ring.push_back(s);
-            //When we have >= hopSize new samples beyond the last frame, do a new FFT frame
-            if ((int)ring.size() >= (int)fifo.size() + hopSize)
+            if (zoom != nullptr)
             {
-                //Copy the last fftSize samples into fifo (with 4x overlap)
-                std::copy(ring.end() - fftSize, ring.end(), fifo.begin());
-                computeSpectrum();
-                //Keep only the tail we need for the next overlap frame
-                ring.erase(ring.begin(), ring.end() - (int)fifo.size() + hopSize);
+                for (int done = 0; done < n;)
+                {
+                    done += zoom->process(mono + done, n - done);
+                    if (zoom->frameReady)
+                        computeZoomSpectrum();
+                }
+                continue;
+            }
+
+            for (int i = 0; i < n; ++i)
+            {
+                ring.push_back(mono[i]);
+                //Once the ring holds a full frame, do a new FFT frame
+                if ((int)ring.size() >= fftSize)
+                {
+                    //Copy the last fftSize samples into fifo (overlapping the previous frame)
+                    std::copy(ring.end() - fftSize, ring.end(), fifo.begin());
+                    computeSpectrum();
+                    //Drop one hop, keeping the fftSize - hop samples the next frame overlaps
+                    ring.erase(ring.begin(), ring.begin() + hop);
+                }
             }
         }
     }
 
+    //Path stroking (quality) or direct-to-bitmap rasterizing (speed)
+    void setTraceMode(TraceRenderer::Mode mode) { trace.setMode(mode); requestFrame(); }
+
     void clear()
     {
-        std::fill(magDb.begin(), magDb.end(), minDb);
-        std::fill(magDbEma.begin(), magDbEma.end(), minDb);
-        magDbSmoothed.clear();                //ensure no leftover smoothed trace
-        ring.clear();                         //drop any queued audio
-        repaint();
+        //Hide frames published before now; the analysis state itself is reset on the audio thread
+        clearGeneration.fetch_add(1);
+        clearRequested.store(true);
+        requestFrame();
+    }
+
+    //Double-click zooms around the clicked frequency; double-click again to return to full band
+    void mouseDoubleClick(const juce::MouseEvent& e) override
+    {
+        if (zoom != nullptr) { clearZoom(); return; }
+
+        const auto r = getLocalBounds().toFloat().reduced(1.0f, 2.0f);
+        const float norm = juce::jlimit(0.0f, 1.0f, (e.position.x - r.getX()) / r.getWidth());
+        const float lo = minFreq.load(), hi = maxFreq.load();
+        const float f = lo * std::pow(hi / lo, norm);
+        setZoomBand(f, juce::jlimit(50.0f, 4000.0f, f * 0.5f));
     }
 
-    void paint(juce::Graphics& g) override
+private:
+    //Render thread
+    void renderFrame(juce::Graphics& g, juce::Rectangle<int> bounds) override
     {
         g.fillAll(juce::Colours::lightgrey);
 
-        auto r = getLocalBounds().toFloat().reduced(1.0f, 2.0f); //avoid visual clipping at edges
-        drawGrid(g, r);
+        auto r = bounds.toFloat().reduced(1.0f, 2.0f); //avoid visual clipping at edges
 
-        g.setColour(juce::Colours::lightslategrey);
-        juce::Path p = makeSpectrumPath(r, magDbSmoothed.empty() ? magDbEma : magDbSmoothed);
-        g.strokePath(p, juce::PathStrokeType(1.6f));
+        //One consistent copy of the axes for the whole frame
+        axes = { minDb.load(), maxDb.load(), minFreq.load(), maxFreq.load() };
+
+        //Latest complete frame (one index exchange, no locks)
+        frames.acquire();
+        const auto& frame = frames.getReadBuffer();
+        const bool haveFrame = frame.numBins > 0 && frame.generation == clearGeneration.load();
+
+        //Level of detail: merge bins closer than 1 or 2 px (keeping peaks), no anti-aliasing at the coarsest level
+        const int detail = getDetailLevel();
+        const float minSpacing = detail == 0 ? 0.0f : (float)(1 << (juce::jmin(detail, 2) - 1));
+        const bool lowDetail = detail >= maxDetailLevel;
+
+        const auto view = getZoomView();
+        if (view.active)
+        {
+            const float centre = view.centreHz, span = view.spanHz;
+            drawZoomGrid(g, r, centre, span);
+
+            if (haveFrame && frame.zoomed && frame.zoomCentreHz == centre && frame.zoomSpanHz == span)
+            {
+                trace.begin(g, r, 1.6f, lowDetail);
+                traceZoom(r, frame, minSpacing);
+                trace.finish(g, juce::Colours::lightslategrey);
+            }
+
+            g.setColour(juce::Colours::darkgrey);
+            g.setFont(12.0f);
+            g.drawText("Zoom " + juce::String(centre, 1) + " Hz +/- " + juce::String(span * 0.5f, 1)
+                + " Hz, " + juce::String(view.binHz, 3) + " Hz/bin",
+                r.reduced(6.0f, 4.0f), juce::Justification::topLeft);
+        }
+        else
+        {
+            drawGrid(g, r);
+
+            if (haveFrame && !frame.zoomed)
+            {
+                trace.begin(g, r, 1.6f, lowDetail);
+                traceSpectrum(r, frame, minSpacing);
+                trace.finish(g, juce::Colours::lightslategrey);
+            }
+        }
 
         g.setColour(juce::Colours::lightslategrey);
-        g.drawRect(getLocalBounds());
+        g.drawRect(bounds);
     }
 
-    void resized() override {}
-
-private:
     //FFT & data
     const int order;
     const int fftSize;
-    const int hopSize;
+    std::atomic<int> hopSize;
 
     juce::dsp::WindowingFunction<float> window;
     juce::dsp::FFT fft;
 
     std::vector<float> fifo;          // time domain window (fftSize)
     std::vector<float> ring;          // rolling buffer for overlap
-    std::vector<float> fftBuffer;     // 2 * fftSize (complex)
+    std::vector<float> fftBuffer;     // 2 * fftSize (interleaved complex)
     std::vector<float> magDb;         // per-bin dB (instant)
     std::vector<float> magDbEma;      // per-bin dB (time-smoothed)
-    std::vector<float> magDbSmoothed; // after freq smoothing (optional)
+
+    //Finished frames (audio thread -> render thread)
+    struct SpectrumFrame
+    {
+        std::vector<float> dB;        // preallocated for the largest bin count
+        int   numBins = 0;
+        float firstFreq = 0.0f;       // centre frequency of dB[0]
+        float binHz = 1.0f;
+        bool  zoomed = false;
+        float zoomCentreHz = 0.0f;
+        float zoomSpanHz = 0.0f;
+        int   generation = 0;         // clear() generation the frame belongs to
+    };
+
+    TripleBuffer<SpectrumFrame> frames;
+    std::atomic<int>  clearGeneration{ 0 };
+    std::atomic<bool> clearRequested{ false };
+    int activeGeneration = 0;         // audio thread
+    TraceRenderer trace;              // render thread
 
     //Display params
-    float  minDb = -90.0f;
-    float  maxDb = 6.0f;           //allow headroom above 0 dB to avoid top flattening
-    float  minFreq = 20.0f;
-    float  maxFreq = 20000.0f;
+    std::atomic<float> minDb{ -90.0f };
+    std::atomic<float> maxDb{ 6.0f };  //allow headroom above 0 dB to avoid top flattening
+    std::atomic<float> minFreq{ 20.0f };
+    std::atomic<float> maxFreq{ 20000.0f };
+
+    //Render thread: the range above as of the start of the current frame
+    struct Axes { float minDb, maxDb, minFreq, maxFreq; };
+    Axes axes{ -90.0f, 6.0f, 20.0f, 20000.0f };
     double sampleRate = 44100.0;
 
     //Smoothing
     float timeAlpha = 0.25f;         //0..1 (higher = faster response)
     int   freqSmoothRadius = 1;      //bins to each side (0 disables)
 
+    //Zoom-FFT stage: heterodyne the band centre to DC, low-pass + decimate (only the
+    //kept outputs are computed, i.e. the polyphase form), then a small complex FFT.
+    //Resolution is sampleRate / (decimation * fftSize) instead of sampleRate / fftSize.
+    static constexpr int zoomOrder = 11;
+    static constexpr int maxZoomDecimation = 512;
+
+    struct ZoomStage
+    {
+        ZoomStage(double sr, float centre, float span, int fftOrder)
+            : centreHz(centre), spanHz(span),
+            decimation(juce::jlimit(1, maxZoomDecimation, (int)std::floor(sr / (2.0 * span)))),
+            decimatedRate(sr / (double)decimation),
+            numTaps(16 * decimation + 1),
+            fftSize(1 << fftOrder),
+            hopSize(fftSize / 4),
+            fft(fftOrder)
+        {
+            //Blackman-windowed sinc, unity DC gain. The visible band ends at span/2 and the
+            //first alias lands at decimatedRate - span/2 >= 1.5 * span, so the cutoff sits
+            //midway at span: the ~0.7 * span wide transition of 16 * D + 1 taps then keeps the
+            //band edges flat (< 0.1 dB) with the aliases > 75 dB down.
+            const double fc = juce::jmin(0.45, (double)span / sr);
+            taps.resize(numTaps);
+            double sum = 0.0;
+            for (int k = 0; k < numTaps; ++k)
+            {
+                const double m = k - 0.5 * (numTaps - 1);
+                const double sinc = m == 0.0 ? 2.0 * fc : std::sin(juce::MathConstants<double>::twoPi * fc * m) / (juce::MathConstants<double>::pi * m);
+                const double w = 0.42 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * k / (numTaps - 1))
+                    + 0.08 * std::cos(2.0 * juce::MathConstants<double>::twoPi * k / (numTaps - 1));
+                taps[k] = (float)(sinc * w);
+                sum += sinc * w;
+            }
+            for (auto& t : taps) t = (float)(t / sum);
+
+            delayRe.assign(2 * numTaps, 0.0f);
+            delayIm.assign(2 * numTaps, 0.0f);
+            oscStep = std::polar(1.0, -juce::MathConstants<double>::twoPi * centre / sr);
+
+            //Hann window normalised to unit mean, so 2/N gives sine amplitude like the full band
+            window.resize(fftSize);
+            for (int i = 0; i < fftSize; ++i)
+                window[i] = 1.0f - std::cos(juce::MathConstants<float>::twoPi * (float)i / (float)fftSize);
+
+            ring.assign(fftSize, {});
+            fftIn.resize(fftSize);
+            fftOut.resize(fftSize);
+            magDbEma.assign(fftSize, -120.0f);
+        }
+
+        float getBinHz() const { return (float)(decimatedRate / fftSize); }
+        float freqForIndex(int i) const { return centreHz + (float)(i - fftSize / 2) * getBinHz(); }
+
+        //Audio thread. Consumes samples until a new frame is due (frameReady) or x runs out;
+        //returns the number of samples consumed.
+        int process(const float* x, int n)
+        {
+            frameReady = false;
+
+            for (int i = 0; i < n; ++i)
+            {
+                //Mix down: band centre -> 0 Hz
+                const std::complex<double> mixed = (double)x[i] * osc;
+                osc *= oscStep;
+
+                delayPos = (delayPos == 0 ? numTaps - 1 : delayPos - 1);
+                delayRe[delayPos] = delayRe[delayPos + numTaps] = (float)mixed.real();
+                delayIm[delayPos] = delayIm[delayPos + numTaps] = (float)mixed.imag();
+
+                if (++phase < decimation) continue;
+                phase = 0;
+                osc /= std::abs(osc); //keep the oscillator on the unit circle
+
+                //Decimated low-pass output (newest sample at delayPos)
+                const float* re = delayRe.data() + delayPos;
+                const float* im = delayIm.data() + delayPos;
+                float accRe = 0.0f, accIm = 0.0f;
+                for (int k = 0; k < numTaps; ++k)
+                {
+                    accRe += taps[k] * re[k];
+                    accIm += taps[k] * im[k];
+                }
+
+                ring[ringPos] = { accRe, accIm };
+                ringPos = (ringPos + 1) % fftSize;
+                filled = juce::jmin(filled + 1, fftSize);
+
+                if (++sinceFrame >= hopSize && filled == fftSize)
+                {
+                    sinceFrame = 0;
+                    frameReady = true;
+                    return i + 1;
+                }
+            }
+
+            return n;
+        }
+
+        //Writes the time-smoothed zoomed bins (ascending frequency) to out
+        void computeFrame(float timeAlpha, float minDb, float maxDb, float* out)
+        {
+            for (int i = 0; i < fftSize; ++i)
+                fftIn[i] = ring[(ringPos + i) % fftSize] * window[i];
+
+            fft.perform(fftIn.data(), fftOut.data(), false);
+
+            //fftshift so index 0 is the lowest frequency (centre - decimatedRate / 2)
+            const float scale = 2.0f / (float)fftSize;
+            constexpr float eps = 1.0e-12f;
+            for (int i = 0; i < fftSize; ++i)
+            {
+                const int bin = (i + fftSize / 2) % fftSize;
+                const float dB = juce::jlimit(minDb, maxDb, 20.0f * std::log10(std::abs(fftOut[bin]) * scale + eps));
+                out[i] = magDbEma[i] = timeAlpha * dB + (1.0f - timeAlpha) * magDbEma[i];
+            }
+        }
+
+        void reset()
+        {
+            std::fill(delayRe.begin(), delayRe.end(), 0.0f);
+            std::fill(delayIm.begin(), delayIm.end(), 0.0f);
+            std::fill(ring.begin(), ring.end(), std::complex<float>{});
+            std::fill(magDbEma.begin(), magDbEma.end(), -120.0f);
+            osc = { 1.0, 0.0 };
+            delayPos = phase = ringPos = filled = sinceFrame = 0;
+            frameReady = false;
+        }
+
+        const float centreHz, spanHz;
+        const int decimation;
+        const double decimatedRate;
+        const int numTaps, fftSize, hopSize;
+
+        juce::dsp::FFT fft;
+        std::vector<float> taps, delayRe, delayIm, window;
+        std::complex<double> osc{ 1.0, 0.0 }, oscStep;
+        int delayPos = 0, phase = 0;
+
+        std::vector<std::complex<float>> ring, fftIn, fftOut; // decimated stream + FFT scratch
+        int ringPos = 0, filled = 0, sinceFrame = 0;
+        bool frameReady = false;
+        std::vector<float> magDbEma;                          // zoomed bins, ascending frequency
+    };
+
+    std::unique_ptr<ZoomStage> zoom;   // swapped on the message thread under zoomLock
+
+    //Zoom band as seen by the renderer (written on the message thread)
+    struct ZoomView
+    {
+        bool  active = false;
+        float centreHz = 0.0f, spanHz = 0.0f, binHz = 0.0f;
+    };
+
+    juce::SpinLock viewLock;           // message thread <-> render thread only
+    ZoomView zoomView;
+
+    void setZoomView(const ZoomView& v)
+    {
+        const juce::SpinLock::ScopedLockType sl(viewLock);
+        zoomView = v;
+    }
+
+    ZoomView getZoomView()
+    {
+        const juce::SpinLock::ScopedLockType sl(viewLock);
+        return zoomView;
+    }
+    juce::SpinLock zoomLock;           // audio thread only ever try-locks it
+
     void computeSpectrum()
     {
-        if ((int)fftBuffer.size() < 2 * fftSize) fftBuffer.resize(2 * fftSize, 0.0f);
-        std::fill(fftBuffer.begin(), fftBuffer.end(), 0.0f);
+        RESONANCE_TRACE_SCOPE("computeSpectrum", "analysis");
 
-        //Copy + window
-        std::vector<float> temp(fifo.begin(), fifo.end());
-        window.multiplyWithWindowingTable(temp.data(), fftSize);
-        std::copy(temp.begin(), temp.end(), fftBuffer.begin());
+        //Copy + window (fftBuffer is preallocated to 2 * fftSize)
+        std::copy(fifo.begin(), fifo.end(), fftBuffer.begin());
+        std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+        window.multiplyWithWindowingTable(fftBuffer.data(), (size_t)fftSize);
 
-        //FFT
-        fft.performRealOnlyForwardTransform(fftBuffer.data());
+        //FFT (output is interleaved re/im pairs)
+        fft.performRealOnlyForwardTransform(fftBuffer.data(), true);
 
         //Magnitude (single-sided) + normalization
+        const float floorDb = minDb.load(), ceilingDb = maxDb.load();
         const float singleSided = 2.0f / (float)fftSize;
         constexpr float eps = 1.0e-12f;
 
         for (int bin = 0; bin < fftSize / 2; ++bin)
         {
-            const float re = fftBuffer[bin];
-            const float im = fftBuffer[fftSize + bin];
+            const float re = fftBuffer[2 * bin];
+            const float im = fftBuffer[2 * bin + 1];
             float lin = std::sqrt(re * re + im * im) * singleSided;
 
             float dB = 20.0f * std::log10(lin + eps);
 
             //Keep a tiny headroom so the line doesn't hit the very top pixel
             constexpr float headroom = 0.8f; // dB
-            dB = juce::jmin(dB, maxDb - headroom);
-            dB = juce::jlimit(minDb, maxDb, dB);
+            dB = juce::jmin(dB, ceilingDb - headroom);
+            dB = juce::jlimit(floorDb, ceilingDb, dB);
 
             magDb[bin] = dB;
         }
@@ -142,12 +489,13 @@ private:
         for (int bin = 0; bin < fftSize / 2; ++bin)
             magDbEma[bin] = timeAlpha * magDb[bin] + (1.0f - timeAlpha) * magDbEma[bin];
 
+        //Output goes straight into the writer's frame slot
+        auto& frame = frames.getWriteBuffer();
+        float* out = frame.dB.data();
+
         //Optional frequency smoothing (simple weighted moving average)
         if (freqSmoothRadius > 0)
         {
-            if ((int)magDbSmoothed.size() != fftSize / 2)
-                magDbSmoothed.assign(fftSize / 2, minDb);
-
             const int N = (int)magDbEma.size();
             for (int i = 0; i < N; ++i)
             {
@@ -160,50 +508,113 @@ private:
                     wsum += w;
                     vsum += w * magDbEma[j];
                 }
-                magDbSmoothed[i] = vsum / juce::jmax(1.0f, wsum);
+                out[i] = vsum / juce::jmax(1.0f, wsum);
             }
         }
         else
         {
-            magDbSmoothed.clear();
+            std::copy(magDbEma.begin(), magDbEma.end(), out);
         }
 
-        juce::MessageManager::callAsync([this]() { repaint(); });
+        frame.numBins = fftSize / 2;
+        frame.binHz = static_cast<float>(sampleRate) / static_cast<float>(fftSize);
+        frame.firstFreq = 0.5f * frame.binHz; //bin *center* frequencies
+        frame.zoomed = false;
+        publishFrame();
+    }
+
+    void computeZoomSpectrum()
+    {
+        RESONANCE_TRACE_SCOPE("computeZoomSpectrum", "analysis");
+
+        auto& frame = frames.getWriteBuffer();
+        zoom->computeFrame(timeAlpha, minDb.load(), maxDb.load(), frame.dB.data());
+
+        frame.numBins = zoom->fftSize;
+        frame.binHz = zoom->getBinHz();
+        frame.firstFreq = zoom->freqForIndex(0);
+        frame.zoomed = true;
+        frame.zoomCentreHz = zoom->centreHz;
+        frame.zoomSpanHz = zoom->spanHz;
+        publishFrame();
+    }
+
+    void publishFrame()
+    {
+        frames.getWriteBuffer().generation = activeGeneration;
+        frames.publish();
+        requestFrame();
+    }
+
+    //Audio thread, on request from clear()
+    void resetAnalysis()
+    {
+        activeGeneration = clearGeneration.load();
+        std::fill(magDb.begin(), magDb.end(), minDb.load());
+        std::fill(magDbEma.begin(), magDbEma.end(), minDb.load());
+        ring.clear();                         //drop any queued audio
+        if (zoom != nullptr) zoom->reset();
     }
 
     //Rendering helpers
     float xForFreq(float f, juce::Rectangle<float> r) const
     {
-        f = juce::jlimit(minFreq, maxFreq, f);
-        const float norm = (std::log10(f) - std::log10(minFreq))
-            / (std::log10(maxFreq) - std::log10(minFreq));
+        f = juce::jlimit(axes.minFreq, axes.maxFreq, f);
+        const float norm = (std::log10(f) - std::log10(axes.minFreq))
+            / (std::log10(axes.maxFreq) - std::log10(axes.minFreq));
         return r.getX() + norm * r.getWidth();
     }
 
     float yForDb(float dB, juce::Rectangle<float> r) const
     {
         //Top = maxDb
-        const float t = (dB - maxDb) / (minDb - maxDb);
+        const float t = (dB - axes.maxDb) / (axes.minDb - axes.maxDb);
         const float y = r.getY() + juce::jlimit(0.0f, 1.0f, t) * r.getHeight();
         return juce::jlimit(r.getY(), r.getBottom() - 1.0f, y);
     }
 
-    juce::Path makeSpectrumPath(juce::Rectangle<float> r, const std::vector<float>& dBvals) const
+    //Feeds vertices to the trace, merging any closer than minSpacing px and keeping the highest of them
+    struct PeakDecimator
+    {
+        TraceRenderer& trace;
+        float minSpacing;
+        bool started = false, pending = false;
+        float lastX = 0.0f, peakX = 0.0f, peakY = 0.0f;
+
+        void add(float x, float y)
+        {
+            if (!pending || y < peakY) { peakX = x; peakY = y; }
+            pending = true;
+
+            if (!started || x - lastX >= minSpacing) flush();
+        }
+
+        void flush()
+        {
+            if (!pending) return;
+            if (!started) { trace.startNewSubPath(peakX, peakY); started = true; }
+            else          trace.lineTo(peakX, peakY);
+            lastX = peakX;
+            pending = false;
+        }
+    };
+
+    void traceSpectrum(juce::Rectangle<float> r, const SpectrumFrame& frame, float minSpacing)
     {
-        juce::Path p;
-        if (dBvals.empty()) return p;
+        const auto& dBvals = frame.dB;
 
-        //bin frequency resolution
-        const float binHz = static_cast<float>(sampleRate) / static_cast<float>(fftSize);
+        //bin frequency resolution (of the rate the frame was computed at)
+        const float binHz = frame.binHz;
 
         //pick first/last bins that fall inside your chosen freq range, skip DC
-        const int firstBin = juce::jmax(1, (int)std::ceil(minFreq / binHz));
-        const int lastBin = juce::jmin((int)std::floor(maxFreq / binHz), fftSize / 2 - 1);
-        if (firstBin >= lastBin) return p;
+        const int firstBin = juce::jmax(1, (int)std::ceil(axes.minFreq / binHz));
+        const int lastBin = juce::jmin((int)std::floor(axes.maxFreq / binHz), frame.numBins - 1);
+        if (firstBin >= lastBin) return;
 
+        PeakDecimator points{ trace, minSpacing };
         const float xLeft = r.getX();                      // left pixel of the plot rect
         const float yFirst = yForDb(dBvals[firstBin], r);
-        p.startNewSubPath(xLeft, yFirst);
+        points.add(xLeft, yFirst);
 
         //Draw the rest of the spectrum using bin *center* frequencies
         for (int bin = firstBin; bin <= lastBin; ++bin)
@@ -211,10 +622,9 @@ private:
             const float fCenter = (bin + 0.5f) * binHz;     // center of this FFT bin
             const float x = xForFreq(fCenter, r);
             const float y = yForDb(dBvals[bin], r);
-            p.lineTo(x, y);
+            points.add(x, y);
         }
-
-        return p;
+        points.flush();
     }
 
     void drawGrid(juce::Graphics& g, juce::Rectangle<float> r) const
@@ -222,7 +632,7 @@ private:
         g.setColour(juce::Colours::darkgrey.withAlpha(0.25f));
 
         //Horizontal dB lines every 12 dB
-        for (float d = maxDb; d >= minDb; d -= 12.0f)
+        for (float d = axes.maxDb; d >= axes.minDb; d -= 12.0f)
         {
             const float y = yForDb(d, r);
             g.drawHorizontalLine((int)std::round(y), r.getX(), r.getRight());
@@ -232,10 +642,51 @@ private:
         const float freqs[] = { 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000 };
         for (float f : freqs)
         {
-            if (f < minFreq || f > maxFreq) continue;
+            if (f < axes.minFreq || f > axes.maxFreq) continue;
             const float x = xForFreq(f, r);
             g.drawVerticalLine((int)std::round(x), r.getY(), r.getBottom());
         }
     }
+
+    //Zoomed view uses a linear frequency axis over the requested span
+    float xForZoomFreq(float f, juce::Rectangle<float> r, float centreHz, float spanHz) const
+    {
+        const float norm = (f - (centreHz - 0.5f * spanHz)) / spanHz;
+        return r.getX() + juce::jlimit(0.0f, 1.0f, norm) * r.getWidth();
+    }
+
+    void traceZoom(juce::Rectangle<float> r, const SpectrumFrame& frame, float minSpacing)
+    {
+        const float lo = frame.zoomCentreHz - 0.5f * frame.zoomSpanHz;
+        const float hi = frame.zoomCentreHz + 0.5f * frame.zoomSpanHz;
+
+        PeakDecimator points{ trace, minSpacing };
+        for (int i = 0; i < frame.numBins; ++i)
+        {
+            const float f = frame.firstFreq + (float)i * frame.binHz;
+            if (f < lo || f > hi) continue;
+
+            const float x = xForZoomFreq(f, r, frame.zoomCentreHz, frame.zoomSpanHz);
+            points.add(x, yForDb(frame.dB[i], r));
+        }
+        points.flush();
+    }
+
+    void drawZoomGrid(juce::Graphics& g, juce::Rectangle<float> r, float centreHz, float spanHz) const
+    {
+        g.setColour(juce::Colours::darkgrey.withAlpha(0.25f));
+
+        for (float d = axes.maxDb; d >= axes.minDb; d -= 12.0f)
+            g.drawHorizontalLine((int)std::round(yForDb(d, r)), r.getX(), r.getRight());
+
+        //1-2-5 step giving roughly 8 divisions
+        const float rough = spanHz / 8.0f;
+        const float decade = std::pow(10.0f, std::floor(std::log10(rough)));
+        const float step = rough >= 5.0f * decade ? 5.0f * decade : (rough >= 2.0f * decade ? 2.0f * decade : decade);
+
+        const float lo = centreHz - 0.5f * spanHz;
+        for (float f = std::ceil(lo / step) * step; f <= lo + spanHz; f += step)
+            g.drawVerticalLine((int)std::round(xForZoomFreq(f, r, centreHz, spanHz)), r.getY(), r.getBottom());
+    }
 };
 
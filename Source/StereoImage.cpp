@@ -1,24 +1,27 @@
 #include "StereoImage.h"
+#include "RealtimeSanitizer.h"
 
 StereoImage::StereoImage()
-    : writeIndex(0)
+    : VisualizerComponent("stereo image"),
+    writeIndex(0)
 {
     sampleHistory.resize(maxHistorySize);
     setOpaque(true);
 }
 
-StereoImage::~StereoImage() {}
+StereoImage::~StereoImage() { stopRendering(); }
 
 void StereoImage::clear()
 {
     const juce::ScopedWriteLock writeLock(lock);
     std::fill(sampleHistory.begin(), sampleHistory.end(), StereoSample{ 0.0f, 0.0f });
     writeIndex.store(0);
-    repaint();
+    requestFrame();
 }
 
 void StereoImage::pushSamples(const juce::AudioBuffer<float>& buffer)
 {
+    RESONANCE_RT_BLOCKING("ReadWriteLock::enterWrite");
     const juce::ScopedWriteLock writeLock(lock);
 
     int numSamples = buffer.getNumSamples();
@@ -36,12 +39,12 @@ void StereoImage::pushSamples(const juce::AudioBuffer<float>& buffer)
         writeIndex = (writeIndex + 1) % maxHistorySize;
     }
 
-    juce::MessageManager::callAsync([this]() { repaint(); });
+    requestFrame();
 }
 
-void StereoImage::paint(juce::Graphics& g)
+void StereoImage::renderFrame(juce::Graphics& g, juce::Rectangle<int> area)
 {
-    auto bounds = getLocalBounds().toFloat();
+    auto bounds = area.toFloat();
     g.fillAll(juce::Colours::lightgrey);
 
     juce::Point<float> center(bounds.getCentreX(), bounds.getBottom());
@@ -72,9 +75,12 @@ void StereoImage::paint(juce::Graphics& g)
     // Diagonal right line
     g.drawLine(center.x, center.y, arcPeak.x + (arcPeak.y - center.y), arcPeak.y + 60, 1.5f);
 
-    // Stereo path
-    juce::Path path;
+    // Stereo trace; level of detail keeps every 2nd/4th point and drops anti-aliasing at the coarsest level
+    const int detail = getDetailLevel();
+    const int pointStep = 1 << juce::jmin(detail, 2);
+
     bool started = false;
+    trace.begin(g, bounds, 1.5f, detail >= maxDetailLevel);
 
     const juce::ScopedReadLock readLock(lock);
     int index = writeIndex.load();
@@ -82,7 +88,7 @@ void StereoImage::paint(juce::Graphics& g)
     const float gainX = bounds.getWidth() * 0.5f * 0.95f;  // 95% of width from center
     const float gainY = bounds.getHeight() * 0.95f;        // 95% of height
 
-    for (int i = 0; i < maxHistorySize; ++i)
+    for (int i = 0; i < maxHistorySize; i += pointStep)
     {
         const auto& s = sampleHistory[(index + i) % maxHistorySize];
 
@@ -100,19 +106,15 @@ void StereoImage::paint(juce::Graphics& g)
 
         if (!started)
         {
-            path.startNewSubPath(x, y);
+            trace.startNewSubPath(x, y);
             started = true;
         }
         else
         {
-            path.lineTo(x, y);
+            trace.lineTo(x, y);
         }
     }
 
-    g.setColour(juce::Colours::lightslategrey);
-    g.strokePath(path, juce::PathStrokeType(1.5f));
+    trace.finish(g, juce::Colours::lightslategrey);
 }
 
-void StereoImage::resized()
-{
-}
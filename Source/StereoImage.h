@@ -3,19 +3,24 @@
 #include <vector>
 #include <atomic>
 
-class StereoImage : public juce::Component
+#include "TraceRenderer.h"
+#include "VisualizerComponent.h"
+
+class StereoImage : public VisualizerComponent
 {
 public:
     StereoImage();
     ~StereoImage() override;
 
-    void paint(juce::Graphics& g) override;
-    void resized() override;
-
     void pushSamples(const juce::AudioBuffer<float>& buffer);
     void clear();
 
+    //Path stroking (quality) or direct-to-bitmap rasterizing (speed)
+    void setTraceMode(TraceRenderer::Mode mode) { trace.setMode(mode); requestFrame(); }
+
 private:
+    void renderFrame(juce::Graphics& g, juce::Rectangle<int> bounds) override;
+
     struct StereoSample
     {
         float left;
@@ -27,6 +32,7 @@ private:
     std::atomic<int> writeIndex;
 
     juce::ReadWriteLock lock;
+    TraceRenderer trace;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StereoImage)
 };
@@ -0,0 +1,188 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+//Flight recorder for cross-thread timing problems, off until setEnabled(true).
+//Begin/end and instant events from any thread go into a preallocated ring
+//(lock-free, no allocation; the oldest events are overwritten), and the ring can
+//be written out as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev), so
+//the audio callback, the render thread and the message thread line up on one timeline.
+//
+//Event names and categories must be string literals (only the pointer is stored).
+//While recording is off, a ScopedEvent costs one relaxed atomic load.
+class TraceRecorder
+{
+public:
+    static constexpr int capacity = 1 << 16; //events (power of two)
+    static constexpr int maxThreads = 32;
+
+    static TraceRecorder& getInstance()
+    {
+        static TraceRecorder instance;
+        return instance;
+    }
+
+    void setEnabled(bool shouldRecord) noexcept { enabled.store(shouldRecord); }
+    bool isEnabled() const noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    //Any thread: label the calling thread in the trace (name must be a literal)
+    void nameCurrentThread(const char* name) noexcept
+    {
+        threadNames[getThreadIndex()].store(name, std::memory_order_relaxed);
+    }
+
+    //Any thread
+    void begin(const char* name, const char* category) noexcept   { record(name, category, 'B'); }
+    void end(const char* name, const char* category) noexcept     { record(name, category, 'E'); }
+    void instant(const char* name, const char* category) noexcept { record(name, category, 'i'); }
+
+    //Any thread: flags an xrun/overrun; the UI polls this to dump the ring shortly after
+    void markXrun(const char* what) noexcept
+    {
+        if (!isEnabled()) return;
+        instant(what, "xrun");
+        xrunPending.store(true);
+    }
+
+    bool consumeXrun() noexcept { return xrunPending.exchange(false); }
+
+    class ScopedEvent
+    {
+    public:
+        ScopedEvent(const char* nameIn, const char* categoryIn) noexcept
+            : recorder(getInstance()), name(nameIn), category(categoryIn), active(recorder.isEnabled())
+        {
+            if (active) recorder.begin(name, category);
+        }
+
+        ~ScopedEvent()
+        {
+            if (active) recorder.end(name, category);
+        }
+
+    private:
+        TraceRecorder& recorder;
+        const char* name;
+        const char* category;
+        bool active;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedEvent)
+    };
+
+    //Message thread (allocates): the ring's current contents as Chrome trace JSON
+    juce::String toChromeTraceJson() const
+    {
+        const auto ticksToUs = 1.0e6 / (double)juce::Time::getHighResolutionTicksPerSecond();
+        const juce::uint64 newest = writeIndex.load(std::memory_order_acquire);
+        const juce::uint64 oldest = newest > (juce::uint64)capacity ? newest - (juce::uint64)capacity : 0;
+
+        juce::String json;
+        json.preallocateBytes((size_t)(newest - oldest) * 96 + 4096);
+        json << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        bool first = true;
+        auto separator = [&first, &json] { if (!first) json << ","; first = false; };
+
+        for (int t = 0; t < maxThreads; ++t)
+        {
+            if (auto* name = threadNames[t].load(std::memory_order_relaxed))
+            {
+                separator();
+                json << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << (t + 1)
+                     << ",\"args\":{\"name\":\"" << name << "\"}}";
+            }
+        }
+
+        //Ends whose begin has already been overwritten are dropped, per thread
+        int depth[maxThreads] = {};
+
+        for (auto i = oldest; i < newest; ++i)
+        {
+            const auto& slot = events[(size_t)(i & (juce::uint64)(capacity - 1))];
+
+            //Skip slots that are being rewritten while we read them
+            const auto seqBefore = slot.sequence.load(std::memory_order_acquire);
+            const auto* name = slot.name.load(std::memory_order_relaxed);
+            const auto* category = slot.category.load(std::memory_order_relaxed);
+            const auto ticks = slot.ticks.load(std::memory_order_relaxed);
+            const auto phase = slot.phase.load(std::memory_order_relaxed);
+            const auto thread = slot.thread.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seqBefore != i + 1 || slot.sequence.load(std::memory_order_relaxed) != seqBefore)
+                continue;
+
+            if (phase == 'B') ++depth[thread];
+            else if (phase == 'E' && depth[thread]-- == 0) { depth[thread] = 0; continue; }
+
+            separator();
+            json << "{\"name\":\"" << name << "\",\"cat\":\"" << category << "\",\"ph\":\"" << juce::String::charToString((juce::juce_wchar)phase)
+                 << "\",\"ts\":" << juce::String((double)ticks * ticksToUs, 3) << ",\"pid\":1,\"tid\":" << (int)(thread + 1);
+            if (phase == 'i') json << ",\"s\":\"g\"";
+            json << "}";
+        }
+
+        json << "]}";
+        return json;
+    }
+
+    bool writeChromeTrace(const juce::File& file) const
+    {
+        return file.replaceWithText(toChromeTraceJson());
+    }
+
+private:
+    TraceRecorder()
+    {
+        for (auto& n : threadNames) n.store(nullptr);
+    }
+
+    struct Event
+    {
+        std::atomic<juce::uint64> sequence{ 0 }; //index + 1 once written
+        std::atomic<const char*> name{ nullptr };
+        std::atomic<const char*> category{ nullptr };
+        std::atomic<juce::int64> ticks{ 0 };
+        std::atomic<char> phase{ 0 };
+        std::atomic<juce::uint8> thread{ 0 };
+    };
+
+    void record(const char* name, const char* category, char phase) noexcept
+    {
+        if (!isEnabled()) return;
+
+        const auto ticks = juce::Time::getHighResolutionTicks();
+        const auto thread = (juce::uint8)getThreadIndex();
+        const auto index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+        auto& slot = events[(size_t)(index & (juce::uint64)(capacity - 1))];
+
+        slot.sequence.store(0, std::memory_order_relaxed); //invalid while being written
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.name.store(name, std::memory_order_relaxed);
+        slot.category.store(category, std::memory_order_relaxed);
+        slot.ticks.store(ticks, std::memory_order_relaxed);
+        slot.phase.store(phase, std::memory_order_relaxed);
+        slot.thread.store(thread, std::memory_order_relaxed);
+        slot.sequence.store(index + 1, std::memory_order_release);
+    }
+
+    int getThreadIndex() noexcept
+    {
+        thread_local int index = -1;
+        if (index < 0)
+            index = juce::jmin(nextThreadIndex.fetch_add(1), maxThreads - 1); //overflow threads share the last row
+        return index;
+    }
+
+    std::atomic<bool> enabled{ false };
+    std::atomic<bool> xrunPending{ false };
+    std::atomic<juce::uint64> writeIndex{ 0 };
+    std::atomic<int> nextThreadIndex{ 0 };
+    std::atomic<const char*> threadNames[maxThreads];
+
+    Event events[capacity];
+
+    JUCE_DECLARE_NON_COPYABLE(TraceRecorder)
+};
+
+//Traces the enclosing scope; name and category must be string literals
+#define RESONANCE_TRACE_SCOPE(name, category) const TraceRecorder::ScopedEvent JUCE_JOIN_MACRO(traceScope_, __LINE__)(name, category)
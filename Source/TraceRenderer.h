@@ -0,0 +1,208 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <vector>
+
+//Polyline renderer shared by the high-rate traces (oscilloscope, spectrum, stereo).
+//Quality mode builds a juce::Path and strokes it as before. Speed mode skips path
+//stroking entirely: each segment is scan-converted as anti-aliased pixel spans
+//(Wu-style box coverage) into an 8-bit coverage mask, which is then expanded to
+//pixels through a 256-entry colour table and blitted as one image.
+//
+//Usage per paint: begin() -> startNewSubPath()/lineTo() ... -> finish().
+
+class TraceRenderer
+{
+public:
+    enum class Mode { quality, speed };
+
+    //Any thread; picked up at the next begin()
+    void setMode(Mode newMode) noexcept { requestedMode.store(newMode); }
+    Mode getMode() const noexcept { return requestedMode.load(); }
+
+    //area: component-space rectangle the trace is drawn in (also the clip for speed mode).
+    //lowDetail forces the bitmap path with hard-edged (non anti-aliased) spans.
+    void begin(juce::Graphics& g, juce::Rectangle<float> area, float thicknessIn, bool lowDetail = false)
+    {
+        mode = lowDetail ? Mode::speed : requestedMode.load();
+        antialias = !lowDetail;
+        bounds = area;
+        thickness = thicknessIn;
+        started = false;
+
+        if (mode == Mode::quality)
+        {
+            path.clear();
+            return;
+        }
+
+        //Rasterize at physical resolution so HiDPI stays sharp
+        scale = juce::jmax(1.0f, g.getInternalContext().getPhysicalPixelScaleFactor());
+        const int w = juce::jmax(1, (int)std::ceil(area.getWidth() * scale));
+        const int h = juce::jmax(1, (int)std::ceil(area.getHeight() * scale));
+
+        if (!image.isValid() || image.getWidth() != w || image.getHeight() != h)
+        {
+            image = juce::Image(juce::Image::ARGB, w, h, true);
+            coverage.assign((size_t)w * (size_t)h, 0);
+            imageWidth = w;
+            imageHeight = h;
+            previousDirty = {};
+        }
+
+        dirty = {};
+        halfWidth = 0.5f * thickness * scale;
+    }
+
+    void startNewSubPath(float x, float y)
+    {
+        if (mode == Mode::quality) { path.startNewSubPath(x, y); return; }
+
+        lastX = toPixelX(x);
+        lastY = toPixelY(y);
+        started = true;
+    }
+
+    void lineTo(float x, float y)
+    {
+        if (mode == Mode::quality) { path.lineTo(x, y); return; }
+        if (!started) { startNewSubPath(x, y); return; }
+
+        const float px = toPixelX(x), py = toPixelY(y);
+        rasterizeSegment(lastX, lastY, px, py);
+        lastX = px;
+        lastY = py;
+    }
+
+    void finish(juce::Graphics& g, juce::Colour colour)
+    {
+        if (mode == Mode::quality)
+        {
+            g.setColour(colour);
+            g.strokePath(path, juce::PathStrokeType(thickness));
+            return;
+        }
+
+        //Rewrite last frame's pixels too, so anything no longer covered is cleared
+        const auto region = dirty.getUnion(previousDirty).getIntersection({ 0, 0, imageWidth, imageHeight });
+        if (!region.isEmpty())
+        {
+            juce::uint32 table[256];
+            const auto premultiplied = colour.getPixelARGB();
+            for (int a = 0; a < 256; ++a)
+            {
+                auto p = premultiplied;
+                p.multiplyAlpha(a);
+                table[a] = p.getNativeARGB();
+            }
+
+            juce::Image::BitmapData data(image, region.getX(), region.getY(), region.getWidth(), region.getHeight(),
+                juce::Image::BitmapData::writeOnly);
+
+            for (int row = 0; row < region.getHeight(); ++row)
+            {
+                auto* dst = reinterpret_cast<juce::uint32*>(data.getLinePointer(row));
+                auto* cov = coverage.data() + (size_t)(region.getY() + row) * (size_t)imageWidth + (size_t)region.getX();
+
+                for (int col = 0; col < region.getWidth(); ++col)
+                {
+                    dst[col] = table[cov[col]];
+                    cov[col] = 0; //mask is left clean for the next frame
+                }
+            }
+        }
+
+        previousDirty = dirty;
+
+        g.drawImage(image, bounds, juce::RectanglePlacement::stretchToFit);
+    }
+
+private:
+    std::atomic<Mode> requestedMode{ Mode::quality };
+    Mode mode = Mode::quality;   // latched per frame
+    bool antialias = true;
+
+    juce::Rectangle<float> bounds;
+    float thickness = 1.0f;
+    bool started = false;
+
+    //Quality mode
+    juce::Path path;
+
+    //Speed mode (coordinates in physical pixels relative to bounds)
+    juce::Image image;
+    std::vector<juce::uint8> coverage;
+    int imageWidth = 0, imageHeight = 0;
+    float scale = 1.0f;
+    float halfWidth = 0.5f;
+    float lastX = 0.0f, lastY = 0.0f;
+    juce::Rectangle<int> dirty, previousDirty;
+
+    float toPixelX(float x) const noexcept { return (x - bounds.getX()) * scale; }
+    float toPixelY(float y) const noexcept { return (y - bounds.getY()) * scale; }
+
+    //One pixel column (or row) of a thick line: covers [lo, hi] with fractional end pixels
+    template <bool vertical>
+    void coverSpan(int fixed, float lo, float hi) noexcept
+    {
+        const int limit = vertical ? imageHeight : imageWidth;
+        if (fixed < 0 || fixed >= (vertical ? imageWidth : imageHeight)) return;
+
+        const int first = juce::jmax(0, (int)std::floor(lo));
+        const int last = juce::jmin(limit - 1, (int)std::floor(hi));
+        if (first > last) return;
+
+        for (int i = first; i <= last; ++i)
+        {
+            const float overlap = juce::jmin(hi, (float)(i + 1)) - juce::jmax(lo, (float)i);
+            const auto a = antialias ? (juce::uint8)juce::jlimit(0, 255, (int)(overlap * 255.0f + 0.5f))
+                                     : (juce::uint8)(overlap >= 0.5f ? 255 : 0);
+            auto& c = vertical ? coverage[(size_t)i * (size_t)imageWidth + (size_t)fixed]
+                               : coverage[(size_t)fixed * (size_t)imageWidth + (size_t)i];
+            c = juce::jmax(c, a); //max, not add, so joints between segments don't darken
+        }
+
+        dirty = dirty.getUnion(vertical ? juce::Rectangle<int>(fixed, first, 1, last - first + 1)
+                                        : juce::Rectangle<int>(first, fixed, last - first + 1, 1));
+    }
+
+    void rasterizeSegment(float x0, float y0, float x1, float y1) noexcept
+    {
+        const float dx = x1 - x0, dy = y1 - y0;
+
+        if (std::abs(dx) >= std::abs(dy))
+        {
+            //x-major: one vertical span per column, widened by the slope so the stroke keeps its thickness
+            if (x0 > x1) { std::swap(x0, x1); std::swap(y0, y1); }
+            const float slope = dx != 0.0f ? (y1 - y0) / (x1 - x0) : 0.0f;
+            const float hw = halfWidth * std::sqrt(1.0f + slope * slope);
+
+            const int c0 = juce::jmax(0, (int)std::floor(x0));
+            const int c1 = juce::jmin(imageWidth - 1, (int)std::floor(x1));
+            for (int c = c0; c <= c1; ++c)
+            {
+                const float cx = juce::jlimit(x0, x1, (float)c + 0.5f);
+                const float cy = y0 + (cx - x0) * slope;
+                coverSpan<true>(c, cy - hw, cy + hw);
+            }
+        }
+        else
+        {
+            //y-major: one horizontal span per row
+            if (y0 > y1) { std::swap(x0, x1); std::swap(y0, y1); }
+            const float slope = (x1 - x0) / (y1 - y0);
+            const float hw = halfWidth * std::sqrt(1.0f + slope * slope);
+
+            const int r0 = juce::jmax(0, (int)std::floor(y0));
+            const int r1 = juce::jmin(imageHeight - 1, (int)std::floor(y1));
+            for (int r = r0; r <= r1; ++r)
+            {
+                const float cy = juce::jlimit(y0, y1, (float)r + 0.5f);
+                const float cx = x0 + (cy - y0) * slope;
+                coverSpan<false>(r, cx - hw, cx + hw);
+            }
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TraceRenderer)
+};
\ No newline at end of file
@@ -0,0 +1,347 @@
+#include "TransferFunctionAnalyzer.h"
+
+TransferFunctionAnalyzer::TransferFunctionAnalyzer(int fftOrder)
+    : VisualizerComponent("transfer function"),
+    juce::Thread("Transfer function analysis"),
+    order(fftOrder),
+    fftSize(1 << order),
+    hopSize(fftSize / 4), // 4x overlap
+    maxDelay(fftSize / 2),
+    historyMask(2 * fftSize - 1),
+    window(fftSize, juce::dsp::WindowingFunction<float>::hann, true /*normalise*/),
+    fft(order)
+{
+    //Everything the worker touches is sized here, never on the audio thread
+    fifo.prepare(2, 4 * fftSize);
+
+    popRef.resize(popBlockSize, 0.0f);
+    popMeas.resize(popBlockSize, 0.0f);
+    refHistory.resize(2 * fftSize, 0.0f);
+    measHistory.resize(2 * fftSize, 0.0f);
+
+    fftRef.resize(2 * fftSize, 0.0f);
+    fftMeas.resize(2 * fftSize, 0.0f);
+    gxx.resize(fftSize / 2 + 1, 0.0f);
+    gyy.resize(fftSize / 2 + 1, 0.0f);
+    gxy.resize(fftSize / 2 + 1);
+    corrIn.resize(fftSize);
+    corrOut.resize(fftSize);
+
+    //Log-spaced display points between minFreq and maxFreq
+    displayFreqs.resize(numDisplayPoints);
+    for (int p = 0; p < numDisplayPoints; ++p)
+        displayFreqs[p] = minFreq * std::pow(maxFreq / minFreq, (float)p / (float)(numDisplayPoints - 1));
+
+    stagingMagDb.resize(numDisplayPoints, 0.0f);
+    stagingPhaseDeg.resize(numDisplayPoints, 0.0f);
+    stagingCoherence.resize(numDisplayPoints, 0.0f);
+    magDb.resize(numDisplayPoints, 0.0f);
+    phaseDeg.resize(numDisplayPoints, 0.0f);
+    coherence.resize(numDisplayPoints, 0.0f);
+
+    setOpaque(true);
+    startThread();
+}
+
+TransferFunctionAnalyzer::~TransferFunctionAnalyzer()
+{
+    stopRendering();
+    stopThread(2000);
+}
+
+void TransferFunctionAnalyzer::setSampleRate(double sr)
+{
+    sampleRate.store(sr > 0.0 ? sr : 48000.0);
+    resetRequested.store(true);
+}
+
+void TransferFunctionAnalyzer::setInputChannels(int referenceChannelIn, int measurementChannelIn)
+{
+    referenceChannel.store(juce::jmax(0, referenceChannelIn));
+    measurementChannel.store(juce::jmax(0, measurementChannelIn));
+    resetRequested.store(true);
+}
+
+void TransferFunctionAnalyzer::setAveraging(int numFrames)
+{
+    numAverages.store(juce::jmax(1, numFrames));
+}
+
+void TransferFunctionAnalyzer::setDelayCompensation(int samples)
+{
+    delaySamples.store(juce::jlimit(0, maxDelay, samples));
+    resetRequested.store(true);
+}
+
+void TransferFunctionAnalyzer::clear()
+{
+    resetRequested.store(true);
+
+    const juce::ScopedWriteLock writeLock(resultLock);
+    hasResult = false;
+    requestFrame();
+}
+
+void TransferFunctionAnalyzer::pushSamples(const juce::AudioBuffer<float>& buffer)
+{
+    const int ref = referenceChannel.load();
+    const int meas = measurementChannel.load();
+
+    //Needs two distinct inputs (no-op for mono devices)
+    if (ref == meas || juce::jmax(ref, meas) >= buffer.getNumChannels())
+        return;
+
+    const float* channels[2] = { buffer.getReadPointer(ref), buffer.getReadPointer(meas) };
+    fifo.push(channels, buffer.getNumSamples());
+}
+
+//==============================================================================
+//Worker thread
+
+void TransferFunctionAnalyzer::run()
+{
+    float* dest[2] = { popRef.data(), popMeas.data() };
+    TraceRecorder::getInstance().nameCurrentThread("transfer analysis");
+
+    while (!threadShouldExit())
+    {
+        if (resetRequested.exchange(false))
+            resetAnalysis();
+
+        const int got = fifo.pop(dest, popBlockSize);
+        if (got == 0)
+        {
+            wait(10);
+            continue;
+        }
+
+        for (int i = 0; i < got; ++i)
+        {
+            const int idx = (int)(writePos & historyMask);
+            refHistory[idx] = popRef[i];
+            measHistory[idx] = popMeas[i];
+            ++writePos;
+
+            //New frame every hopSize samples once the (delayed) reference window is filled
+            if (++samplesSinceFrame >= hopSize && writePos >= fftSize + delaySamples.load())
+            {
+                samplesSinceFrame = 0;
+                RESONANCE_TRACE_SCOPE("transfer frame", "analysis");
+                processFrame();
+            }
+        }
+
+        if (delayRequested.exchange(false) && framesAveraged > 0)
+            estimateDelay();
+    }
+}
+
+void TransferFunctionAnalyzer::resetAnalysis()
+{
+    fifo.drain();
+    std::fill(refHistory.begin(), refHistory.end(), 0.0f);
+    std::fill(measHistory.begin(), measHistory.end(), 0.0f);
+    std::fill(gxx.begin(), gxx.end(), 0.0f);
+    std::fill(gyy.begin(), gyy.end(), 0.0f);
+    std::fill(gxy.begin(), gxy.end(), std::complex<float>{});
+    writePos = 0;
+    samplesSinceFrame = 0;
+    framesAveraged = 0;
+}
+
+void TransferFunctionAnalyzer::processFrame()
+{
+    //Measurement = last fftSize samples, reference = the same span shifted back by the delay
+    const int delay = juce::jlimit(0, maxDelay, delaySamples.load());
+    const juce::int64 measStart = writePos - fftSize;
+    const juce::int64 refStart = measStart - delay;
+
+    for (int i = 0; i < fftSize; ++i)
+    {
+        fftMeas[i] = measHistory[(int)((measStart + i) & historyMask)];
+        fftRef[i] = refHistory[(int)((refStart + i) & historyMask)];
+    }
+    std::fill(fftRef.begin() + fftSize, fftRef.end(), 0.0f);
+    std::fill(fftMeas.begin() + fftSize, fftMeas.end(), 0.0f);
+
+    window.multiplyWithWindowingTable(fftRef.data(), (size_t)fftSize);
+    window.multiplyWithWindowingTable(fftMeas.data(), (size_t)fftSize);
+
+    //Output is interleaved complex (re, im) for bins 0..fftSize/2
+    fft.performRealOnlyForwardTransform(fftRef.data(), true);
+    fft.performRealOnlyForwardTransform(fftMeas.data(), true);
+
+    //Running mean for the first N frames, then exponential with the same weight
+    const float a = 1.0f / (float)juce::jmin(framesAveraged + 1, numAverages.load());
+    ++framesAveraged;
+
+    for (int k = 0; k <= fftSize / 2; ++k)
+    {
+        const std::complex<float> X(fftRef[2 * k], fftRef[2 * k + 1]);
+        const std::complex<float> Y(fftMeas[2 * k], fftMeas[2 * k + 1]);
+
+        gxx[k] += a * (std::norm(X) - gxx[k]);
+        gyy[k] += a * (std::norm(Y) - gyy[k]);
+        gxy[k] += a * (std::conj(X) * Y - gxy[k]);
+    }
+
+    publishResult();
+}
+
+void TransferFunctionAnalyzer::estimateDelay()
+{
+    //GCC-PHAT: whiten the cross spectrum, inverse FFT, pick the correlation peak
+    const int half = fftSize / 2;
+    for (int k = 0; k <= half; ++k)
+    {
+        const float m = std::abs(gxy[k]);
+        const std::complex<float> w = m > 1.0e-20f ? gxy[k] / m : std::complex<float>{};
+        corrIn[k] = w;
+        if (k > 0 && k < half)
+            corrIn[fftSize - k] = std::conj(w);
+    }
+
+    fft.perform(corrIn.data(), corrOut.data(), true);
+
+    int peak = 0;
+    for (int n = 1; n < fftSize; ++n)
+        if (corrOut[n].real() > corrOut[peak].real())
+            peak = n;
+
+    //Residual lag relative to the compensation already applied
+    const int lag = peak <= half ? peak : peak - fftSize;
+    delaySamples.store(juce::jlimit(0, maxDelay, delaySamples.load() + lag));
+    resetAnalysis();
+}
+
+void TransferFunctionAnalyzer::publishResult()
+{
+    const float binHz = (float)(sampleRate.load() / (double)fftSize);
+    const float halfBand = std::pow(2.0f, 1.0f / 96.0f); // +/- half of a 1/48 octave
+    const int lastBin = fftSize / 2;
+    constexpr float eps = 1.0e-20f;
+
+    for (int p = 0; p < numDisplayPoints; ++p)
+    {
+        //Sum the spectra over the bins covered by this display point
+        const float f = displayFreqs[p];
+        int kLo = juce::jmax(1, (int)std::ceil(f / halfBand / binHz));
+        int kHi = juce::jmin(lastBin, (int)std::floor(f * halfBand / binHz));
+        if (kHi < kLo)
+            kLo = kHi = juce::jlimit(1, lastBin, (int)std::round(f / binHz));
+
+        float sxx = 0.0f, syy = 0.0f;
+        std::complex<float> sxy;
+        for (int k = kLo; k <= kHi; ++k)
+        {
+            sxx += gxx[k];
+            syy += gyy[k];
+            sxy += gxy[k];
+        }
+
+        const float cross = std::abs(sxy);
+        stagingMagDb[p] = 20.0f * std::log10((cross + eps) / (sxx + eps));
+        stagingPhaseDeg[p] = juce::radiansToDegrees(std::arg(sxy));
+        stagingCoherence[p] = juce::jlimit(0.0f, 1.0f, (cross * cross) / (sxx * syy + eps));
+    }
+
+    {
+        const juce::ScopedWriteLock writeLock(resultLock);
+        magDb = stagingMagDb;
+        phaseDeg = stagingPhaseDeg;
+        coherence = stagingCoherence;
+        hasResult = true;
+    }
+
+    requestFrame();
+}
+
+//==============================================================================
+//UI
+
+void TransferFunctionAnalyzer::renderFrame(juce::Graphics& g, juce::Rectangle<int> bounds)
+{
+    g.fillAll(juce::Colours::lightgrey);
+
+    auto r = bounds.toFloat().reduced(1.0f, 2.0f);
+    drawGrid(g, r);
+
+    {
+        const juce::ScopedReadLock readLock(resultLock);
+        if (hasResult)
+        {
+            //Level of detail: every 1st/2nd/4th display point
+            const int step = 1 << juce::jmin(getDetailLevel(), 2);
+
+            //Coherence (0..1) and phase (+/-180) behind the magnitude trace
+            g.setColour(juce::Colours::white.withAlpha(0.7f));
+            g.strokePath(makeTrace(r, coherence, 1.0f, 0.0f, step), juce::PathStrokeType(1.0f));
+
+            g.setColour(juce::Colours::darkgrey.withAlpha(0.5f));
+            g.strokePath(makeTrace(r, phaseDeg, 180.0f, -180.0f, step), juce::PathStrokeType(1.0f));
+
+            g.setColour(juce::Colours::lightslategrey);
+            g.strokePath(makeTrace(r, magDb, dbRange, -dbRange, step), juce::PathStrokeType(1.6f));
+        }
+    }
+
+    //Delay readout
+    const double sr = sampleRate.load();
+    const double delayMs = 1000.0 * (double)delaySamples.load() / sr;
+    g.setColour(juce::Colours::darkgrey);
+    g.setFont(12.0f);
+    g.drawText("Delay " + juce::String(delayMs, 2) + " ms (double-click to find)",
+        r.reduced(6.0f, 4.0f), juce::Justification::topLeft);
+
+    g.setColour(juce::Colours::lightslategrey);
+    g.drawRect(bounds);
+}
+
+void TransferFunctionAnalyzer::mouseDoubleClick(const juce::MouseEvent&)
+{
+    findDelay();
+}
+
+float TransferFunctionAnalyzer::xForFreq(float f, juce::Rectangle<float> r) const
+{
+    f = juce::jlimit(minFreq, maxFreq, f);
+    const float norm = (std::log10(f) - std::log10(minFreq))
+        / (std::log10(maxFreq) - std::log10(minFreq));
+    return r.getX() + norm * r.getWidth();
+}
+
+juce::Path TransferFunctionAnalyzer::makeTrace(juce::Rectangle<float> r, const std::vector<float>& values,
+    float top, float bottom, int step) const
+{
+    juce::Path p;
+    for (int i = 0; i < (int)values.size(); i += step)
+    {
+        const float t = juce::jlimit(0.0f, 1.0f, (values[i] - top) / (bottom - top));
+        const float x = xForFreq(displayFreqs[i], r);
+        const float y = r.getY() + t * (r.getHeight() - 1.0f);
+
+        if (i == 0) p.startNewSubPath(x, y);
+        else        p.lineTo(x, y);
+    }
+    return p;
+}
+
+void TransferFunctionAnalyzer::drawGrid(juce::Graphics& g, juce::Rectangle<float> r) const
+{
+    g.setColour(juce::Colours::darkgrey.withAlpha(0.25f));
+
+    //Horizontal dB lines every 6 dB
+    for (float d = -dbRange; d <= dbRange; d += 6.0f)
+    {
+        const float y = r.getY() + (dbRange - d) / (2.0f * dbRange) * (r.getHeight() - 1.0f);
+        g.drawHorizontalLine((int)std::round(y), r.getX(), r.getRight());
+    }
+
+    //Vertical freq lines
+    const float freqs[] = { 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000 };
+    for (float f : freqs)
+    {
+        const float x = xForFreq(f, r);
+        g.drawVerticalLine((int)std::round(x), r.getY(), r.getBottom());
+    }
+}
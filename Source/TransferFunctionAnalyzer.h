@@ -0,0 +1,97 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <complex>
+#include <vector>
+
+#include "SampleFifo.h"
+#include "VisualizerComponent.h"
+
+//Dual-channel transfer function analyzer (reference vs measurement input).
+//The audio thread only copies the two selected channels into a FIFO; a worker
+//thread does the windowed FFTs, averages the auto/cross spectra and publishes
+//magnitude, phase and coherence for display. Double-click finds the delay.
+
+class TransferFunctionAnalyzer : public VisualizerComponent,
+    private juce::Thread
+{
+public:
+    explicit TransferFunctionAnalyzer(int fftOrder = 16);
+    ~TransferFunctionAnalyzer() override;
+
+    void mouseDoubleClick(const juce::MouseEvent&) override;
+
+    void setSampleRate(double sr);
+    void setInputChannels(int referenceChannel, int measurementChannel);
+    void setAveraging(int numFrames);
+
+    //Delay applied to the reference channel (samples), and a request to
+    //re-estimate it from the current cross spectrum (GCC-PHAT).
+    void setDelayCompensation(int samples);
+    int  getDelayCompensation() const { return delaySamples.load(); }
+    void findDelay() { delayRequested.store(true); }
+
+    void pushSamples(const juce::AudioBuffer<float>& buffer); //audio thread: FIFO copy only
+    void clear();
+
+private:
+    //FFT setup
+    const int order;
+    const int fftSize;
+    const int hopSize;
+    const int maxDelay;
+    const int historyMask;
+
+    juce::dsp::WindowingFunction<float> window;
+    juce::dsp::FFT fft;
+
+    //Audio thread -> worker
+    SampleFifo fifo;
+    std::atomic<int> referenceChannel{ 0 };
+    std::atomic<int> measurementChannel{ 1 };
+    std::atomic<int> numAverages{ 8 };
+    std::atomic<int> delaySamples{ 0 };
+    std::atomic<double> sampleRate{ 48000.0 };
+    std::atomic<bool> delayRequested{ false };
+    std::atomic<bool> resetRequested{ false };
+
+    //Worker state (only touched by the worker thread)
+    static constexpr int popBlockSize = 4096;
+    std::vector<float> popRef, popMeas;      // chunk pulled from the fifo
+    std::vector<float> refHistory, measHistory; // circular, 2 * fftSize
+    juce::int64 writePos = 0;
+    int samplesSinceFrame = 0;
+    int framesAveraged = 0;
+
+    std::vector<float> fftRef, fftMeas;      // 2 * fftSize (real-only transform)
+    std::vector<float> gxx, gyy;             // averaged auto spectra
+    std::vector<std::complex<float>> gxy;    // averaged cross spectrum
+    std::vector<std::complex<float>> corrIn, corrOut; // delay finder (complex IFFT)
+
+    //Display (log-spaced points, computed by the worker)
+    static constexpr int numDisplayPoints = 480;
+    std::vector<float> displayFreqs;
+    std::vector<float> stagingMagDb, stagingPhaseDeg, stagingCoherence;
+
+    juce::ReadWriteLock resultLock;
+    std::vector<float> magDb, phaseDeg, coherence;
+    bool hasResult = false;
+
+    //Display params
+    float minFreq = 20.0f;
+    float maxFreq = 20000.0f;
+    float dbRange = 24.0f;           //+/- dB around 0
+
+    void run() override;
+    void renderFrame(juce::Graphics& g, juce::Rectangle<int> bounds) override;
+    void resetAnalysis();
+    void processFrame();
+    void estimateDelay();
+    void publishResult();
+
+    float xForFreq(float f, juce::Rectangle<float> r) const;
+    void drawGrid(juce::Graphics& g, juce::Rectangle<float> r) const;
+    juce::Path makeTrace(juce::Rectangle<float> r, const std::vector<float>& values, float top, float bottom, int step) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TransferFunctionAnalyzer)
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+
+//Lock-free triple buffer for handing finished frames from one writer thread to
+//one reader thread. The writer fills its private slot and publishes it by
+//swapping it with the shared "ready" slot; the reader swaps the ready slot with
+//its own when a newer one is flagged. Neither side ever waits or copies - each
+//hand-over is a single atomic exchange of slot indices.
+//
+//Slots should be sized up front (forEachSlot) so nothing allocates at runtime.
+
+template <typename T>
+class TripleBuffer
+{
+public:
+    //Writer side
+    T& getWriteBuffer() noexcept { return slots[writeIndex]; }
+
+    void publish() noexcept
+    {
+        writeIndex = state.exchange(writeIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    //Reader side: true if a newer frame was swapped in since the last call
+    bool acquire() noexcept
+    {
+        if ((state.load(std::memory_order_relaxed) & freshBit) == 0)
+            return false;
+
+        readIndex = state.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const noexcept { return slots[readIndex]; }
+
+    //Setup only (no reader/writer running)
+    template <typename Fn>
+    void forEachSlot(Fn&& fn)
+    {
+        for (auto& s : slots) fn(s);
+    }
+
+private:
+    static constexpr int freshBit = 4;
+    static constexpr int indexMask = 3;
+
+    T slots[3];
+    int writeIndex = 0;              // writer-owned
+    int readIndex = 1;               // reader-owned
+    std::atomic<int> state{ 2 };     // ready slot index | freshBit
+};
@@ -4,58 +4,67 @@
 class TruePeakDetector
 {
 public:
+    //Input is processed in chunks of at most this many samples, so any block size
+    //is accepted without growing buffers on the audio thread
+    static constexpr int chunkSize = 512;
+
     explicit TruePeakDetector(int channels = 2, int osPow2 = 2)
         : numChannels(channels),
+        oversamplingFactor(1 << osPow2),
         oversampling(channels,
             osPow2,
             juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR) {
     }
 
-    void prepare(double /*sampleRate*/, int maxBlockSize)
+    //Any block size is accepted afterwards; the device block size is not needed
+    void prepare(double /*sampleRate*/, int /*maxBlockSize*/ = chunkSize)
     {
         oversampling.reset();
-        oversampling.initProcessing((size_t)maxBlockSize);
+        oversampling.initProcessing((size_t)chunkSize);
 
-        workBuffer.setSize(numChannels, maxBlockSize, false, false, true);
+        workBuffer.setSize(numChannels, chunkSize);
     }
 
+    int getOversamplingFactor() const noexcept { return oversamplingFactor; }
+
     void processBlock(const juce::AudioBuffer<float>& in, std::vector<float>& outPeaks)
     {
-        const int n = in.getNumSamples();
-        if (n <= 0) { outPeaks.assign((size_t)numChannels, 0.0f); return; }
-
         outPeaks.assign((size_t)numChannels, 0.0f);
 
-        workBuffer.setSize(numChannels, n, false, false, true);
-        workBuffer.clear();
-
-        if (in.getNumChannels() == 1 && numChannels >= 2)
-        {
-            workBuffer.copyFrom(0, 0, in, 0, 0, n);
-            workBuffer.copyFrom(1, 0, in, 0, 0, n);
-        }
-        else
-        {
-            const int srcChans = in.getNumChannels();
-            for (int ch = 0; ch < numChannels; ++ch)
+        upsample(in, [&outPeaks](const juce::dsp::AudioBlock<float>& upBlock)
             {
-                const int srcCh = juce::jmin(ch, srcChans - 1);
-                workBuffer.copyFrom(ch, 0, in, srcCh, 0, n);
-            }
-        }
-
-        juce::dsp::AudioBlock<float> inBlock(workBuffer);
+                for (size_t ch = 0; ch < upBlock.getNumChannels(); ++ch)
+                {
+                    const float* d = upBlock.getChannelPointer(ch);
+                    const int upN = (int)upBlock.getNumSamples();
+                    float m = outPeaks[ch];
+                    for (int i = 0; i < upN; ++i)
+                        m = std::max(m, std::abs(d[i]));
+                    outPeaks[ch] = m;
+                }
+            });
+    }
 
-        auto upBlock = oversampling.processSamplesUp(inBlock);
+    //Oversamples in (numChannels wide, mono duplicated) chunk by chunk and hands each
+    //oversampled chunk to onChunk, for callers that need the inter-sample signal
+    //itself rather than its block peak. The result does not depend on how the input
+    //is split into blocks.
+    template <typename ChunkCallback>
+    void upsample(const juce::AudioBuffer<float>& in, ChunkCallback&& onChunk)
+    {
+        const int numSamples = in.getNumSamples();
+        const int srcChans = in.getNumChannels();
+        if (numSamples <= 0 || srcChans <= 0) return;
 
-        for (size_t ch = 0; ch < upBlock.getNumChannels(); ++ch)
+        for (int start = 0; start < numSamples; start += chunkSize)
         {
-            const float* d = upBlock.getChannelPointer(ch);
-            const int upN = (int)upBlock.getNumSamples();
-            float m = 0.0f;
-            for (int i = 0; i < upN; ++i)
-                m = std::max(m, std::abs(d[i]));
-            outPeaks[ch] = m;
+            const int n = juce::jmin(chunkSize, numSamples - start);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                workBuffer.copyFrom(ch, 0, in, juce::jmin(ch, srcChans - 1), start, n);
+
+            auto inBlock = juce::dsp::AudioBlock<float>(workBuffer).getSubBlock(0, (size_t)n);
+            onChunk(oversampling.processSamplesUp(inBlock));
         }
     }
 
@@ -64,7 +73,7 @@ public:
 
 private:
     int numChannels;
+    int oversamplingFactor;
     juce::dsp::Oversampling<float> oversampling;
     juce::AudioBuffer<float> workBuffer;
 };
-
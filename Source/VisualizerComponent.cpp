@@ -0,0 +1,158 @@
+#include "VisualizerComponent.h"
+
+VisualizerRenderThread::VisualizerRenderThread()
+    : juce::Thread("Visualizer render")
+{
+    startThread();
+}
+
+VisualizerRenderThread::~VisualizerRenderThread()
+{
+    stopThread(2000);
+}
+
+void VisualizerRenderThread::add(VisualizerComponent* v)
+{
+    const juce::ScopedLock sl(listLock);
+    visualizers.addIfNotAlreadyThere(v);
+}
+
+void VisualizerRenderThread::remove(VisualizerComponent* v)
+{
+    const juce::ScopedLock sl(listLock);
+    visualizers.removeFirstMatchingValue(v);
+}
+
+void VisualizerRenderThread::renderNow(VisualizerComponent* v)
+{
+    const juce::ScopedLock sl(listLock);
+    v->requestFrame();
+    v->renderIfRequested();
+}
+
+void VisualizerRenderThread::run()
+{
+    TraceRecorder::getInstance().nameCurrentThread("visualizer render");
+
+    while (!threadShouldExit())
+    {
+        {
+            const juce::ScopedLock sl(listLock);
+            for (auto* v : visualizers)
+                v->renderIfRequested();
+        }
+
+        wait(frameIntervalMs);
+    }
+}
+
+//==============================================================================
+VisualizerComponent::VisualizerComponent(const char* traceNameIn)
+    : traceName(traceNameIn)
+{
+    renderThread->add(this);
+}
+
+VisualizerComponent::~VisualizerComponent()
+{
+    //A subclass that reaches here still registered forgot stopRendering() in its own
+    //destructor: its members are already gone, and a render may have been using them
+    jassert(!rendering);
+    stopRendering();
+}
+
+void VisualizerComponent::stopRendering()
+{
+    if (rendering)
+    {
+        renderThread->remove(this);
+        rendering = false;
+    }
+
+    cancelPendingUpdate();
+}
+
+void VisualizerComponent::paint(juce::Graphics& g)
+{
+    const TraceRecorder::ScopedEvent trace(traceName, "paint");
+
+    //Re-render at the new resolution when the window moves to a different display scale
+    const float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    if (scale != frameScale.load())
+    {
+        frameScale.store(scale);
+        requestFrame();
+    }
+
+    frames.acquire();
+    const auto& image = frames.getReadBuffer();
+
+    if (image.isValid())
+        g.drawImage(image, getLocalBounds().toFloat());
+    else
+        g.fillAll(juce::Colours::lightgrey);
+}
+
+void VisualizerComponent::renderNow(float scale)
+{
+    frameScale.store(scale);
+    renderThread->renderNow(this);
+}
+
+void VisualizerComponent::resized()
+{
+    frameWidth.store(getWidth());
+    frameHeight.store(getHeight());
+    requestFrame();
+}
+
+void VisualizerComponent::renderIfRequested()
+{
+    if (!frameRequested.exchange(false, std::memory_order_acquire))
+        return;
+
+    const int w = frameWidth.load();
+    const int h = frameHeight.load();
+    if (w <= 0 || h <= 0) return;
+
+    const float scale = frameScale.load();
+    const int pixelW = juce::roundToInt(std::ceil((float)w * scale));
+    const int pixelH = juce::roundToInt(std::ceil((float)h * scale));
+
+    auto& image = frames.getWriteBuffer();
+    if (!image.isValid() || image.getWidth() != pixelW || image.getHeight() != pixelH)
+        image = juce::Image(juce::Image::ARGB, pixelW, pixelH, true);
+
+    const double startMs = juce::Time::getMillisecondCounterHiRes();
+    {
+        const TraceRecorder::ScopedEvent trace(traceName, "render");
+        juce::Graphics g(image);
+        g.addTransform(juce::AffineTransform::scale(scale));
+        renderFrame(g, { 0, 0, w, h });
+    }
+    updateDetailLevel(juce::Time::getMillisecondCounterHiRes() - startMs);
+
+    frames.publish();
+    triggerAsyncUpdate();
+}
+
+void VisualizerComponent::updateDetailLevel(double renderMs)
+{
+    const double previous = averageRenderMs.load();
+    const double average = previous > 0.0 ? previous + 0.2 * (renderMs - previous) : renderMs;
+    averageRenderMs.store(average);
+
+    const double budget = frameBudgetMs.load();
+    int level = detailLevel.load();
+    ++framesSinceChange;
+
+    if (average > budget && level < maxDetailLevel && framesSinceChange >= settleFrames)
+        ++level;
+    else if (average < 0.5 * budget && level > 0 && framesSinceChange >= recoverFrames)
+        --level;
+    else
+        return;
+
+    detailLevel.store(level);
+    framesSinceChange = 0;
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+
+#include "TripleBuffer.h"
+#include "TraceRecorder.h"
+
+class VisualizerComponent;
+
+//Shared worker that renders dirty visualizers into offscreen images (~60 Hz).
+//One instance is shared by every VisualizerComponent via SharedResourcePointer.
+class VisualizerRenderThread : private juce::Thread
+{
+public:
+    VisualizerRenderThread();
+    ~VisualizerRenderThread() override;
+
+    void add(VisualizerComponent* v);
+    void remove(VisualizerComponent* v); //blocks until an in-flight render of v has finished
+    void renderNow(VisualizerComponent* v); //on the calling thread, serialized with the render pass
+
+private:
+    static constexpr int frameIntervalMs = 16;
+
+    juce::CriticalSection listLock; //held for a whole render pass
+    juce::Array<VisualizerComponent*> visualizers;
+
+    void run() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VisualizerRenderThread)
+};
+
+//Base for the visualizers: frames are drawn by renderFrame() on the render thread
+//into a triple-buffered image, and paint() on the message thread only blits the
+//newest finished one. Data producers (audio thread included) call requestFrame().
+class VisualizerComponent : public juce::Component,
+    private juce::AsyncUpdater
+{
+public:
+    //traceName labels this visualizer's render/paint events in the trace recorder (literal)
+    explicit VisualizerComponent(const char* traceName = "visualizer");
+    ~VisualizerComponent() override;
+
+    void paint(juce::Graphics& g) final;
+    void resized() override;
+
+    //Any thread: mark the visualizer as needing a new frame (never blocks or allocates)
+    void requestFrame() noexcept { frameRequested.store(true, std::memory_order_release); }
+
+    //Level of detail. Each frame's render time is measured; when its running average
+    //exceeds the budget the detail level steps up (coarser), and steps back down after
+    //a sustained stretch under half the budget.
+    //  0 = full detail, 1 = half the vertices, 2 = a quarter, 3 = a quarter without anti-aliasing
+    static constexpr int maxDetailLevel = 3;
+
+    void setFrameBudgetMs(double ms) { frameBudgetMs.store(juce::jmax(0.1, ms)); }
+    double getFrameBudgetMs() const { return frameBudgetMs.load(); }
+
+    int getDetailLevel() const noexcept { return detailLevel.load(std::memory_order_relaxed); }
+    double getAverageRenderMs() const noexcept { return averageRenderMs.load(std::memory_order_relaxed); }
+
+    //Offscreen harnesses: render a frame at the given display scale on the calling
+    //thread right away, so the next paint() shows it. After detachFromRenderThread()
+    //the render thread no longer picks up this visualizer's frames by itself.
+    void renderNow(float scale);
+    void detachFromRenderThread() { stopRendering(); }
+
+protected:
+    //Render thread: draw a complete frame covering bounds (component coordinates).
+    //Must only read state that is safe to read off the message thread.
+    virtual void renderFrame(juce::Graphics& g, juce::Rectangle<int> bounds) = 0;
+
+    //Every subclass destructor must call this first so no render runs against destroyed
+    //members (the base destructor asserts it was done)
+    void stopRendering();
+
+private:
+    friend class VisualizerRenderThread;
+
+    //Render thread
+    void renderIfRequested();
+    void updateDetailLevel(double renderMs);
+
+    void handleAsyncUpdate() override { repaint(); }
+
+    juce::SharedResourcePointer<VisualizerRenderThread> renderThread;
+    bool rendering = true;
+    const char* traceName;
+
+    std::atomic<bool> frameRequested{ true };
+    std::atomic<int> frameWidth{ 0 }, frameHeight{ 0 };
+    std::atomic<float> frameScale{ 1.0f };
+
+    TripleBuffer<juce::Image> frames; //written by the render thread, read by paint()
+
+    //Level of detail (written by the render thread)
+    static constexpr int settleFrames = 5;      //frames to wait after a change before coarsening again
+    static constexpr int recoverFrames = 60;    //frames of headroom before refining
+    std::atomic<double> frameBudgetMs{ 4.0 };
+    std::atomic<int> detailLevel{ 0 };
+    std::atomic<double> averageRenderMs{ 0.0 };
+    int framesSinceChange = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VisualizerComponent)
+};
\ No newline at end of file
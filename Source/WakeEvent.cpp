@@ -0,0 +1,61 @@
+#include "WakeEvent.h"
+
+#if JUCE_WINDOWS
+ #include <windows.h>
+#elif JUCE_MAC || JUCE_IOS
+ #include <dispatch/dispatch.h>
+#else
+ #include <cerrno>
+ #include <semaphore.h>
+#endif
+
+//Counting semaphore, posted once per sleep (see wait()), so its count stays 0 or 1
+struct WakeEvent::Semaphore
+{
+   #if JUCE_WINDOWS
+    Semaphore() : handle(CreateSemaphoreW(nullptr, 0, 1, nullptr)) { jassert(handle != nullptr); }
+    ~Semaphore() { CloseHandle(handle); }
+    void post() noexcept { ReleaseSemaphore(handle, 1, nullptr); }
+    void wait() noexcept { WaitForSingleObject(handle, INFINITE); }
+
+    HANDLE handle;
+   #elif JUCE_MAC || JUCE_IOS
+    Semaphore() : handle(dispatch_semaphore_create(0)) {}
+    ~Semaphore() { dispatch_release(handle); }
+    void post() noexcept { dispatch_semaphore_signal(handle); }
+    void wait() noexcept { dispatch_semaphore_wait(handle, DISPATCH_TIME_FOREVER); }
+
+    dispatch_semaphore_t handle;
+   #else
+    Semaphore() { sem_init(&handle, 0, 0); }
+    ~Semaphore() { sem_destroy(&handle); }
+    void post() noexcept { sem_post(&handle); }
+    void wait() noexcept { while (sem_wait(&handle) != 0 && errno == EINTR) {} }
+
+    sem_t handle;
+   #endif
+};
+
+WakeEvent::WakeEvent() : semaphore(std::make_unique<Semaphore>()) {}
+WakeEvent::~WakeEvent() = default;
+
+void WakeEvent::post() noexcept
+{
+    semaphore->post();
+}
+
+void WakeEvent::wait() noexcept
+{
+    for (;;)
+    {
+        //Already signalled: consume it without sleeping
+        int expected = signalled;
+        if (state.compare_exchange_strong(expected, idle, std::memory_order_acquire))
+            return;
+
+        //Announce the sleep; a signal() that sees it posts the semaphore
+        expected = idle;
+        if (state.compare_exchange_strong(expected, sleeping, std::memory_order_relaxed))
+            semaphore->wait();
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+
+//Wakes one sleeping thread from a real-time thread. Unlike juce::WaitableEvent,
+//signal() takes no lock: it is one atomic exchange, plus a semaphore post (a kernel
+//call that never blocks) only when the waiter is actually asleep. Signals do not
+//queue: several signal() calls before the next wait() wake it once.
+//
+//One waiting thread per event; signal() may be called from any thread.
+class WakeEvent
+{
+public:
+    WakeEvent();
+    ~WakeEvent();
+
+    //Any thread, real-time safe
+    void signal() noexcept
+    {
+        if (state.exchange(signalled, std::memory_order_release) == sleeping)
+            post();
+    }
+
+    //The waiting thread: returns once signalled, consuming the signal
+    void wait() noexcept;
+
+private:
+    enum { idle, signalled, sleeping };
+
+    void post() noexcept;
+
+    std::atomic<int> state{ idle };
+
+    struct Semaphore;
+    std::unique_ptr<Semaphore> semaphore;
+
+    JUCE_DECLARE_NON_COPYABLE(WakeEvent)
+};
@@ -1,29 +1,74 @@
 #include "Waveform.h"
+#include "RealtimeSanitizer.h"
+
+#include <cmath>
 
 Waveform::Waveform()
-    : writeIndex(0)
+    : VisualizerComponent("waveform")
 {
-    audioHistory.resize(maxHistorySize, 0.0f);
+    resizeHistory(historySeconds, sampleRate);
     setOpaque(true);
 }
 
-Waveform::~Waveform() {}
+Waveform::~Waveform() { stopRendering(); }
+
+void Waveform::setSampleRate(double newSampleRate)
+{
+    if (newSampleRate <= 0.0 || newSampleRate == sampleRate)
+        return;
+
+    resizeHistory(historySeconds, newSampleRate);
+}
+
+void Waveform::setHistorySeconds(double seconds)
+{
+    seconds = juce::jlimit(1.0, maxHistorySeconds, seconds);
+    if (seconds == historySeconds)
+        return;
+
+    resizeHistory(seconds, sampleRate);
+}
+
+void Waveform::resizeHistory(double seconds, double rate)
+{
+    const auto numBlocks = (size_t)std::ceil(seconds * rate / blockSize);
+
+    //Allocate outside the lock so the audio thread is never held up by it
+    std::vector<uint64_t> resized(juce::jmax((size_t)1, numBlocks) + 1, 0);
+    {
+        const juce::ScopedWriteLock writeLock(lock);
+        cumulativeSquares.swap(resized);
+        historySeconds = seconds;
+        sampleRate = rate;
+        blocksWritten = 0;
+        runningSquares = 0;
+        pendingSquares = 0.0;
+        pendingSamples = 0;
+    }
+    requestFrame();
+}
 
 void Waveform::clear()
 {
     const juce::ScopedWriteLock writeLock(lock);
-    std::fill(audioHistory.begin(), audioHistory.end(), 0.0f);
-    writeIndex.store(0);
-    repaint();
+    std::fill(cumulativeSquares.begin(), cumulativeSquares.end(), (uint64_t)0);
+    blocksWritten = 0;
+    runningSquares = 0;
+    pendingSquares = 0.0;
+    pendingSamples = 0;
+    requestFrame();
 }
 
 void Waveform::pushSamples(const juce::AudioBuffer<float>& buffer)
 {
+    if (buffer.getNumChannels() <= 0)
+        return;
+
+    RESONANCE_RT_BLOCKING("ReadWriteLock::enterWrite");
     const juce::ScopedWriteLock writeLock(lock);
 
     const int numChannels = buffer.getNumChannels();
     const int numSamples = buffer.getNumSamples();
-
     //loop through the audio information sample by sample
     for (int i = 0; i < numSamples; ++i)
     {
@@ -33,72 +78,121 @@ void Waveform::pushSamples(const juce::AudioBuffer<float>& buffer)
         for (int ch = 0; ch < numChannels; ++ch)
             sum += buffer.getSample(ch, i);
 
-        float mono = sum / static_cast<float>(numChannels);
+        const float mono = sum / static_cast<float>(numChannels);
+        pendingSquares += mono * mono;
 
-        //writeIndex points to the next free slot
-        audioHistory[writeIndex] = mono;
+        if (++pendingSamples == blockSize)
+            finishBlock();
+    }
 
-        //As soon as writeIndex = maxHistorySize we're reset back to zero which means we start overwriting the oldest samples
-        writeIndex = (writeIndex + 1) % maxHistorySize;
+    silentSamples = 0;
+    requestFrame();
+}
+
+void Waveform::advance(int numSamples)
+{
+    if (numSamples <= 0)
+        return;
+
+    RESONANCE_RT_BLOCKING("ReadWriteLock::enterWrite");
+    const juce::ScopedWriteLock writeLock(lock);
+
+    //Silence only fills the pending block; whole blocks cost one ring write each
+    for (int left = numSamples; left > 0;)
+    {
+        const int n = juce::jmin(left, blockSize - pendingSamples);
+        pendingSamples += n;
+        left -= n;
+        if (pendingSamples == blockSize)
+            finishBlock();
     }
 
-    juce::MessageManager::callAsync([this]() { repaint(); });
+    //Keep scrolling until the whole history is silent
+    if (silentSamples < (int64_t)(historySeconds * sampleRate))
+    {
+        silentSamples += numSamples;
+        requestFrame();
+    }
 }
 
+//Appends the running sum at the end of the pending block; the oldest entry is overwritten
+//once the ring is full. Called with the write lock held.
+void Waveform::finishBlock() noexcept
+{
+    //A NaN or infinite sample would make the conversion undefined and corrupt every later
+    //difference: count such a block as silent; anything else is clamped to the headroom
+    const double squares = std::isfinite(pendingSquares) ? juce::jlimit(0.0, maxBlockSquares, pendingSquares) : 0.0;
+    runningSquares += (uint64_t)std::llround(squares * squareScale);
+    ++blocksWritten;
+    cumulativeSquares[(size_t)(blocksWritten % (int64_t)cumulativeSquares.size())] = runningSquares;
+    pendingSquares = 0.0;
+    pendingSamples = 0;
+}
+
+//Sum of squares between two (fractional) block boundaries, clamped to the history. Before the
+//first block there is nothing, which draws the empty part of the history as silence; inside a
+//block it is interpolated, i.e. the block's energy is taken as spread evenly over its samples.
+//Whole blocks are differenced in integers (wrapping), so the result is exact at any age.
+double Waveform::squaresBetween(double from, double to) const noexcept
+{
+    const auto size = (int64_t)cumulativeSquares.size();
+    const auto oldest = juce::jmax((int64_t)0, blocksWritten - (size - 1));
+    from = juce::jlimit((double)oldest, (double)blocksWritten, from);
+    to = juce::jlimit((double)oldest, (double)blocksWritten, to);
+    if (to <= from)
+        return 0.0;
+
+    const auto at = [this, size](int64_t n) { return cumulativeSquares[(size_t)(n % size)]; };
+
+    //The part of the block after a boundary that lies before it
+    const auto partial = [&at](double boundary)
+    {
+        const auto whole = (int64_t)boundary;
+        const double fraction = boundary - (double)whole;
+        return fraction > 0.0 ? fraction * (double)(at(whole + 1) - at(whole)) : 0.0;
+    };
+
+    const auto wholeFrom = (int64_t)from, wholeTo = (int64_t)to;
+    const double squares = (double)(at(wholeTo) - at(wholeFrom)) + partial(to) - partial(from);
+    return squares / squareScale;
+}
 
-//loop across each pixel on the screen on the waveform and calculate how many samples ago it represents, fetch and average those samples, 
-//convert that average to height, draw a mirrored bar 
-void Waveform::paint(juce::Graphics& g)
+//loop across each pixel on the screen on the waveform, work out which span of the history it represents,
+//take the RMS of that span from the running sums, convert it to height, draw a mirrored bar
+void Waveform::renderFrame(juce::Graphics& g, juce::Rectangle<int> bounds)
 {
     g.fillAll(juce::Colours::lightgrey);
 
     //get the center, width, and gain scale for drawing
-    const float gain = 0.9f * getHeight() * 0.5f;
-    const float centerY = getHeight() * 0.5f;
-    const int width = getWidth();
-
-    const float zoomFactor = 0.25f; //for changing, maybe add as a slider
-    const float samplesPerPixel = (float)maxHistorySize / (float)width * zoomFactor;
+    const float gain = 0.9f * bounds.getHeight() * 0.5f;
+    const float centerY = bounds.getHeight() * 0.5f;
+    const int width = bounds.getWidth();
 
     const juce::ScopedReadLock readLock(lock);
 
-    //get the current index of our audio buffer where the next sample is about to be written
-    int readHead = writeIndex.load();
+    const float zoomFactor = 0.25f; //for changing, maybe add as a slider
+    const double blocksPerPixel = historySeconds * sampleRate / blockSize / juce::jmax(1, width) * zoomFactor;
+    const double samplesPerPixel = blocksPerPixel * blockSize;
+
+    //the boundary after the newest complete block
+    const double readHead = (double)blocksWritten;
 
     g.setColour(juce::Colours::lightslategrey);
 
-    for (int x = 0; x < width; ++x)
+    //Level of detail: wider bars (1/2/4 px). The cost per bar no longer depends on the history length.
+    const int barWidth = 1 << juce::jmin(getDetailLevel(), 2);
+
+    for (int x = 0; x < width; x += barWidth)
     {
-        float rms = 0.0f;
-        int count = 0;
-
-        //downsample to meet our space restrictions 
-        for (int i = 0; i < samplesPerPixel; ++i)
-        {
-            //Calculate pixel distance from right edge
-            //Convert pixel distance to sample distance 
-            //Add i to access individual samples within that pixel's chunk
-            //subtract from readHead to walkback
-            //Add and modulo buffer size to wrap around safely
-            int pixelsBack = (getWidth() - x - 1);
-            int samplesBack = (pixelsBack * samplesPerPixel) + i;
-            int index = (readHead - samplesBack + maxHistorySize) % maxHistorySize;
-
-            float sample = audioHistory[index];
-            rms += sample * sample;
-            ++count; //count how many samples we've proccessed for this pixel
-        }
-
-        rms = std::sqrt(rms / (float)count); //finsih the rms calc
-        float barHeight = rms * gain; //how much we want to draw
-
-        //mirrored top and bottom bars
-        g.fillRect((float)x, centerY - barHeight, 1.0f, barHeight);
-        g.fillRect((float)x, centerY, 1.0f, barHeight);
-    }
-}
+        //Walk back from the read head: the pixel at the right edge covers the newest span
+        const int pixelsBack = (width - x - 1);
+        const double newer = readHead - pixelsBack * blocksPerPixel;
+        const double squares = squaresBetween(newer - blocksPerPixel, newer);
 
-void Waveform::resized()
-{
-    
+        const float rms = samplesPerPixel > 0.0 ? (float)std::sqrt(juce::jmax(0.0, squares) / samplesPerPixel) : 0.0f;
+        const float barHeight = rms * gain; //how much we want to draw
+
+        //mirrored top and bottom bars (one rect)
+        g.fillRect((float)x, centerY - barHeight, (float)barWidth, 2.0f * barHeight);
+    }
 }
@@ -1,29 +1,69 @@
 #pragma once
 #include <JuceHeader.h>
 #include <vector>
-#include <atomic>
+#include <cstdint>
 
-class Waveform : public juce::Component
+#include "VisualizerComponent.h"
+
+//Scrolling RMS strip of the recent history. Instead of raw samples it keeps one running
+//sum of squares per 32-sample block (8 bytes per 128 bytes of audio), which is all the
+//display needs: the RMS over any span is a difference of two sums. The sums are 64-bit
+//fixed point and allowed to wrap, so differences stay exact however long it runs.
+class Waveform : public VisualizerComponent
 {
 public:
     Waveform();
     ~Waveform() override;
 
-    void paint(juce::Graphics&) override;
-    void resized() override;
+    //Message thread or before audio starts. Both resize and clear the history; the
+    //allocation happens outside the lock the audio thread takes.
+    void setSampleRate(double newSampleRate);
+    void setHistorySeconds(double seconds);
+    double getHistorySeconds() const noexcept { return historySeconds; }
+
+    static constexpr double defaultHistorySeconds = 10.0;
+    static constexpr double maxHistorySeconds = 3600.0;
 
     void pushSamples(const juce::AudioBuffer<float>& buffer);
     void clear();
 
+    //Audio thread, for blocks that are not pushed (hidden, gated or shed): appends
+    //zero-energy blocks, so the history always spans its full wall-clock length and
+    //time without samples shows as silence
+    void advance(int numSamples);
+
+    //Resident size of the history, for the benchmarks
+    size_t getHistoryBytes() const noexcept { return cumulativeSquares.size() * sizeof(uint64_t); }
+
 private:
+    void renderFrame(juce::Graphics& g, juce::Rectangle<int> bounds) override;
+    void resizeHistory(double seconds, double rate);
+    double squaresBetween(double from, double to) const noexcept;
+    void finishBlock() noexcept;
+
     juce::ReadWriteLock lock;
 
-    static constexpr int historySeconds = 10;
-    static constexpr int sampleRate = 44100; 
-    static constexpr int maxHistorySize = historySeconds * sampleRate;
+    static constexpr int blockSize = 32;
+    static constexpr double squareScale = 1073741824.0;        //fixed point: 2^30 per unit of squares
+    static constexpr double maxBlockSquares = blockSize * 8.0;  //up to +9 dBFS: a full hour at 384 kHz stays under 2^64
+
+    //Guarded by the lock (written together with the ring size)
+    double sampleRate = 44100.0;
+    double historySeconds = defaultHistorySeconds;
+
+    //Ring of the running sum of squares at block boundaries: entry n % size holds the sum
+    //over the first n blocks (modulo 2^64). One entry more than the history has blocks,
+    //so the boundary before the oldest block is still there. Writers hold the write lock.
+    std::vector<uint64_t> cumulativeSquares;
+    int64_t blocksWritten = 0;
+    uint64_t runningSquares = 0;
+
+    //Block being filled (not visible until complete: under 1 ms of audio)
+    double pendingSquares = 0.0;
+    int pendingSamples = 0;
 
-    std::vector<float> audioHistory;
-    std::atomic<int> writeIndex;
+    //Silence appended by advance() since the last push; frames stop once it fills the history
+    int64_t silentSamples = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Waveform)
 };
@@ -14,19 +14,51 @@ float dbMeter::mapDb(float db) const
     return juce::jmap(db, minDb, maxDb, 0.0f, 1.0f);
 }
 
+int dbMeter::fillHeightFor(float db) const
+{
+    return juce::roundToInt(mapDb(db) * getHeight());
+}
+
 void dbMeter::setLevel(float newLevel) 
 {
-    //only changes if the level has changed 
-    if (levelDb != newLevel)
-    {
-        levelDb = newLevel;
+    //Constrains a value to keep it within a given range.
+    newLevel = juce::jlimit(minDb, maxDb, newLevel);
 
-        //Constrains a value to keep it within a given range.
-        levelDb = juce::jlimit(minDb, maxDb, levelDb);
+    //only repaint if the fill actually moves on screen
+    const bool moved = fillHeightFor(newLevel) != fillHeightFor(levelDb);
+    levelDb = newLevel;
+
+    if (moved)
+        repaint();
+}
+
+void dbMeter::setClipped(bool isClipped)
+{
+    if (clipped != isClipped)
+    {
+        clipped = isClipped;
         repaint();
     }
 }
 
+void dbMeter::setPeakHold(float newPeakHoldDb)
+{
+    newPeakHoldDb = juce::jlimit(minDb - 1.0f, maxDb, newPeakHoldDb); //below minDb hides the marker
+
+    const bool moved = fillHeightFor(newPeakHoldDb) != fillHeightFor(peakHoldDb);
+    peakHoldDb = newPeakHoldDb;
+
+    if (moved)
+        repaint();
+}
+
+void dbMeter::setReading(const MeterReading& reading)
+{
+    setLevel(reading.levelDb);
+    setPeakHold(reading.peakHoldDb);
+    setClipped(reading.clipped);
+}
+
 void dbMeter::paint(juce::Graphics& g)
 {
     auto bounds = getLocalBounds();
@@ -56,6 +88,21 @@ void dbMeter::paint(juce::Graphics& g)
     int yStart = bounds.getBottom() - fillHeight;
     g.fillRect(bounds.getX(), yStart, bounds.getWidth(), fillHeight);
 
+    //Peak-hold marker
+    if (peakHoldDb >= minDb)
+    {
+        const int holdY = bounds.getBottom() - fillHeightFor(peakHoldDb);
+        g.setColour(juce::Colours::darkslategrey);
+        g.fillRect(bounds.getX(), juce::jmax(bounds.getY(), holdY - 1), bounds.getWidth(), 2);
+    }
+
+    //Clip indicator (latched until the meters are reset)
+    if (clipped)
+    {
+        g.setColour(juce::Colours::red);
+        g.fillRect(bounds.withHeight(4));
+    }
+
     //Draw the outline
     g.setColour(juce::Colours::lightslategrey);
     g.drawRect(bounds, 1);
@@ -1,5 +1,6 @@
 #pragma once
 #include <JuceHeader.h>
+#include "MeterBallistics.h"
 
 class dbMeter : public juce::Component
 {
@@ -10,8 +11,11 @@ public:
 	void paint(juce::Graphics& g) override;
 	void resized() override;
 
-	void setLevel(float newLevel);
+	void setLevel(float newLevel); //repaints only when the fill moves by at least one pixel
 	float getLevel() const { return levelDb; }
+	void setClipped(bool isClipped);
+	void setPeakHold(float newPeakHoldDb);
+	void setReading(const MeterReading& reading); //level, peak-hold marker and clip indicator
 	void setMinDb(float newMinDb) { minDb = newMinDb; repaint(); }
 	void setMaxDb(float newMaxDb) { maxDb = newMaxDb; repaint(); }
 
@@ -21,7 +25,11 @@ private:
 	float minDb = -60.0f;    
 	float maxDb = 0.0f;      
 
+	float peakHoldDb = -100.0f;
+	bool clipped = false;
+
 	float mapDb(float db) const;
+	int fillHeightFor(float db) const;
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(dbMeter)
 };
\ No newline at end of file
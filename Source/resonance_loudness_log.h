@@ -0,0 +1,118 @@
+/*
+    Resonance loudness log file format (C ABI).
+
+    A loudness log is a fixed-size ring of 100 ms records behind a one-page header.
+    Resonance pre-sizes the file when the log is created; after that it only
+    overwrites the oldest records, so disk usage stays constant however long it runs.
+
+        [resonance_llog_header, 4096 bytes][record 0][record 1] ... [record capacity-1]
+
+    Records are numbered by an absolute index that keeps counting across wrap-arounds:
+    record i lives in slot i % capacity, and the valid indices are
+    [resonance_llog_first(h), h->head). Timestamps never decrease with the index, so a
+    time range is found with two binary searches (resonance_llog_lower_bound).
+
+    The writer appends in batches. Before it overwrites any slot it raises `first` past
+    the records it is about to replace, and it publishes the batch by advancing `head`
+    last, so a reader mapping a live file sees whole records. Records near the oldest
+    end can still be overwritten while they are being read: copy them, then call
+    resonance_llog_first() again and drop every copied record below it.
+
+    Levels are stored in hundredths of a dB (LUFS, dBTP), floored at -100 dB.
+*/
+
+#ifndef RESONANCE_LOUDNESS_LOG_H
+#define RESONANCE_LOUDNESS_LOG_H
+
+#include <stdint.h>
+
+#define RESONANCE_LLOG_MAGIC       "RSNLLOG"   /* plus the terminating zero: 8 bytes */
+#define RESONANCE_LLOG_VERSION     2u          /* 2: adds `first` */
+#define RESONANCE_LLOG_HEADER_SIZE 4096u
+#define RESONANCE_LLOG_INTERVAL_MS 100
+
+/* resonance_llog_record.flags */
+#define RESONANCE_LLOG_FLAG_SESSION_START  1u   /* first record after the log or the audio device (re)started */
+#define RESONANCE_LLOG_FLAG_CLOCK_ADJUSTED 2u   /* the wall clock went backwards; time_ms was held */
+#define RESONANCE_LLOG_FLAG_GAP            4u   /* records before this one were dropped (writer fell behind) */
+
+#if defined(__GNUC__) || defined(__clang__)
+ #define RESONANCE_LLOG_LOAD_HEAD(h)  __atomic_load_n(&(h)->head, __ATOMIC_ACQUIRE)
+ #define RESONANCE_LLOG_LOAD_FIRST(h) (__atomic_thread_fence(__ATOMIC_ACQUIRE), __atomic_load_n(&(h)->first, __ATOMIC_ACQUIRE))
+#else
+ #define RESONANCE_LLOG_LOAD_HEAD(h)  (*(volatile const uint64_t*)&(h)->head)
+ #define RESONANCE_LLOG_LOAD_FIRST(h) (*(volatile const uint64_t*)&(h)->first)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct resonance_llog_record
+{
+    int64_t  time_ms;            /* end of the 100 ms interval, milliseconds since the Unix epoch */
+    int16_t  momentary_cb;       /* momentary loudness (400 ms), centi-LUFS */
+    int16_t  short_term_cb;      /* short-term loudness (3 s), centi-LUFS */
+    int16_t  integrated_cb;      /* integrated loudness since the meters were last reset, centi-LUFS */
+    int16_t  range_cb;           /* loudness range, centi-LU */
+    int16_t  true_peak_cb[2];    /* highest true peak within the interval per channel, centi-dBTP */
+    uint16_t flags;              /* RESONANCE_LLOG_FLAG_* */
+    uint16_t reserved;
+} resonance_llog_record;         /* 24 bytes */
+
+typedef struct resonance_llog_header
+{
+    char     magic[8];           /* RESONANCE_LLOG_MAGIC */
+    uint32_t version;            /* RESONANCE_LLOG_VERSION */
+    uint32_t header_size;        /* RESONANCE_LLOG_HEADER_SIZE: records start here */
+    uint32_t record_size;        /* sizeof(resonance_llog_record) */
+    uint32_t interval_ms;        /* RESONANCE_LLOG_INTERVAL_MS */
+    uint64_t capacity;           /* records in the ring */
+    uint64_t head;               /* absolute index of the next record; written last by the writer */
+    uint64_t dropped;            /* records lost because the writer fell behind */
+    int64_t  created_ms;         /* when the file was created */
+    int64_t  updated_ms;         /* time_ms of the newest record */
+    double   sample_rate;        /* of the newest session */
+    uint64_t first;              /* absolute index of the oldest valid record; raised before slots are overwritten */
+} resonance_llog_header;
+
+static inline double resonance_llog_db(int16_t centi)
+{
+    return centi * 0.01;
+}
+
+/* Oldest valid index. Everything read before the call is ordered before it, so after
+   copying records, any copied index below the result may have been overwritten. It can
+   run ahead of a head loaded earlier while a batch is being written; clamp it to head. */
+static inline uint64_t resonance_llog_first(const resonance_llog_header* h)
+{
+    return RESONANCE_LLOG_LOAD_FIRST(h);
+}
+
+static inline const resonance_llog_record* resonance_llog_at(const resonance_llog_header* h, uint64_t index)
+{
+    const resonance_llog_record* records
+        = (const resonance_llog_record*)((const char*)h + h->header_size);
+    return records + index % h->capacity;
+}
+
+/* Absolute index of the first record in [first, end) with time_ms >= timeMs (end if none) */
+static inline uint64_t resonance_llog_lower_bound(const resonance_llog_header* h,
+                                                  uint64_t first, uint64_t end, int64_t timeMs)
+{
+    while (first < end)
+    {
+        const uint64_t mid = first + (end - first) / 2;
+        if (resonance_llog_at(h, mid)->time_ms < timeMs)
+            first = mid + 1;
+        else
+            end = mid;
+    }
+    return first;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RESONANCE_LOUDNESS_LOG_H */
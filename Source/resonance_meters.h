@@ -0,0 +1,161 @@
+/*
+    Resonance shared-memory meter export (C ABI).
+
+    While export is enabled, Resonance keeps the latest meter values in a POSIX shared
+    memory object (RESONANCE_METERS_SHM_NAME by default) and rewrites them after every
+    audio callback it analyses. Other processes map the object once and then poll it
+    with plain memory reads: no syscalls, no sockets, no kernel copies.
+
+    The payload is protected by a sequence lock. The writer makes `sequence` odd, updates
+    `data`, then makes it even again; a reader copies `data` and retries if the sequence
+    was odd or changed meanwhile. resonance_meters_read() does exactly that.
+
+        const resonance_meters_shm* shm = resonance_meters_map(RESONANCE_METERS_SHM_NAME);
+        resonance_meters_data d;
+        if (shm != NULL && resonance_meters_read(shm, &d))
+            printf("%.1f LUFS\n", d.lufs_short_term);
+
+    Compatibility: readers must check `magic`, `version` and `size` (resonance_meters_map
+    does). Fields are only ever appended within a version, so a reader built against an
+    older header may read a larger segment of the same version.
+
+    Levels are in dBFS / LUFS and floored at -100. The helper functions need GCC or Clang
+    (__atomic builtins); the struct definitions alone compile anywhere.
+*/
+
+#ifndef RESONANCE_METERS_H
+#define RESONANCE_METERS_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define RESONANCE_METERS_SHM_NAME "/resonance-meters"
+#define RESONANCE_METERS_MAGIC    0x4d4e5352u   /* "RSNM" little-endian */
+#define RESONANCE_METERS_VERSION  1u
+#define RESONANCE_METERS_CHANNELS 2
+
+/* resonance_meters_shm.flags */
+#define RESONANCE_METERS_FLAG_ACTIVE 1u   /* the writer is running and export is enabled */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct resonance_meter_channel
+{
+    float level_db;            /* VU level */
+    float peak_hold_db;        /* sample-peak hold */
+    float true_peak_db;        /* PPM on the oversampled signal (see have_true_peak) */
+    float true_peak_hold_db;   /* true-peak hold */
+    uint32_t clipped;          /* latched until the meters are reset */
+} resonance_meter_channel;
+
+typedef struct resonance_meters_data
+{
+    uint64_t update_count;     /* analysis updates published since the writer started */
+    uint64_t sample_position;  /* audio frames analysed since the writer started */
+    int64_t  time_ms;          /* wall clock of the update, milliseconds since the Unix epoch */
+    double   sample_rate;
+
+    float lufs_momentary;
+    float lufs_short_term;
+    float lufs_integrated;
+    float lufs_range;          /* loudness range, LU */
+
+    uint32_t have_true_peak;   /* true-peak fields are only updated while their meters are showing */
+    uint32_t num_channels;     /* RESONANCE_METERS_CHANNELS */
+    resonance_meter_channel channel[RESONANCE_METERS_CHANNELS];
+} resonance_meters_data;
+
+typedef struct resonance_meters_shm
+{
+    uint32_t magic;            /* RESONANCE_METERS_MAGIC */
+    uint32_t version;          /* RESONANCE_METERS_VERSION */
+    uint32_t size;             /* sizeof(resonance_meters_shm) of the writer */
+    uint32_t writer_pid;       /* the only writer; another process takes over only once it has exited */
+    uint32_t flags;            /* RESONANCE_METERS_FLAG_* */
+    uint32_t sequence;         /* odd while the writer is updating data */
+    uint32_t reserved[10];     /* pads the header to 64 bytes */
+
+    resonance_meters_data data;
+} resonance_meters_shm;
+
+#if defined(__GNUC__) || defined(__clang__)
+
+/* Copies a consistent snapshot into *out. Returns 0 if the writer kept the lock for
+   every attempt (only possible if it died mid-update). */
+static inline int resonance_meters_read(const resonance_meters_shm* shm, resonance_meters_data* out)
+{
+    int attempt;
+    for (attempt = 0; attempt < 10000; ++attempt)
+    {
+        const uint32_t before = __atomic_load_n(&shm->sequence, __ATOMIC_ACQUIRE);
+        if ((before & 1u) != 0)
+            continue;
+
+        memcpy(out, (const void*)&shm->data, sizeof *out);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&shm->sequence, __ATOMIC_RELAXED) == before)
+            return 1;
+    }
+    return 0;
+}
+
+static inline int resonance_meters_is_active(const resonance_meters_shm* shm)
+{
+    return (__atomic_load_n(&shm->flags, __ATOMIC_ACQUIRE) & RESONANCE_METERS_FLAG_ACTIVE) != 0;
+}
+
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__unix__) || defined(__APPLE__))
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Maps an existing export read-only. Returns NULL if there is none or it is incompatible.
+   Unmap with resonance_meters_unmap. */
+static inline const resonance_meters_shm* resonance_meters_map(const char* name)
+{
+    struct stat st;
+    void* mapped;
+    const resonance_meters_shm* shm;
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0)
+        return NULL;
+
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(resonance_meters_shm))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    mapped = mmap(NULL, sizeof(resonance_meters_shm), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+        return NULL;
+
+    shm = (const resonance_meters_shm*)mapped;
+    if (shm->magic != RESONANCE_METERS_MAGIC || shm->version != RESONANCE_METERS_VERSION
+        || shm->size < sizeof(resonance_meters_shm))
+    {
+        munmap(mapped, sizeof(resonance_meters_shm));
+        return NULL;
+    }
+    return shm;
+}
+
+static inline void resonance_meters_unmap(const resonance_meters_shm* shm)
+{
+    if (shm != NULL)
+        munmap((void*)shm, sizeof(resonance_meters_shm));
+}
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RESONANCE_METERS_H */
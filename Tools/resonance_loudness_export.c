@@ -0,0 +1,187 @@
+/*
+    resonance_loudness_export: exports a window of a Resonance loudness log as CSV.
+
+        resonance_loudness_export <log> [--from TIME] [--to TIME] [--last SECONDS] [--info]
+
+    TIME is either milliseconds since the Unix epoch or UTC "YYYY-MM-DDTHH:MM:SS".
+    The window is [from, to); without either bound it runs from the oldest or up to
+    the newest record. --info prints the log's header instead of records.
+
+    The log is mapped read-only, so this can run against the file Resonance is
+    writing. The window is located with two binary searches over the ring.
+*/
+
+#define _DEFAULT_SOURCE   /* timegm, gmtime_r */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "resonance_loudness_log.h"
+
+static int parseTime(const char* text, int64_t* ms)
+{
+    struct tm t;
+    char* end;
+    const long long value = strtoll(text, &end, 10);
+    if (*end == '\0')
+    {
+        *ms = value;
+        return 1;
+    }
+
+    memset(&t, 0, sizeof t);
+    if (sscanf(text, "%d-%d-%dT%d:%d:%d", &t.tm_year, &t.tm_mon, &t.tm_mday,
+               &t.tm_hour, &t.tm_min, &t.tm_sec) != 6)
+        return 0;
+
+    t.tm_year -= 1900;
+    t.tm_mon -= 1;
+    *ms = (int64_t)timegm(&t) * 1000;
+    return 1;
+}
+
+static void formatTime(int64_t ms, char* out, size_t size)
+{
+    const time_t seconds = (time_t)(ms / 1000);
+    struct tm t;
+    gmtime_r(&seconds, &t);
+    const size_t n = strftime(out, size, "%Y-%m-%dT%H:%M:%S", &t);
+    snprintf(out + n, size - n, ".%03dZ", (int)(ms % 1000));
+}
+
+static void printInfo(const resonance_llog_header* h)
+{
+    const uint64_t head = RESONANCE_LLOG_LOAD_HEAD(h), oldestIndex = resonance_llog_first(h);
+    const uint64_t first = oldestIndex < head ? oldestIndex : head;
+    char created[40], oldest[40], newest[40];
+    formatTime(h->created_ms, created, sizeof created);
+
+    printf("capacity      %llu records (%.1f days)\n", (unsigned long long)h->capacity,
+           h->capacity * (double)h->interval_ms / 86400000.0);
+    printf("records       %llu (%llu written in total)\n",
+           (unsigned long long)(head - first), (unsigned long long)head);
+    printf("dropped       %llu\n", (unsigned long long)h->dropped);
+    printf("created       %s\n", created);
+    if (head > first)
+    {
+        formatTime(resonance_llog_at(h, first)->time_ms, oldest, sizeof oldest);
+        formatTime(resonance_llog_at(h, head - 1)->time_ms, newest, sizeof newest);
+        printf("oldest        %s\nnewest        %s\n", oldest, newest);
+    }
+    printf("sample rate   %.0f Hz\n", h->sample_rate);
+}
+
+int main(int argc, char** argv)
+{
+    const char* path = NULL;
+    int64_t from = INT64_MIN, to = INT64_MAX, last = -1;
+    int info = 0, fd, i;
+    struct stat st;
+    void* mapped;
+    const resonance_llog_header* h;
+    uint64_t first, head, begin, end, count, index;
+    resonance_llog_record* copy;
+
+    for (i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--from") == 0 && i + 1 < argc)
+        {
+            if (!parseTime(argv[++i], &from)) { fprintf(stderr, "bad time: %s\n", argv[i]); return 2; }
+        }
+        else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc)
+        {
+            if (!parseTime(argv[++i], &to)) { fprintf(stderr, "bad time: %s\n", argv[i]); return 2; }
+        }
+        else if (strcmp(argv[i], "--last") == 0 && i + 1 < argc) last = (int64_t)(atof(argv[++i]) * 1000.0);
+        else if (strcmp(argv[i], "--info") == 0)                  info = 1;
+        else if (path == NULL && argv[i][0] != '-')               path = argv[i];
+        else
+        {
+            fprintf(stderr, "usage: %s <log> [--from TIME] [--to TIME] [--last SECONDS] [--info]\n"
+                            "TIME: epoch milliseconds or UTC YYYY-MM-DDTHH:MM:SS\n", argv[0]);
+            return 2;
+        }
+    }
+    if (path == NULL)
+    {
+        fprintf(stderr, "usage: %s <log> [--from TIME] [--to TIME] [--last SECONDS] [--info]\n", argv[0]);
+        return 2;
+    }
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) != 0 || (size_t)st.st_size < RESONANCE_LLOG_HEADER_SIZE)
+    {
+        fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+    mapped = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED)
+    {
+        fprintf(stderr, "cannot map %s\n", path);
+        return 1;
+    }
+
+    h = (const resonance_llog_header*)mapped;
+    if (memcmp(h->magic, RESONANCE_LLOG_MAGIC, sizeof h->magic) != 0 || h->version != RESONANCE_LLOG_VERSION
+        || h->record_size != sizeof(resonance_llog_record) || h->capacity == 0
+        || (uint64_t)st.st_size < h->header_size + h->capacity * h->record_size)
+    {
+        fprintf(stderr, "%s is not a compatible loudness log\n", path);
+        munmap(mapped, (size_t)st.st_size);
+        return 1;
+    }
+
+    if (info)
+    {
+        printInfo(h);
+        munmap(mapped, (size_t)st.st_size);
+        return 0;
+    }
+
+    head = RESONANCE_LLOG_LOAD_HEAD(h);
+    first = resonance_llog_first(h);
+    if (first > head)
+        first = head;
+    if (last >= 0 && head > first)
+        from = resonance_llog_at(h, head - 1)->time_ms - last;
+
+    begin = resonance_llog_lower_bound(h, first, head, from);
+    end = to == INT64_MAX ? head : resonance_llog_lower_bound(h, begin, head, to);
+
+    /* Copy first, then drop whatever the writer overwrote meanwhile */
+    count = end - begin;
+    copy = (resonance_llog_record*)malloc((count > 0 ? count : 1) * sizeof *copy);
+    if (copy == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    for (index = begin; index < end; ++index)
+        copy[index - begin] = *resonance_llog_at(h, index);
+
+    first = resonance_llog_first(h);
+    printf("time_utc,time_ms,momentary_lufs,short_term_lufs,integrated_lufs,range_lu,"
+           "true_peak_1_dbtp,true_peak_2_dbtp,flags\n");
+    for (index = begin < first ? first : begin; index < end; ++index)
+    {
+        const resonance_llog_record* r = &copy[index - begin];
+        char stamp[40];
+        formatTime(r->time_ms, stamp, sizeof stamp);
+        printf("%s,%lld,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%u\n", stamp, (long long)r->time_ms,
+               resonance_llog_db(r->momentary_cb), resonance_llog_db(r->short_term_cb),
+               resonance_llog_db(r->integrated_cb), resonance_llog_db(r->range_cb),
+               resonance_llog_db(r->true_peak_cb[0]), resonance_llog_db(r->true_peak_cb[1]),
+               (unsigned)r->flags);
+    }
+
+    free(copy);
+    munmap(mapped, (size_t)st.st_size);
+    return 0;
+}
@@ -0,0 +1,109 @@
+/*
+    resonance_meters_read: prints the meters Resonance exports to shared memory.
+
+        resonance_meters_read [--name /resonance-meters] [--interval-ms 100] [--once] [--csv]
+
+    Maps the export once, then polls it with resonance_meters_read() (plain memory reads)
+    and prints a line whenever a new update arrived. Exits with 1 if there is no export.
+*/
+
+#define _DEFAULT_SOURCE   /* nanosleep */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "resonance_meters.h"
+
+static void sleepMs(int ms)
+{
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+}
+
+static void printLine(const resonance_meters_data* d, int csv, int active)
+{
+    unsigned ch;
+    if (csv)
+    {
+        printf("%llu,%llu,%lld,%.0f,%.2f,%.2f,%.2f,%.2f",
+               (unsigned long long)d->update_count, (unsigned long long)d->sample_position,
+               (long long)d->time_ms, d->sample_rate,
+               d->lufs_momentary, d->lufs_short_term, d->lufs_integrated, d->lufs_range);
+        for (ch = 0; ch < RESONANCE_METERS_CHANNELS; ++ch)
+            printf(",%.2f,%.2f,%.2f,%.2f,%u", d->channel[ch].level_db, d->channel[ch].peak_hold_db,
+                   d->channel[ch].true_peak_db, d->channel[ch].true_peak_hold_db, d->channel[ch].clipped);
+        printf(",%u,%d\n", d->have_true_peak, active);
+        return;
+    }
+
+    printf("#%-8llu M %6.1f  S %6.1f  I %6.1f LUFS  LRA %4.1f LU",
+           (unsigned long long)d->update_count,
+           d->lufs_momentary, d->lufs_short_term, d->lufs_integrated, d->lufs_range);
+    for (ch = 0; ch < RESONANCE_METERS_CHANNELS; ++ch)
+    {
+        printf("  |  ch%u %6.1f (pk %6.1f)", ch + 1, d->channel[ch].level_db, d->channel[ch].peak_hold_db);
+        if (d->have_true_peak)
+            printf(" TP %6.1f", d->channel[ch].true_peak_hold_db);
+        if (d->channel[ch].clipped)
+            printf(" CLIP");
+    }
+    printf("%s\n", active ? "" : "  (inactive)");
+}
+
+int main(int argc, char** argv)
+{
+    const char* name = RESONANCE_METERS_SHM_NAME;
+    int intervalMs = 100, once = 0, csv = 0, i;
+    const resonance_meters_shm* shm;
+    resonance_meters_data d;
+    uint64_t lastUpdate = 0;
+
+    for (i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--name") == 0 && i + 1 < argc)             name = argv[++i];
+        else if (strcmp(argv[i], "--interval-ms") == 0 && i + 1 < argc) intervalMs = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--once") == 0)                        once = 1;
+        else if (strcmp(argv[i], "--csv") == 0)                         csv = 1;
+        else
+        {
+            fprintf(stderr, "usage: %s [--name %s] [--interval-ms 100] [--once] [--csv]\n",
+                    argv[0], RESONANCE_METERS_SHM_NAME);
+            return 2;
+        }
+    }
+    if (intervalMs < 1)
+        intervalMs = 1;
+
+    shm = resonance_meters_map(name);
+    if (shm == NULL)
+    {
+        fprintf(stderr, "no compatible meter export at %s (is Resonance running with export enabled?)\n", name);
+        return 1;
+    }
+
+    if (csv)
+        printf("update,sample_position,time_ms,sample_rate,momentary,short_term,integrated,range,"
+               "level_1,peak_hold_1,true_peak_1,true_peak_hold_1,clipped_1,"
+               "level_2,peak_hold_2,true_peak_2,true_peak_hold_2,clipped_2,have_true_peak,active\n");
+
+    for (;;)
+    {
+        if (resonance_meters_read(shm, &d) && (once || d.update_count != lastUpdate))
+        {
+            lastUpdate = d.update_count;
+            printLine(&d, csv, resonance_meters_is_active(shm));
+            fflush(stdout);
+        }
+
+        if (once)
+            break;
+        sleepMs(intervalMs);
+    }
+
+    resonance_meters_unmap(shm);
+    return 0;
+}